@@ -42,4 +42,25 @@
 #define LWPKT_CFG_CRC32         2
 #define LWPKT_CFG_USE_FLAGS     2
 
+#define LWPKT_CFG_CRC_TABLE      2
+#define LWPKT_CFG_CRC32_SLICE_BY 8
+#define LWPKT_CFG_CRC_DESC       1
+
+#define LWPKT_CFG_USE_TX_STREAM 1
+#define LWPKT_CFG_TX_MPSC       1
+#define LWPKT_CFG_USE_TX_BATCH  1
+#define LWPKT_CFG_USE_RX_STREAM 1
+#define LWPKT_CFG_RX_RESYNC     1
+#define LWPKT_CFG_RX_FILTER     1
+#define LWPKT_CFG_RX_QUEUE      4
+#define LWPKT_CFG_USE_COBS      2
+#define LWPKT_CFG_USE_ENGINE    1
+#define LWPKT_CFG_USE_STATS     1
+#define LWPKT_CFG_STATS_CYCLES  1
+#define LWPKT_CFG_TRACE         4
+#define LWPKT_CFG_USE_FRAG      1
+#if defined(__linux__)
+#define LWPKT_CFG_USE_GW        1
+#endif /* defined(__linux__) */
+
 #endif /* LWPKT_HDR_OPTS_H */
@@ -0,0 +1,67 @@
+/**
+ * \file            lwpkt_opts_template.h
+ * \brief           LwPKT configuration file
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.1.0
+ */
+#ifndef LWPKT_HDR_OPTS_H
+#define LWPKT_HDR_OPTS_H
+
+#define LWPKT_CFG_USE_ADDR      1
+#define LWPKT_CFG_ADDR_EXTENDED 2
+#define LWPKT_CFG_USE_CMD       1
+#define LWPKT_CFG_CMD_EXTENDED  2
+#define LWPKT_CFG_USE_CRC       2
+#define LWPKT_CFG_CRC32         2
+#define LWPKT_CFG_USE_FLAGS     2
+
+#define LWPKT_CFG_CRC_TABLE      2
+#define LWPKT_CFG_CRC32_SLICE_BY 8
+#define LWPKT_CFG_CRC_DESC       1
+
+#define LWPKT_CFG_USE_TX_STREAM 0
+#define LWPKT_CFG_TX_MPSC       0
+#define LWPKT_CFG_USE_TX_BATCH  1
+#define LWPKT_CFG_USE_RX_STREAM 1
+#define LWPKT_CFG_RX_RESYNC     1
+#define LWPKT_CFG_RX_FILTER     1
+#define LWPKT_CFG_RX_QUEUE      0
+#define LWPKT_CFG_USE_COBS      1
+#define LWPKT_CFG_USE_ENGINE    1
+#define LWPKT_CFG_USE_STATS     1
+#define LWPKT_CFG_STATS_CYCLES  1
+#define LWPKT_CFG_TRACE         4
+#define LWPKT_CFG_USE_FRAG      1
+
+/* Receive data memory provided by the application, small transmit frame queue */
+#define LWPKT_CFG_RX_DATA_EXT      1
+#define LWPKT_CFG_TX_FRAMES        4
+
+#endif /* LWPKT_HDR_OPTS_H */
@@ -8,11 +8,13 @@
 
 extern void example_lwpkt(void);
 extern void example_lwpkt_evt(void);
-extern void test_lwpkt(void);
+extern size_t test_lwpkt(void);
 
 int
 main() {
-    test_lwpkt();
+    if (test_lwpkt() != 0) {
+        return 1;
+    }
     //  example_lwpkt_evt();
     return 0;
 }
@@ -29,7 +29,7 @@
  * This file is part of LwRB - Lightweight ring buffer library.
  *
  * Author:          Tilen MAJERLE <tilen@majerle.eu>
- * Version:         v3.0.0-rc1
+ * Version:         v3.1.0
  */
 #ifndef LWRB_HDR_H
 #define LWRB_HDR_H
@@ -85,6 +85,7 @@ typedef struct lwrb {
     lwrb_ulong_t r; /*!< Next read pointer. Buffer is considered empty when `r == w` and full when `w == r - 1` */
     lwrb_ulong_t w; /*!< Next write pointer. Buffer is considered empty when `r == w` and full when `w == r - 1` */
     lwrb_evt_fn evt_fn; /*!< Pointer to event callback function */
+    void* arg;          /*!< Event custom user argument */
 } lwrb_t;
 
 uint8_t lwrb_init(lwrb_t* buff, void* buffdata, size_t size);
@@ -92,6 +93,8 @@ uint8_t lwrb_is_ready(lwrb_t* buff);
 void lwrb_free(lwrb_t* buff);
 void lwrb_reset(lwrb_t* buff);
 void lwrb_set_evt_fn(lwrb_t* buff, lwrb_evt_fn fn);
+void lwrb_set_arg(lwrb_t* buff, void* arg);
+void* lwrb_get_arg(lwrb_t* buff);
 
 /* Read/Write functions */
 size_t lwrb_write(lwrb_t* buff, const void* data, size_t btw);
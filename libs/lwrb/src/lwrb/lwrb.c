@@ -29,7 +29,7 @@
  * This file is part of LwRB - Lightweight ring buffer library.
  *
  * Author:          Tilen MAJERLE <tilen@majerle.eu>
- * Version:         v3.0.0-rc1
+ * Version:         v3.1.0
  */
 #include "lwrb/lwrb.h"
 
@@ -73,6 +73,7 @@ lwrb_init(lwrb_t* buff, void* buffdata, size_t size) {
     }
 
     buff->evt_fn = NULL;
+    buff->arg = NULL;
     buff->size = size;
     buff->buff = buffdata;
     LWRB_INIT(buff->w, 0);
@@ -115,6 +116,28 @@ lwrb_set_evt_fn(lwrb_t* buff, lwrb_evt_fn evt_fn) {
     }
 }
 
+/**
+ * \brief           Set custom buffer argument, that can be retrieved in the event function
+ * \param[in]       buff: Buffer handle
+ * \param[in]       arg: Custom user argument
+ */
+void
+lwrb_set_arg(lwrb_t* buff, void* arg) {
+    if (BUF_IS_VALID(buff)) {
+        buff->arg = arg;
+    }
+}
+
+/**
+ * \brief           Get custom buffer argument, previously set with \ref lwrb_set_arg
+ * \param[in]       buff: Buffer handle
+ * \return          User argument, previously set with \ref lwrb_set_arg
+ */
+void*
+lwrb_get_arg(lwrb_t* buff) {
+    return buff != NULL ? buff->arg : NULL;
+}
+
 /**
  * \brief           Write data to buffer.
  * Copies data from `data` array to buffer and marks buffer as full for maximum `btw` number of bytes
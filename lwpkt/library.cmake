@@ -17,6 +17,8 @@ set(LWPKT_CUSTOM_INC_DIR ${CMAKE_CURRENT_BINARY_DIR}/lib_inc)
 # Library core sources
 set(lwpkt_core_SRCS
     ${CMAKE_CURRENT_LIST_DIR}/src/lwpkt/lwpkt.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/lwpkt/lwpkt_engine.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/lwpkt/lwpkt_frag.c
 )
 
 # Setup include directories
@@ -32,6 +34,19 @@ target_include_directories(lwpkt INTERFACE ${lwpkt_include_DIRS})
 target_compile_options(lwpkt PRIVATE ${LWPKT_COMPILE_OPTIONS})
 target_compile_definitions(lwpkt PRIVATE ${LWPKT_COMPILE_DEFINITIONS})
 
+# Header-only C++ codec, independent of library options
+add_library(lwpkt_cpp INTERFACE)
+target_include_directories(lwpkt_cpp INTERFACE ${CMAKE_CURRENT_LIST_DIR}/src/include)
+target_compile_features(lwpkt_cpp INTERFACE cxx_std_20)
+
+# Linux gateway, with worker threads reading file descriptors
+if(CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    find_package(Threads REQUIRED)
+    add_library(lwpkt_gw INTERFACE)
+    target_sources(lwpkt_gw INTERFACE ${CMAKE_CURRENT_LIST_DIR}/src/lwpkt/lwpkt_gw.c)
+    target_link_libraries(lwpkt_gw INTERFACE lwpkt Threads::Threads)
+endif()
+
 # Create config file if user didn't provide one info himself
 if(NOT LWPKT_OPTS_FILE)
     message(STATUS "Using default lwpkt_opts.h file")
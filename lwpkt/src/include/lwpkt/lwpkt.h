@@ -65,6 +65,26 @@ typedef enum {
     LWPKT_STATE_END,          /*!< Last entry */
 } lwpkt_state_t;
 
+/**
+ * \brief           Packet layout depends on the instance flags,
+ *                  when at least one of the protocol fields is dynamically enabled
+ */
+#define LWPKT_LAYOUT_DYNAMIC                                                                                           \
+    (LWPKT_CFG_USE_ADDR == 2 || LWPKT_CFG_ADDR_EXTENDED == 2 || LWPKT_CFG_USE_FLAGS == 2 || LWPKT_CFG_USE_CMD == 2     \
+     || LWPKT_CFG_CMD_EXTENDED == 2 || LWPKT_CFG_USE_CRC == 2 || LWPKT_CFG_CRC32 == 2 || LWPKT_CFG_CRC_DESC)
+
+/**
+ * \brief           Packet layout, derived from enabled protocol features
+ *
+ * With static configuration, layout is constant and prepared at build time.
+ * Otherwise it is prepared again every time one of the features is enabled or disabled.
+ */
+typedef struct {
+    uint8_t next[LWPKT_STATE_END]; /*!< Next state for each state. Data state is skipped when data length is `0` */
+    uint8_t var;                   /*!< Bit mask of states, where field uses variable length encoding */
+    uint8_t crc_len;               /*!< Number of CRC bytes, `0` when CRC is not used */
+} lwpkt_layout_t;
+
 /**
  * \brief           Packet result enumeration
  */
@@ -79,11 +99,45 @@ typedef enum {
     lwpktERRMEM,    /*!< No enough memory available for write */
 } lwpktr_t;
 
+#if LWPKT_CFG_CRC_DESC || __DOXYGEN__
+/**
+ * \brief           CRC block calculation function, used instead of software calculation
+ * \param[in]       crc: Current CRC register value, without initial value or output XOR applied
+ * \param[in]       data: Data to process
+ * \param[in]       len: Number of bytes to process
+ * \return          New CRC register value
+ */
+typedef uint32_t (*lwpkt_crc_block_fn)(uint32_t crc, const void* data, size_t len);
+
+/**
+ * \brief           CRC algorithm descriptor
+ *
+ * Parameters follow common CRC catalogue notation. For reflected algorithms,
+ * register is shifted towards LSB and values passed to \ref lwpkt_crc_block_fn are reflected too.
+ */
+typedef struct {
+    uint8_t width;               /*!< CRC width in units of bits: `8`, `16` or `32` */
+    uint8_t reflect;             /*!< Set to `1` for reflected input and output, `0` otherwise */
+    uint32_t poly;               /*!< Polynomial in normal (MSB first) representation */
+    uint32_t init;               /*!< Initial register value */
+    uint32_t xorout;             /*!< Value for XOR with final register value */
+    const uint32_t* table;       /*!< Optional `256`-entry lookup table, generated with \ref lwpkt_crc_table_gen.
+                                        Set to `NULL` for bit-wise calculation */
+    lwpkt_crc_block_fn block_fn; /*!< Optional block function, for example CRC peripheral or CPU instructions.
+                                        Set to `NULL` for software calculation */
+} lwpkt_crc_desc_t;
+#endif /* LWPKT_CFG_CRC_DESC || __DOXYGEN__ */
+
 /**
  * \brief           CRC structure for packet
  */
 typedef struct {
-    uint32_t crc; /*!< Current CRC value */
+    uint32_t crc;     /*!< Current CRC value */
+    uint8_t is_crc32; /*!< Set to `1` when `CRC-32` is used, `0` for `CRC-8`. Selected once per packet */
+#if LWPKT_CFG_CRC_DESC || __DOXYGEN__
+    const lwpkt_crc_desc_t* desc; /*!< CRC descriptor, or `NULL` when built-in `CRC-8` or `CRC-32` is used */
+    uint32_t poly;                /*!< Descriptor polynomial, prepared for the shift direction */
+#endif                            /* LWPKT_CFG_CRC_DESC || __DOXYGEN__ */
 } lwpkt_crc_t;
 
 /* Forward declaration */
@@ -101,7 +155,8 @@ typedef enum {
                             Called when write operation happens to TX buffer  */
     LWPKT_EVT_PRE_WRITE,  /*!< Packet pre-write operation.
                                 Called before write operation could even start.
-                                It can be used to get exclusive mutex access to the resource */
+                                It can be used to get exclusive mutex access to the resource,
+                                unless \ref LWPKT_CFG_TX_MPSC is enabled */
     LWPKT_EVT_POST_WRITE, /*!< Packet post-write operation.
                                 Called after write operation finished.
                                 It can be used to release exclusive mutex access from the resource */
@@ -111,6 +166,14 @@ typedef enum {
     LWPKT_EVT_POST_READ,  /*!< Packet post-read operation.
                                 Called after read operation finished.
                                 It can be used to release exclusive mutex access from the resource */
+#if LWPKT_CFG_USE_RX_STREAM || __DOXYGEN__
+    LWPKT_EVT_STREAM_START, /*!< Header of stream packet received, data part is too long to be stored.
+                                Header fields and data length are available to read */
+    LWPKT_EVT_STREAM_DATA,  /*!< Fragment of stream packet data part received.
+                                Use \ref lwpkt_get_stream_data to access it. Valid only during the event */
+    LWPKT_EVT_STREAM_END,   /*!< Stream packet finished.
+                                Use \ref lwpkt_get_stream_result to check if packet is valid */
+#endif                      /* LWPKT_CFG_USE_RX_STREAM || __DOXYGEN__ */
 } lwpkt_evt_type_t;
 
 /**
@@ -129,6 +192,119 @@ typedef uint32_t lwpkt_addr_t;
 typedef uint8_t lwpkt_addr_t;
 #endif /* LWPKT_CFG_ADDR_EXTENDED || __DOXYGEN__ */
 
+/**
+ * \brief           Data segment descriptor.
+ *
+ * Used for scatter/gather write with \ref lwpkt_writev
+ * and to describe received data in zero-copy mode
+ */
+typedef struct {
+    const void* data; /*!< Pointer to data segment */
+    size_t len;       /*!< Length of data segment in units of bytes */
+} lwpkt_seg_t;
+
+#if LWPKT_CFG_RX_QUEUE || __DOXYGEN__
+/**
+ * \brief           Receive packet queue slot
+ */
+typedef struct {
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+    lwpkt_addr_t from;                    /*!< Device address packet is coming from */
+    lwpkt_addr_t to;                      /*!< Device address packet is intended for */
+#endif                                    /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+    uint32_t flags;                       /*!< Custom flags */
+#endif                                    /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+    uint32_t cmd;                         /*!< Command packet */
+#endif                                    /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+    size_t len;                           /*!< Number of data bytes */
+    uint8_t data[LWPKT_CFG_MAX_DATA_LEN]; /*!< Packet data */
+} lwpkt_rx_slot_t;
+#endif /* LWPKT_CFG_RX_QUEUE || __DOXYGEN__ */
+
+#if LWPKT_CFG_TX_FRAMES || __DOXYGEN__
+/**
+ * \brief           Transmit frame, written to TX buffer
+ */
+typedef struct {
+    lwpkt_seg_t seg[2]; /*!< Frame memory in TX buffer. Second segment is used when frame wraps around buffer end */
+    size_t pad;         /*!< Number of padding bytes before the frame, released together with it */
+} lwpkt_tx_frame_t;
+#endif /* LWPKT_CFG_TX_FRAMES || __DOXYGEN__ */
+
+#if LWPKT_CFG_RX_FILTER || __DOXYGEN__
+/**
+ * \brief           Receive filter
+ */
+typedef struct {
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+    lwpkt_addr_t addr_mask; /*!< Bits of destination address, that must match device address. `0` accepts all */
+    uint8_t broadcast;      /*!< Set to `1` to accept packets to \ref LWPKT_CFG_ADDR_BROADCAST address */
+#endif                      /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+    const uint32_t* cmd; /*!< List of accepted commands. Set to `NULL` to accept all */
+    size_t cmd_cnt;      /*!< Number of entries in `cmd` list */
+#endif                   /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+} lwpkt_filter_t;
+#endif /* LWPKT_CFG_RX_FILTER || __DOXYGEN__ */
+
+#if LWPKT_CFG_TRACE || __DOXYGEN__
+/* Stages of trace record, used in \ref lwpkt_trace_t::stages */
+#define LWPKT_TRACE_STAGE_START   ((uint8_t)0x01) /*!< Start byte has been detected */
+#define LWPKT_TRACE_STAGE_HDR     ((uint8_t)0x02) /*!< Header has been received */
+#define LWPKT_TRACE_STAGE_DATA    ((uint8_t)0x04) /*!< Data part has been received */
+#define LWPKT_TRACE_STAGE_VERDICT ((uint8_t)0x08) /*!< Packet result is known */
+#define LWPKT_TRACE_STAGE_EVT     ((uint8_t)0x10) /*!< Packet or timeout event has been dispatched */
+
+/**
+ * \brief           Packet latency trace record
+ * \note            Times are values of \ref lwpkt_trace_get_time function
+ */
+typedef struct {
+    uint32_t start;   /*!< Time of start byte or first COBS code byte detection */
+    uint32_t hdr;     /*!< Time when header, including length field, is complete */
+    uint32_t data;    /*!< Time when data part is complete */
+    uint32_t verdict; /*!< Time when CRC and stop byte are checked and packet result is known */
+    uint32_t evt;     /*!< Time when \ref LWPKT_EVT_PKT or \ref LWPKT_EVT_TIMEOUT event is dispatched */
+    uint32_t len;     /*!< Number of data bytes */
+    uint8_t res;      /*!< Packet result, member of \ref lwpktr_t. \ref lwpktINPROG on timeout */
+    uint8_t stages;   /*!< Recorded stages, combination of `LWPKT_TRACE_STAGE_x` values */
+} lwpkt_trace_t;
+#endif /* LWPKT_CFG_TRACE || __DOXYGEN__ */
+
+#if LWPKT_CFG_USE_STATS || __DOXYGEN__
+/**
+ * \brief           Statistics counters of packet instance
+ */
+typedef struct {
+    uint32_t rx_pkts;          /*!< Number of valid received packets */
+    uint32_t rx_bytes;         /*!< Number of bytes read from RX buffer */
+    uint32_t rx_skipped;       /*!< Number of bytes discarded while searching for start of packet */
+    uint32_t rx_resync;        /*!< Number of invalid packets, scanned again for start of packet */
+    uint32_t rx_err_crc;       /*!< Number of packets with invalid CRC */
+    uint32_t rx_err_stop;      /*!< Number of packets with invalid stop byte or framing */
+    uint32_t rx_err_mem;       /*!< Number of packets, that could not be stored to memory */
+    uint32_t rx_err;           /*!< Number of packets with other errors */
+    uint32_t rx_timeout;       /*!< Number of packets, aborted because next byte has not been received in time */
+    uint32_t rx_idle;          /*!< Number of packets, aborted with idle line notification */
+    uint32_t rx_filtered;      /*!< Number of packets, not accepted by receive filter */
+    uint32_t tx_pkts;          /*!< Number of written packets */
+    uint32_t tx_bytes;         /*!< Number of bytes written to TX buffer */
+    uint32_t tx_err_mem;       /*!< Number of write calls, failed because of full TX buffer */
+    size_t rx_rb_max;          /*!< Maximum number of bytes in RX buffer, seen on read */
+    size_t tx_rb_max;          /*!< Maximum number of bytes in TX buffer, seen after write */
+#if LWPKT_CFG_STATS_CYCLES || __DOXYGEN__
+    uint32_t read_calls;       /*!< Number of \ref lwpkt_read calls */
+    uint32_t read_cycles;      /*!< Total number of cycles spent in \ref lwpkt_read */
+    uint32_t read_cycles_max;  /*!< Maximum number of cycles spent in single \ref lwpkt_read call */
+    uint32_t write_calls;      /*!< Number of \ref lwpkt_write and \ref lwpkt_writev calls */
+    uint32_t write_cycles;     /*!< Total number of cycles spent in write calls */
+    uint32_t write_cycles_max; /*!< Maximum number of cycles spent in single write call */
+#endif                         /* LWPKT_CFG_STATS_CYCLES || __DOXYGEN__ */
+} lwpkt_stats_t;
+#endif /* LWPKT_CFG_USE_STATS || __DOXYGEN__ */
+
 /**
  * \brief           Packet structure
  */
@@ -136,14 +312,87 @@ typedef struct lwpkt {
 #if LWPKT_CFG_USE_ADDR || __DOXYGEN__
     lwpkt_addr_t addr;                    /*!< Current device address */
 #endif                                    /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_RX_DATA_EXT || __DOXYGEN__
+    uint8_t* data;                        /*!< Memory to write received data, provided by the application */
+    size_t data_size;                     /*!< Size of data memory, maximum length of data part */
+#elif !LWPKT_CFG_RX_ZERO_COPY && !LWPKT_CFG_RX_QUEUE
     uint8_t data[LWPKT_CFG_MAX_DATA_LEN]; /*!< Memory to write received data */
+#endif /* !LWPKT_CFG_RX_ZERO_COPY && !LWPKT_CFG_RX_QUEUE */
     lwrb_t* tx_rb;                        /*!< TX ringbuffer */
     lwrb_t* rx_rb;                        /*!< RX ringbuffer */
-    uint32_t last_rx_time;                /*!< Last RX time in units of milliseconds */
+    uint32_t last_rx_time;                /*!< Last RX time, in units of \ref lwpkt_process time argument */
+    uint32_t timeout;                     /*!< Time to wait for next byte of packet in progress */
+    size_t rx_cnt;                        /*!< Number of bytes read from RX buffer, free-running counter */
+    size_t rx_seen;                       /*!< Number of received bytes, seen by last \ref lwpkt_process call */
+    volatile size_t rx_idle_cnt;          /*!< Number of received bytes at last idle line notification */
+    volatile uint32_t rx_idle_seq;        /*!< Sequence number of idle line notification */
+    uint32_t rx_idle_seen;                /*!< Sequence number of idle line notification, handled by \ref lwpkt_process */
 #if LWPKT_CFG_USE_EVT || __DOXYGEN__
     lwpkt_evt_fn evt_fn; /*!< Global event function for read and write operation */
 #endif                   /* LWPKT_CFG_USE_EVT || __DOXYGEN__ */
     uint8_t flags;       /*!< List of flags */
+#if LWPKT_LAYOUT_DYNAMIC || __DOXYGEN__
+    lwpkt_layout_t layout; /*!< Packet layout for current flags */
+#endif                     /* LWPKT_LAYOUT_DYNAMIC || __DOXYGEN__ */
+#if LWPKT_CFG_CRC_DESC || __DOXYGEN__
+    const lwpkt_crc_desc_t* crc_desc; /*!< CRC descriptor, set to `NULL` for `CRC-8` or `CRC-32` */
+#endif                                /* LWPKT_CFG_CRC_DESC || __DOXYGEN__ */
+#if LWPKT_CFG_USE_TX_STREAM || __DOXYGEN__
+    struct {
+        lwpkt_crc_t crc; /*!< Running CRC of the packet */
+        size_t rem;      /*!< Number of data bytes remaining to write */
+        uint8_t active;  /*!< Set to `1` when stream packet is in progress */
+    } tx_stream;         /*!< Streaming transmit state */
+#endif                   /* LWPKT_CFG_USE_TX_STREAM || __DOXYGEN__ */
+#if LWPKT_CFG_USE_TX_BATCH || __DOXYGEN__
+    struct {
+        size_t len;     /*!< Number of bytes written by the batch, not committed yet */
+        size_t cnt;     /*!< Number of packets in the batch */
+        uint8_t active; /*!< Set to `1` when batch is in progress */
+    } tx_batch;         /*!< Batch transmit state */
+#endif                  /* LWPKT_CFG_USE_TX_BATCH || __DOXYGEN__ */
+#if LWPKT_CFG_TX_MPSC || __DOXYGEN__
+    lwrb_ulong_t tx_claim; /*!< Multi-producer TX state: claimed write index, number of writers and flags */
+#endif                     /* LWPKT_CFG_TX_MPSC || __DOXYGEN__ */
+#if LWPKT_CFG_RX_QUEUE || __DOXYGEN__
+    struct {
+        lwpkt_rx_slot_t slot[LWPKT_CFG_RX_QUEUE]; /*!< Queue slots */
+        lwrb_ulong_t w;                           /*!< Write counter, incremented by the parser, modulo twice the size */
+        lwrb_ulong_t r;                           /*!< Read counter, incremented by the application, modulo twice the size */
+        uint32_t overflow;                        /*!< Number of packets dropped, because queue was full */
+    } rxq;                                        /*!< Receive packet queue */
+#endif                                            /* LWPKT_CFG_RX_QUEUE || __DOXYGEN__ */
+#if LWPKT_CFG_TX_FRAMES || __DOXYGEN__
+    struct {
+        lwpkt_tx_frame_t frame[LWPKT_CFG_TX_FRAMES]; /*!< Queue entries */
+        lwrb_ulong_t w; /*!< Write counter, incremented by write functions, modulo twice the size */
+        lwrb_ulong_t r; /*!< Read counter, incremented by the application, modulo twice the size */
+        size_t idx;     /*!< Index in TX buffer memory of the frame being written */
+        size_t pad;     /*!< Number of padding bytes before the frame being written */
+    } txq;              /*!< Transmit frame queue */
+#endif                  /* LWPKT_CFG_TX_FRAMES || __DOXYGEN__ */
+#if LWPKT_CFG_RX_RESYNC || __DOXYGEN__
+    struct {
+        size_t off;   /*!< Number of processed bytes, still kept in RX buffer */
+        uint8_t hold; /*!< Set to `1` when bytes of current packet are kept in RX buffer */
+    } rx_hold;        /*!< Resynchronization state */
+#endif                /* LWPKT_CFG_RX_RESYNC || __DOXYGEN__ */
+#if LWPKT_CFG_RX_FILTER || __DOXYGEN__
+    const lwpkt_filter_t* filter; /*!< Receive filter. Set to `NULL` to accept all packets */
+#endif                            /* LWPKT_CFG_RX_FILTER || __DOXYGEN__ */
+#if LWPKT_CFG_USE_STATS || __DOXYGEN__
+    lwpkt_stats_t stats; /*!< Statistics counters */
+#endif                   /* LWPKT_CFG_USE_STATS || __DOXYGEN__ */
+#if LWPKT_CFG_TRACE || __DOXYGEN__
+    struct {
+        lwpkt_trace_t rec[LWPKT_CFG_TRACE]; /*!< Finished records */
+        lwpkt_trace_t cur;                  /*!< Record of packet in progress */
+        lwrb_ulong_t w;                     /*!< Write counter, incremented by the parser, modulo twice the size */
+        lwrb_ulong_t r;   /*!< Read counter, incremented by the application, modulo twice the size */
+        uint32_t lost;    /*!< Number of records dropped, because trace was full */
+        uint8_t defer;    /*!< Set to `1` when record is finished after event dispatch */
+    } trace;              /*!< Packet latency trace */
+#endif                    /* LWPKT_CFG_TRACE || __DOXYGEN__ */
 
     struct {
         lwpkt_state_t state; /*!< Actual packet state machine */
@@ -163,10 +412,49 @@ typedef struct lwpkt {
 #endif                /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
         size_t len;   /*!< Number of bytes to receive */
         size_t index; /*!< General index variable for multi-byte parts of packet */
-    } m;              /*!< Module that is periodically reset for next packet */
+#if LWPKT_CFG_RX_QUEUE || __DOXYGEN__
+        uint8_t drop; /*!< Set to `1` when packet is dropped, because queue is full */
+#endif                /* LWPKT_CFG_RX_QUEUE || __DOXYGEN__ */
+#if LWPKT_CFG_RX_FILTER || __DOXYGEN__
+        uint8_t filtered; /*!< Set to `1` when packet is not accepted by receive filter and is skipped */
+#endif                    /* LWPKT_CFG_RX_FILTER || __DOXYGEN__ */
+#if LWPKT_CFG_USE_COBS || __DOXYGEN__
+        struct {
+            uint8_t run;  /*!< Number of bytes remaining in current COBS block */
+            uint8_t zero; /*!< Set to `1` when current block is followed by `0x00` byte */
+            uint8_t skip; /*!< Set to `1` to ignore all bytes until next delimiter */
+        } cobs;           /*!< COBS decoder state */
+#endif                    /* LWPKT_CFG_USE_COBS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_RX_STREAM || __DOXYGEN__
+        struct {
+            const void* data; /*!< Pointer to current data fragment */
+            size_t len;       /*!< Length of current data fragment */
+            size_t offset;    /*!< Offset of current data fragment in data part of the packet */
+            lwpktr_t res;     /*!< Final packet result */
+            uint8_t active;   /*!< Set to `1` when packet is received in streaming mode */
+        } stream;             /*!< Streaming receive state */
+#endif                        /* LWPKT_CFG_USE_RX_STREAM || __DOXYGEN__ */
+#if LWPKT_CFG_RX_ZERO_COPY || __DOXYGEN__
+        lwpkt_seg_t view[2]; /*!< Data part in the RX buffer. Second segment is used when data wrap around */
+        size_t view_hold;    /*!< Number of bytes in RX buffer held by the view, released on next read */
+#endif                       /* LWPKT_CFG_RX_ZERO_COPY || __DOXYGEN__ */
+    } m;                     /*!< Module that is periodically reset for next packet */
 } lwpkt_t;
 
+#if LWPKT_CFG_TX_LANES || __DOXYGEN__
+/**
+ * \brief           Transmit scheduler with priority lanes
+ */
+typedef struct {
+    lwpkt_t* lane[LWPKT_CFG_TX_LANES]; /*!< Lane instances, lane `0` has the highest priority */
+    lwpkt_t* cur;                      /*!< Lane of the frame in transmission, `NULL` when no frame is taken */
+} lwpkt_tx_sched_t;
+#endif /* LWPKT_CFG_TX_LANES || __DOXYGEN__ */
+
 lwpktr_t lwpkt_init(lwpkt_t* pkt, lwrb_t* tx_rb, lwrb_t* rx_rb);
+#if LWPKT_CFG_RX_DATA_EXT || __DOXYGEN__
+lwpktr_t lwpkt_init_ex(lwpkt_t* pkt, lwrb_t* tx_rb, lwrb_t* rx_rb, void* rx_data, size_t rx_data_size);
+#endif /* LWPKT_CFG_RX_DATA_EXT || __DOXYGEN__ */
 lwpktr_t lwpkt_set_addr(lwpkt_t* pkt, lwpkt_addr_t addr);
 lwpktr_t lwpkt_read(lwpkt_t* pkt);
 lwpktr_t lwpkt_write(lwpkt_t* pkt,
@@ -180,9 +468,86 @@ lwpktr_t lwpkt_write(lwpkt_t* pkt,
                      uint32_t cmd,
 #endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
                      const void* data, size_t len);
+lwpktr_t lwpkt_writev(lwpkt_t* pkt,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+                      lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+                      uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+                      uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+                      const lwpkt_seg_t* seg, size_t seg_cnt);
+lwpktr_t lwpkt_write_begin(lwpkt_t* pkt,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+                           lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+                           uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+                           uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+                           size_t len);
+lwpktr_t lwpkt_write_chunk(lwpkt_t* pkt, const void* data, size_t len, size_t* bw);
+lwpktr_t lwpkt_write_end(lwpkt_t* pkt);
+#if LWPKT_CFG_USE_TX_BATCH || __DOXYGEN__
+lwpktr_t lwpkt_batch_begin(lwpkt_t* pkt);
+lwpktr_t lwpkt_batch_write(lwpkt_t* pkt,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+                           lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+                           uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+                           uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+                           const void* data, size_t len);
+lwpktr_t lwpkt_batch_commit(lwpkt_t* pkt);
+#endif /* LWPKT_CFG_USE_TX_BATCH || __DOXYGEN__ */
 lwpktr_t lwpkt_reset(lwpkt_t* pkt);
 lwpktr_t lwpkt_process(lwpkt_t* pkt, uint32_t time);
+lwpktr_t lwpkt_set_timeout(lwpkt_t* pkt, uint32_t timeout);
+lwpktr_t lwpkt_rx_idle(lwpkt_t* pkt);
 lwpktr_t lwpkt_set_evt_fn(lwpkt_t* pkt, lwpkt_evt_fn evt_fn);
+lwpktr_t lwpkt_get_view(const lwpkt_t* pkt, lwpkt_seg_t* seg);
+lwpktr_t lwpkt_release_view(lwpkt_t* pkt);
+#if LWPKT_CFG_RX_QUEUE || __DOXYGEN__
+const lwpkt_rx_slot_t* lwpkt_rxq_get(lwpkt_t* pkt);
+lwpktr_t lwpkt_rxq_release(lwpkt_t* pkt);
+size_t lwpkt_rxq_get_count(lwpkt_t* pkt);
+#endif /* LWPKT_CFG_RX_QUEUE || __DOXYGEN__ */
+#if LWPKT_CFG_TX_FRAMES || __DOXYGEN__
+const lwpkt_tx_frame_t* lwpkt_txq_get(lwpkt_t* pkt);
+lwpktr_t lwpkt_txq_release(lwpkt_t* pkt);
+size_t lwpkt_txq_get_count(lwpkt_t* pkt);
+#endif /* LWPKT_CFG_TX_FRAMES || __DOXYGEN__ */
+#if LWPKT_CFG_TX_LANES || __DOXYGEN__
+lwpktr_t lwpkt_tx_sched_init(lwpkt_tx_sched_t* sched);
+lwpktr_t lwpkt_tx_sched_set_lane(lwpkt_tx_sched_t* sched, size_t prio, lwpkt_t* pkt);
+const lwpkt_tx_frame_t* lwpkt_tx_sched_get(lwpkt_tx_sched_t* sched);
+lwpktr_t lwpkt_tx_sched_release(lwpkt_tx_sched_t* sched);
+#endif /* LWPKT_CFG_TX_LANES || __DOXYGEN__ */
+#if LWPKT_CFG_USE_STATS || __DOXYGEN__
+lwpktr_t lwpkt_get_stats(const lwpkt_t* pkt, lwpkt_stats_t* stats);
+lwpktr_t lwpkt_reset_stats(lwpkt_t* pkt);
+#endif /* LWPKT_CFG_USE_STATS || __DOXYGEN__ */
+#if LWPKT_CFG_TRACE || __DOXYGEN__
+lwpktr_t lwpkt_trace_read(lwpkt_t* pkt, lwpkt_trace_t* rec);
+size_t lwpkt_trace_get_count(lwpkt_t* pkt);
+#endif /* LWPKT_CFG_TRACE || __DOXYGEN__ */
+#if LWPKT_CFG_RX_FILTER || __DOXYGEN__
+lwpktr_t lwpkt_set_filter(lwpkt_t* pkt, const lwpkt_filter_t* filter);
+#endif /* LWPKT_CFG_RX_FILTER || __DOXYGEN__ */
+#if LWPKT_CFG_CRC_DESC || __DOXYGEN__
+lwpktr_t lwpkt_set_crc_desc(lwpkt_t* pkt, const lwpkt_crc_desc_t* desc);
+lwpktr_t lwpkt_crc_table_gen(const lwpkt_crc_desc_t* desc, uint32_t* table);
+
+extern const lwpkt_crc_desc_t lwpkt_crc_desc_crc16_ccitt;
+extern const lwpkt_crc_desc_t lwpkt_crc_desc_crc32c;
+#endif /* LWPKT_CFG_CRC_DESC || __DOXYGEN__ */
 
 /* Functions available as conditional build */
 void lwpkt_set_addr_enabled(lwpkt_t* pkt, uint8_t enable);
@@ -192,6 +557,12 @@ void lwpkt_set_cmd_enabled(lwpkt_t* pkt, uint8_t enable);
 void lwpkt_set_cmd_extended_enabled(lwpkt_t* pkt, uint8_t enable);
 void lwpkt_set_crc_enabled(lwpkt_t* pkt, uint8_t enable);
 void lwpkt_set_crc32_enabled(lwpkt_t* pkt, uint8_t enable);
+void lwpkt_set_cobs_enabled(lwpkt_t* pkt, uint8_t enable);
+
+/* Functions implemented by the application */
+uint8_t lwpkt_crc_hw_in(lwpkt_crc_t* crcobj, const void* inp, size_t len);
+uint32_t lwpkt_stats_get_cycles(void);
+uint32_t lwpkt_trace_get_time(void);
 
 /**
  * \brief           Get address from where packet was sent
@@ -214,12 +585,72 @@ void lwpkt_set_crc32_enabled(lwpkt_t* pkt, uint8_t enable);
  */
 #define lwpkt_get_data_len(pkt)  (size_t)(((pkt) != NULL) ? ((pkt)->m.len) : 0)
 
+#if LWPKT_CFG_RX_ZERO_COPY || __DOXYGEN__
 /**
  * \brief           Get pointer to packet data
+ * \note            In zero-copy mode, pointer is valid only if data are contiguous in the RX buffer,
+ *                  otherwise `NULL` is returned. Use \ref lwpkt_get_view to get both segments
  * \param[in]       pkt: LwPKT instance
  * \return          Pointer to data
  */
-#define lwpkt_get_data(pkt)      (void*)(((pkt) != NULL) ? ((pkt)->data) : NULL)
+#define lwpkt_get_data(pkt)                                                                                            \
+    (void*)((((pkt) != NULL) && (pkt)->m.view[1].len == 0) ? ((pkt)->m.view[0].data) : NULL)
+#elif LWPKT_CFG_RX_QUEUE
+/* Data of last received packet, valid until its slot is released */
+#define lwpkt_get_data(pkt)                                                                                            \
+    (void*)(((pkt) != NULL) ? ((pkt)->rxq.slot[((pkt)->rxq.w + 2U * LWPKT_CFG_RX_QUEUE - 1U) % LWPKT_CFG_RX_QUEUE].data)  \
+                            : NULL)
+#else /* LWPKT_CFG_RX_ZERO_COPY || __DOXYGEN__ */
+#define lwpkt_get_data(pkt) (void*)(((pkt) != NULL) ? ((pkt)->data) : NULL)
+#endif /* !(LWPKT_CFG_RX_ZERO_COPY || __DOXYGEN__) */
+
+#if LWPKT_CFG_RX_QUEUE || __DOXYGEN__
+/**
+ * \brief           Get number of packets dropped, because receive queue was full
+ * \param[in]       pkt: LwPKT instance
+ * \return          Number of dropped packets
+ */
+#define lwpkt_rxq_get_overflow(pkt) (uint32_t)(((pkt) != NULL) ? ((pkt)->rxq.overflow) : 0)
+#endif /* LWPKT_CFG_RX_QUEUE || __DOXYGEN__ */
+
+#if LWPKT_CFG_TRACE || __DOXYGEN__
+/**
+ * \brief           Get number of trace records dropped, because trace was full
+ * \param[in]       pkt: LwPKT instance
+ * \return          Number of dropped records
+ */
+#define lwpkt_trace_get_lost(pkt) (uint32_t)(((pkt) != NULL) ? ((pkt)->trace.lost) : 0)
+#endif /* LWPKT_CFG_TRACE || __DOXYGEN__ */
+
+/**
+ * \brief           Get pointer to current data fragment of stream packet
+ * \note            Valid only during \ref LWPKT_EVT_STREAM_DATA event
+ * \param[in]       pkt: LwPKT instance
+ * \return          Pointer to data fragment
+ */
+#define lwpkt_get_stream_data(pkt)        (const void*)(((pkt) != NULL) ? ((pkt)->m.stream.data) : NULL)
+
+/**
+ * \brief           Get length of current data fragment of stream packet
+ * \param[in]       pkt: LwPKT instance
+ * \return          Number of bytes in data fragment
+ */
+#define lwpkt_get_stream_data_len(pkt)    (size_t)(((pkt) != NULL) ? ((pkt)->m.stream.len) : 0)
+
+/**
+ * \brief           Get offset of current data fragment of stream packet, in data part of the packet
+ * \param[in]       pkt: LwPKT instance
+ * \return          Offset in units of bytes
+ */
+#define lwpkt_get_stream_data_offset(pkt) (size_t)(((pkt) != NULL) ? ((pkt)->m.stream.offset) : 0)
+
+/**
+ * \brief           Get final result of stream packet
+ * \note            Valid during \ref LWPKT_EVT_STREAM_END event
+ * \param[in]       pkt: LwPKT instance
+ * \return          \ref lwpktVALID if packet is valid, member of \ref lwpktr_t otherwise
+ */
+#define lwpkt_get_stream_result(pkt)      (lwpktr_t)(((pkt) != NULL) ? ((pkt)->m.stream.res) : lwpktERR)
 
 /**
  * \brief           Get packet command data field
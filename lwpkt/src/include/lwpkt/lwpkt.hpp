@@ -0,0 +1,557 @@
+/**
+ * \file            lwpkt.hpp
+ * \brief           Header-only C++ packet codec with compile-time configuration
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#ifndef LWPKT_HDR_HPP
+#define LWPKT_HDR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+/**
+ * \defgroup        LWPKT_CPP C++ codec
+ * \brief           Packet encoder and decoder, configured at compile time
+ * \{
+ *
+ * Codec produces and accepts the same packets as C library with the same features enabled.
+ * Features are template parameters, hence every configuration has own specialised code
+ * and one application can use many differently configured links.
+ * Header does not depend on `lwpkt_opt.h` options and does not require C library to be compiled.
+ */
+
+namespace lwpkt {
+
+/**
+ * \brief           CRC algorithm of the packet
+ */
+enum class Crc : uint8_t {
+    none,  /*!< Packet has no CRC */
+    crc8,  /*!< `CRC-8`, same as \ref LWPKT_CFG_USE_CRC with \ref LWPKT_CFG_CRC32 disabled */
+    crc32, /*!< `CRC-32`, same as \ref LWPKT_CFG_CRC32 */
+};
+
+/**
+ * \brief           Codec configuration, used as template parameter of \ref lwpkt::Codec
+ */
+struct Config {
+    bool addr = true;                 /*!< Packet has from and to address fields */
+    bool addr_ext = false;            /*!< Address fields are variable length integers instead of one byte */
+    bool flags = false;               /*!< Packet has custom flags field */
+    bool cmd = true;                  /*!< Packet has command field */
+    bool cmd_ext = false;             /*!< Command field is variable length integer instead of one byte */
+    Crc crc = Crc::crc8;              /*!< CRC of the packet */
+    std::size_t max_data_len = 256;   /*!< Maximum length of data part of received packet */
+};
+
+/**
+ * \brief           Result of codec operation, with the same values as `lwpktr_t`
+ */
+enum class Result : uint8_t {
+    ok,       /*!< Function returns successfully */
+    err,      /*!< General error */
+    inprog,   /*!< All input processed, packet is in progress */
+    valid,    /*!< Packet is valid */
+    errcrc,   /*!< CRC integrity error */
+    errstop,  /*!< Wrong character received for stop byte */
+    waitdata, /*!< All input processed, waiting for start byte */
+    errmem,   /*!< Data part of packet longer than maximum data length */
+};
+
+/**
+ * \brief           Packet header fields. Fields of disabled features are `0`
+ */
+struct Header {
+    uint32_t from = 0;  /*!< Device address packet is coming from */
+    uint32_t to = 0;    /*!< Device address packet is intended for */
+    uint32_t flags = 0; /*!< Custom flags */
+    uint32_t cmd = 0;   /*!< Command */
+};
+
+/**
+ * \brief           Received packet. Data part is not copied to the view
+ *
+ * Data part refers either to the input memory, when full packet is contiguous in one input block,
+ * or to the memory of the codec. It is valid until the input memory is reused or until next read operation.
+ */
+struct PacketView {
+    Header hdr;                    /*!< Header fields */
+    std::span<const uint8_t> data; /*!< Data part */
+};
+
+namespace detail {
+
+inline constexpr uint8_t start_byte = 0xAA;
+inline constexpr uint8_t stop_byte = 0x55;
+inline constexpr std::size_t varint_max_len = 5;
+
+/* Reflected CRC lookup table, built at compile time */
+template <typename T, T Poly>
+constexpr std::array<T, 256>
+crc_table() {
+    std::array<T, 256> table{};
+
+    for (unsigned i = 0; i < 256; ++i) {
+        T crc = static_cast<T>(i);
+        for (unsigned b = 0; b < 8; ++b) {
+            crc = (crc & 0x01U) ? static_cast<T>((crc >> 1U) ^ Poly) : static_cast<T>(crc >> 1U);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline constexpr auto crc8_table = crc_table<uint8_t, 0x8C>();
+inline constexpr auto crc32_table = crc_table<uint32_t, 0xEDB88320UL>();
+
+constexpr std::size_t
+varint_len(uint32_t num) {
+    std::size_t len = 1;
+
+    for (; num > 0x7FU; num >>= 7U) {
+        ++len;
+    }
+    return len;
+}
+
+constexpr uint8_t*
+varint_encode(uint8_t* out, uint32_t num) {
+    for (; num > 0x7FU; num >>= 7U) {
+        *out++ = static_cast<uint8_t>(num | 0x80U);
+    }
+    *out++ = static_cast<uint8_t>(num);
+    return out;
+}
+
+} // namespace detail
+
+/**
+ * \brief           Packet encoder and decoder
+ * \tparam          Cfg: Codec configuration
+ *
+ * Encoding is stateless. Decoding keeps state between calls, hence every link needs own codec object.
+ * Object contains receive memory of `Cfg.max_data_len` bytes and does not allocate.
+ */
+template <Config Cfg>
+class Codec {
+    static_assert(Cfg.addr || !Cfg.addr_ext, "Extended address requires address field");
+    static_assert(Cfg.cmd || !Cfg.cmd_ext, "Extended command requires command field");
+
+  public:
+    /**
+     * \brief           Number of CRC bytes
+     */
+    static constexpr std::size_t crc_len = Cfg.crc == Crc::crc32 ? 4 : (Cfg.crc == Crc::crc8 ? 1 : 0);
+
+    /**
+     * \brief           Maximum length of the header, including start byte
+     */
+    static constexpr std::size_t header_max_len = 1U + (Cfg.addr ? (Cfg.addr_ext ? 2 * detail::varint_max_len : 2) : 0)
+                                                  + (Cfg.flags ? detail::varint_max_len : 0)
+                                                  + (Cfg.cmd ? (Cfg.cmd_ext ? detail::varint_max_len : 1) : 0)
+                                                  + detail::varint_max_len;
+
+    /**
+     * \brief           Get maximum length of the packet, regardless of header values
+     * \param[in]       len: Length of data part
+     * \return          Number of bytes
+     */
+    static constexpr std::size_t
+    frame_max_len(std::size_t len) noexcept {
+        return header_max_len + len + crc_len + 1U;
+    }
+
+    /**
+     * \brief           Get exact length of the packet
+     * \param[in]       hdr: Header fields
+     * \param[in]       len: Length of data part
+     * \return          Number of bytes
+     */
+    static constexpr std::size_t
+    frame_len(const Header& hdr, std::size_t len) noexcept {
+        std::size_t n = 1U + detail::varint_len(static_cast<uint32_t>(len)) + len + crc_len + 1U;
+
+        if constexpr (Cfg.addr) {
+            n += Cfg.addr_ext ? detail::varint_len(hdr.from) + detail::varint_len(hdr.to) : 2U;
+        }
+        if constexpr (Cfg.flags) {
+            n += detail::varint_len(hdr.flags);
+        }
+        if constexpr (Cfg.cmd) {
+            n += Cfg.cmd_ext ? detail::varint_len(hdr.cmd) : 1U;
+        }
+        return n;
+    }
+
+    /**
+     * \brief           Encode packet to output memory
+     * \param[out]      out: Output memory, at least \ref frame_len bytes long
+     * \param[in]       hdr: Header fields. Fields of disabled features are ignored,
+     *                      addresses and command are truncated to one byte when not extended
+     * \param[in]       data: Data part
+     * \return          Number of bytes written, `0` if packet does not fit to the output memory
+     */
+    static std::size_t
+    encode(std::span<uint8_t> out, const Header& hdr, std::span<const uint8_t> data) noexcept {
+        const std::size_t len = frame_len(hdr, data.size());
+        uint8_t* p = out.data();
+
+        if (out.size() < len || data.size() > UINT32_MAX) {
+            return 0;
+        }
+        *p++ = detail::start_byte;
+        if constexpr (Cfg.addr) {
+            if constexpr (Cfg.addr_ext) {
+                p = detail::varint_encode(p, hdr.from);
+                p = detail::varint_encode(p, hdr.to);
+            } else {
+                *p++ = static_cast<uint8_t>(hdr.from);
+                *p++ = static_cast<uint8_t>(hdr.to);
+            }
+        }
+        if constexpr (Cfg.flags) {
+            p = detail::varint_encode(p, hdr.flags);
+        }
+        if constexpr (Cfg.cmd) {
+            if constexpr (Cfg.cmd_ext) {
+                p = detail::varint_encode(p, hdr.cmd);
+            } else {
+                *p++ = static_cast<uint8_t>(hdr.cmd);
+            }
+        }
+        p = detail::varint_encode(p, static_cast<uint32_t>(data.size()));
+        if (!data.empty()) {
+            std::memcpy(p, data.data(), data.size());
+            p += data.size();
+        }
+        if constexpr (crc_len > 0) {
+            uint32_t crc = crc_finish(crc_update(crc_init(), out.subspan(1, static_cast<std::size_t>(p - out.data()) - 1U)));
+
+            for (std::size_t i = 0; i < crc_len; ++i, crc >>= 8U) {
+                *p++ = static_cast<uint8_t>(crc);
+            }
+        }
+        *p++ = detail::stop_byte;
+        return len;
+    }
+
+    /**
+     * \brief           Decode packets from input data
+     *
+     * Function processes input until one packet is finished, and removes processed bytes from the input.
+     * It is called again with the same input, until it returns \ref Result::waitdata or \ref Result::inprog.
+     *
+     * Packet, which is fully contiguous in the input, is decoded directly from it.
+     * Otherwise bytes are processed one by one and data part is stored to the codec memory.
+     *
+     * \param[in,out]   in: Input data. On return, it refers to bytes not processed yet
+     * \param[out]      pkt: Packet view, set when function returns \ref Result::valid
+     * \return          \ref Result::valid when packet is valid, \ref Result::waitdata or \ref Result::inprog
+     *                      when all input is processed, member of \ref Result on packet error
+     */
+    Result
+    read(std::span<const uint8_t>& in, PacketView& pkt) noexcept {
+        Result res;
+
+        while (!in.empty()) {
+            if (state_ == State::start) {
+                const void* s = std::memchr(in.data(), detail::start_byte, in.size());
+
+                if (s == nullptr) {
+                    in = {};
+                    break;
+                }
+                in = in.subspan(static_cast<std::size_t>(static_cast<const uint8_t*>(s) - in.data()) + 1U);
+                if ((res = decode_frame(in, pkt)) != Result::inprog) {
+                    return res;
+                }
+
+                /* Packet continues in next input, go byte by byte */
+                hdr_ = Header{};
+                crc_ = crc_init();
+                next_state();
+                continue;
+            }
+            if ((res = input(in)) != Result::ok) {
+                if (res == Result::valid) {
+                    pkt.hdr = hdr_;
+                    pkt.data = std::span<const uint8_t>(buff_.data(), len_);
+                }
+                return res;
+            }
+        }
+        return state_ == State::start ? Result::waitdata : Result::inprog;
+    }
+
+    /**
+     * \brief           Abort packet in progress and wait for next start byte
+     */
+    void
+    reset() noexcept {
+        state_ = State::start;
+    }
+
+    /**
+     * \brief           Check if packet is in progress
+     * \return          `true` when start byte has been received and packet is not finished yet
+     */
+    bool
+    in_progress() const noexcept {
+        return state_ != State::start;
+    }
+
+  private:
+    enum class State : uint8_t { start, from, to, flags, cmd, len, data, crc, stop };
+
+    static constexpr uint32_t
+    crc_init() noexcept {
+        return Cfg.crc == Crc::crc32 ? 0xFFFFFFFFUL : 0;
+    }
+
+    static constexpr uint32_t
+    crc_finish(uint32_t crc) noexcept {
+        return Cfg.crc == Crc::crc32 ? (crc ^ 0xFFFFFFFFUL) : crc;
+    }
+
+    static uint32_t
+    crc_update(uint32_t crc, std::span<const uint8_t> d) noexcept {
+        if constexpr (Cfg.crc == Crc::crc32) {
+            for (uint8_t b : d) {
+                crc = (crc >> 8U) ^ detail::crc32_table[(crc ^ b) & 0xFFU];
+            }
+        } else if constexpr (Cfg.crc == Crc::crc8) {
+            for (uint8_t b : d) {
+                crc = detail::crc8_table[(crc ^ b) & 0xFFU];
+            }
+        }
+        return crc;
+    }
+
+    /* Decode field from contiguous memory, returns `false` if field is not complete */
+    template <bool Ext>
+    static bool
+    get_field(const uint8_t*& p, const uint8_t* end, uint32_t& val) noexcept {
+        if (p == end) {
+            return false;
+        }
+        val = *p++;
+        if constexpr (Ext) {
+            if (val & 0x80U) {
+                uint32_t num = val & 0x7FU;
+                uint8_t b;
+
+                for (std::size_t idx = 1;; ++idx) {
+                    if (p == end) {
+                        return false;
+                    }
+                    b = *p++;
+                    if (idx < detail::varint_max_len) {
+                        num |= static_cast<uint32_t>(b & 0x7FU) << (7U * idx);
+                    }
+                    if ((b & 0x80U) == 0) {
+                        break;
+                    }
+                }
+                val = num;
+            }
+        }
+        return true;
+    }
+
+    /* Decode full packet from input, which starts after start byte. Nothing is consumed when packet is not complete */
+    Result
+    decode_frame(std::span<const uint8_t>& in, PacketView& pkt) const noexcept {
+        const uint8_t *p = in.data(), *end = in.data() + in.size();
+        uint32_t len;
+
+        pkt.hdr = Header{};
+        if constexpr (Cfg.addr) {
+            if (!get_field<Cfg.addr_ext>(p, end, pkt.hdr.from) || !get_field<Cfg.addr_ext>(p, end, pkt.hdr.to)) {
+                return Result::inprog;
+            }
+        }
+        if constexpr (Cfg.flags) {
+            if (!get_field<true>(p, end, pkt.hdr.flags)) {
+                return Result::inprog;
+            }
+        }
+        if constexpr (Cfg.cmd) {
+            if (!get_field<Cfg.cmd_ext>(p, end, pkt.hdr.cmd)) {
+                return Result::inprog;
+            }
+        }
+        if (!get_field<true>(p, end, len)) {
+            return Result::inprog;
+        }
+        if (len > Cfg.max_data_len) {
+            in = in.subspan(static_cast<std::size_t>(p - in.data()));
+            return Result::errmem;
+        }
+        if (static_cast<std::size_t>(end - p) < len + crc_len + 1U) {
+            return Result::inprog;
+        }
+        pkt.data = std::span<const uint8_t>(p, len);
+        p += len;
+        if constexpr (crc_len > 0) {
+            uint32_t crc = crc_finish(crc_update(crc_init(), std::span<const uint8_t>(in.data(), p)));
+            uint32_t crc_recv = 0;
+
+            for (std::size_t i = 0; i < crc_len; ++i) {
+                crc_recv |= static_cast<uint32_t>(*p++) << (8U * i);
+            }
+            if (crc != crc_recv) {
+                in = in.subspan(static_cast<std::size_t>(p - in.data()));
+                return Result::errcrc;
+            }
+        }
+        in = in.subspan(static_cast<std::size_t>(p - in.data()) + 1U);
+        return p[0] == detail::stop_byte ? Result::valid : Result::errstop;
+    }
+
+    /* Go to next state, skipping fields of disabled features */
+    void
+    next_state() noexcept {
+        switch (state_) {
+            case State::start:
+                state_ = Cfg.addr ? State::from : (Cfg.flags ? State::flags : (Cfg.cmd ? State::cmd : State::len));
+                break;
+            case State::from: state_ = State::to; break;
+            case State::to: state_ = Cfg.flags ? State::flags : (Cfg.cmd ? State::cmd : State::len); break;
+            case State::flags: state_ = Cfg.cmd ? State::cmd : State::len; break;
+            case State::cmd: state_ = State::len; break;
+            case State::len:
+                if (len_ == 0) {
+                    state_ = crc_len > 0 ? State::crc : State::stop;
+                    break;
+                }
+                state_ = State::data;
+                break;
+            case State::data: state_ = crc_len > 0 ? State::crc : State::stop; break;
+            default: state_ = State::stop; break;
+        }
+        idx_ = 0;
+        val_ = 0;
+    }
+
+    /* Process input byte by byte, data part is copied in bulk */
+    Result
+    input(std::span<const uint8_t>& in) noexcept {
+        uint8_t b;
+
+        if (state_ == State::data) {
+            const std::size_t n = std::min(in.size(), len_ - idx_);
+
+            std::memcpy(&buff_[idx_], in.data(), n);
+            crc_ = crc_update(crc_, in.first(n));
+            in = in.subspan(n);
+            idx_ += n;
+            if (idx_ == len_) {
+                next_state();
+            }
+            return Result::ok;
+        }
+
+        b = in[0];
+        in = in.subspan(1);
+        switch (state_) {
+            case State::from:
+            case State::to:
+            case State::flags:
+            case State::cmd:
+            case State::len: {
+                const bool ext = state_ == State::flags || state_ == State::len
+                                 || (Cfg.addr_ext && (state_ == State::from || state_ == State::to))
+                                 || (Cfg.cmd_ext && state_ == State::cmd);
+
+                crc_ = crc_update(crc_, std::span<const uint8_t>(&b, 1));
+                if (idx_ < detail::varint_max_len) {
+                    val_ |= static_cast<uint32_t>(ext ? (b & 0x7FU) : b) << (7U * idx_);
+                }
+                ++idx_;
+                if (ext && (b & 0x80U)) {
+                    break;
+                }
+                switch (state_) {
+                    case State::from: hdr_.from = val_; break;
+                    case State::to: hdr_.to = val_; break;
+                    case State::flags: hdr_.flags = val_; break;
+                    case State::cmd: hdr_.cmd = val_; break;
+                    default: {
+                        if (val_ > Cfg.max_data_len) {
+                            state_ = State::start;
+                            return Result::errmem;
+                        }
+                        len_ = val_;
+                        break;
+                    }
+                }
+                next_state();
+                break;
+            }
+            case State::crc: {
+                val_ |= static_cast<uint32_t>(b) << (8U * idx_);
+                if (++idx_ == crc_len) {
+                    if (crc_finish(crc_) != val_) {
+                        state_ = State::start;
+                        return Result::errcrc;
+                    }
+                    next_state();
+                }
+                break;
+            }
+            default: {
+                state_ = State::start;
+                return b == detail::stop_byte ? Result::valid : Result::errstop;
+            }
+        }
+        return Result::ok;
+    }
+
+    State state_ = State::start;
+    Header hdr_{};
+    std::size_t len_ = 0;
+    std::size_t idx_ = 0;
+    uint32_t val_ = 0;
+    uint32_t crc_ = 0;
+    std::array<uint8_t, Cfg.max_data_len> buff_{};
+};
+
+} // namespace lwpkt
+
+/**
+ * \}
+ */
+
+#endif /* LWPKT_HDR_HPP */
@@ -0,0 +1,91 @@
+/**
+ * \file            lwpkt_engine.h
+ * \brief           Multi-channel packet engine
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#ifndef LWPKT_ENGINE_HDR_H
+#define LWPKT_ENGINE_HDR_H
+
+#include <stdint.h>
+#include "lwpkt/lwpkt.h"
+#include "lwrb/lwrb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \defgroup        LWPKT_ENGINE Multi-channel packet engine
+ * \brief           Service many packet instances with single process call
+ * \{
+ */
+
+#if LWPKT_CFG_USE_ENGINE || __DOXYGEN__
+
+struct lwpkt_engine;
+
+/**
+ * \brief           Engine channel structure
+ */
+typedef struct {
+    lwpkt_t* pkt;             /*!< Packet instance. Set to `NULL` when channel is not used */
+    struct lwpkt_engine* eng; /*!< Engine channel belongs to */
+    uint32_t deadline;        /*!< Time when packet in progress times out, in \ref lwpkt_process time units. Valid when armed */
+    uint8_t slot;             /*!< Timer wheel slot, channel is armed in */
+} lwpkt_engine_ch_t;
+
+/**
+ * \brief           Engine structure
+ */
+typedef struct lwpkt_engine {
+    lwpkt_engine_ch_t ch[LWPKT_CFG_ENGINE_CHANNELS]; /*!< List of channels */
+    lwrb_ulong_t ready;                              /*!< Bit mask of channels with new data in RX buffer */
+    uint32_t armed;                                  /*!< Bit mask of channels with running timeout */
+    uint32_t wheel[LWPKT_CFG_ENGINE_WHEEL_SLOTS];    /*!< Timer wheel. Each slot holds bit mask of armed channels */
+    uint32_t tick;                                   /*!< Last processed timer wheel tick */
+} lwpkt_engine_t;
+
+lwpktr_t lwpkt_engine_init(lwpkt_engine_t* eng);
+lwpktr_t lwpkt_engine_add(lwpkt_engine_t* eng, lwpkt_t* pkt);
+lwpktr_t lwpkt_engine_remove(lwpkt_engine_t* eng, lwpkt_t* pkt);
+lwpktr_t lwpkt_engine_process(lwpkt_engine_t* eng, uint32_t time);
+
+#endif /* LWPKT_CFG_USE_ENGINE || __DOXYGEN__ */
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LWPKT_ENGINE_HDR_H */
@@ -0,0 +1,149 @@
+/**
+ * \file            lwpkt_frag.h
+ * \brief           Fragmentation and reassembly of large messages
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#ifndef LWPKT_FRAG_HDR_H
+#define LWPKT_FRAG_HDR_H
+
+#include <stdint.h>
+#include "lwpkt/lwpkt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \defgroup        LWPKT_FRAG Fragmentation
+ * \brief           Split large messages to packets and reassemble them on the receiver
+ * \{
+ */
+
+#if LWPKT_CFG_USE_FRAG || __DOXYGEN__
+
+/**
+ * \brief           Length of fragment header at the beginning of data part of each packet
+ *
+ * Header consists of message ID (`1` byte), fragment index, number of fragments
+ * and fragment length (`2` bytes each, little endian)
+ */
+#define LWPKT_FRAG_HDR_LEN 7U
+
+/**
+ * \brief           Fragmentation structure
+ */
+typedef struct {
+    lwpkt_t* pkt;       /*!< Packet instance to write and read fragments */
+    size_t frag_len;    /*!< Maximum number of message bytes in one fragment */
+    uint32_t timeout;   /*!< Time to wait for next fragment of message in progress */
+
+    struct {
+        const uint8_t* data; /*!< Message data. Must stay valid until all fragments are written */
+        size_t len;          /*!< Message length in units of bytes */
+        size_t idx;          /*!< Index of next fragment to write */
+        size_t cnt;          /*!< Number of fragments of the message */
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+        lwpkt_addr_t to; /*!< End device address */
+#endif                   /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+        uint32_t flags; /*!< Custom user flags */
+#endif                  /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+        uint32_t cmd; /*!< Packet command */
+#endif                /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+        uint8_t id;   /*!< Message ID */
+    } tx;             /*!< Transmit state */
+
+    struct {
+        uint8_t* buff; /*!< Memory for reassembled message, provided by the application */
+        size_t size;   /*!< Size of message memory in units of bytes */
+        size_t len;    /*!< Message length, valid when message is complete */
+        uint32_t map[(LWPKT_CFG_FRAG_MAX_CNT + 31U) / 32U]; /*!< Bitmap of received fragments */
+        size_t cnt;                                         /*!< Number of fragments of the message */
+        size_t rcvd;                                        /*!< Number of received fragments */
+        size_t frag_len;                                    /*!< Fragment length, used by the sender */
+        uint32_t time;                                      /*!< Time of last received fragment */
+        uint32_t lost;   /*!< Number of messages, aborted before all fragments have been received */
+        uint8_t id;      /*!< ID of message in progress or last complete message */
+        uint8_t active;  /*!< Set to `1` when message is in progress */
+        uint8_t done;    /*!< Set to `1` when message with ID is complete */
+    } rx;                /*!< Receive state */
+} lwpkt_frag_t;
+
+lwpktr_t lwpkt_frag_init(lwpkt_frag_t* frag, lwpkt_t* pkt, size_t frag_len, void* rx_buff, size_t rx_size);
+lwpktr_t lwpkt_frag_set_timeout(lwpkt_frag_t* frag, uint32_t timeout);
+lwpktr_t lwpkt_frag_write(lwpkt_frag_t* frag,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+                          lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+                          uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+                          uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+                          const void* data, size_t len);
+lwpktr_t lwpkt_frag_resend(lwpkt_frag_t* frag, size_t idx);
+lwpktr_t lwpkt_frag_input(lwpkt_frag_t* frag, uint32_t time);
+lwpktr_t lwpkt_frag_process(lwpkt_frag_t* frag, uint32_t time);
+
+/**
+ * \brief           Get reassembled message data
+ * \param[in]       frag: Fragmentation instance
+ * \return          Pointer to message data
+ */
+#define lwpkt_frag_get_data(frag) (void*)(((frag) != NULL) ? ((frag)->rx.buff) : NULL)
+
+/**
+ * \brief           Get length of reassembled message
+ * \param[in]       frag: Fragmentation instance
+ * \return          Number of message bytes
+ */
+#define lwpkt_frag_get_len(frag)  (size_t)(((frag) != NULL) ? ((frag)->rx.len) : 0)
+
+/**
+ * \brief           Get number of received messages, aborted before all fragments have been received
+ * \param[in]       frag: Fragmentation instance
+ * \return          Number of aborted messages
+ */
+#define lwpkt_frag_get_lost(frag) (uint32_t)(((frag) != NULL) ? ((frag)->rx.lost) : 0)
+
+#endif /* LWPKT_CFG_USE_FRAG || __DOXYGEN__ */
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LWPKT_FRAG_HDR_H */
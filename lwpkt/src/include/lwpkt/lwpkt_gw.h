@@ -0,0 +1,110 @@
+/**
+ * \file            lwpkt_gw.h
+ * \brief           Linux gateway for many packet streams
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#ifndef LWPKT_GW_HDR_H
+#define LWPKT_GW_HDR_H
+
+#include <stdint.h>
+#include "lwpkt/lwpkt.h"
+#include "lwrb/lwrb.h"
+
+#if LWPKT_CFG_USE_GW || __DOXYGEN__
+#include <pthread.h>
+#endif /* LWPKT_CFG_USE_GW || __DOXYGEN__ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \defgroup        LWPKT_GW Linux gateway
+ * \brief           Read and process many packet streams with pool of worker threads
+ * \{
+ */
+
+#if LWPKT_CFG_USE_GW || __DOXYGEN__
+
+struct lwpkt_gw;
+
+/**
+ * \brief           Gateway stream structure
+ */
+typedef struct {
+    lwpkt_t* pkt;    /*!< Packet instance, RX buffer is written by the gateway */
+    int fd;          /*!< File descriptor, stream is read from */
+    uint8_t worker;  /*!< Index of worker, which reads and processes the stream */
+    uint8_t pending; /*!< Set to `1` when file descriptor may have data, not read yet */
+    uint8_t open;    /*!< Set to `1` until end of file or read error */
+} lwpkt_gw_stream_t;
+
+/**
+ * \brief           Gateway worker structure
+ */
+typedef struct {
+    struct lwpkt_gw* gw; /*!< Gateway worker belongs to */
+    pthread_t thread;    /*!< Worker thread */
+    int epfd;            /*!< Event poll file descriptor, with streams of the worker */
+    int cpu;             /*!< CPU, worker thread is bound to. Set to `-1` for no affinity */
+} lwpkt_gw_worker_t;
+
+/**
+ * \brief           Gateway structure
+ */
+typedef struct lwpkt_gw {
+    lwpkt_gw_stream_t stream[LWPKT_CFG_GW_STREAMS]; /*!< List of streams */
+    lwpkt_gw_worker_t worker[LWPKT_CFG_GW_WORKERS]; /*!< List of workers */
+    size_t stream_cnt;                              /*!< Number of added streams */
+    size_t worker_cnt;                              /*!< Number of used workers */
+    lwrb_ulong_t open;                              /*!< Number of open streams */
+    int stop_fd;                                    /*!< Event file descriptor, to stop worker threads */
+    uint8_t running;                                /*!< Set to `1` when worker threads are running */
+} lwpkt_gw_t;
+
+lwpktr_t lwpkt_gw_init(lwpkt_gw_t* gw, size_t workers);
+lwpktr_t lwpkt_gw_set_affinity(lwpkt_gw_t* gw, size_t worker, int cpu);
+lwpktr_t lwpkt_gw_add(lwpkt_gw_t* gw, lwpkt_t* pkt, int fd);
+lwpktr_t lwpkt_gw_start(lwpkt_gw_t* gw);
+lwpktr_t lwpkt_gw_stop(lwpkt_gw_t* gw);
+size_t lwpkt_gw_get_open(lwpkt_gw_t* gw);
+
+#endif /* LWPKT_CFG_USE_GW || __DOXYGEN__ */
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LWPKT_GW_HDR_H */
@@ -187,6 +187,73 @@ extern "C" {
 #define LWPKT_CFG_CRC32 0
 #endif
 
+/**
+ * \brief           CRC calculation engine used by the library
+ * \note            \ref LWPKT_CFG_USE_CRC must be enabled for this feature to work
+ *
+ * Configuration options:
+ *  - `0`: Bit-wise calculation without lookup tables. Smallest footprint, `8` iterations per byte
+ *  - `1`: `256`-entry lookup tables, stored as constant data (ROM). One lookup per byte
+ *  - `2`: `256`-entry lookup tables, generated in RAM on first call to \ref lwpkt_init.
+ *      Required when \ref LWPKT_CFG_CRC32_SLICE_BY is used.
+ *      \ref lwpkt_init never waits for tables, generated by other thread or interrupt,
+ *      such instance uses bit-wise calculation until tables are ready
+ */
+#ifndef LWPKT_CFG_CRC_TABLE
+#define LWPKT_CFG_CRC_TABLE 0
+#endif
+
+/**
+ * \brief           Number of bytes processed in single step for `CRC-32` calculation (slice-by-N method)
+ * \note            Value greater than `1` requires \ref LWPKT_CFG_CRC_TABLE set to `2`
+ *
+ * Configuration options:
+ *  - `1`: Single table, one byte per step
+ *  - `4`: `4` tables (`4kB` of RAM), four bytes per step
+ *  - `8`: `8` tables (`8kB` of RAM), eight bytes per step
+ */
+#ifndef LWPKT_CFG_CRC32_SLICE_BY
+#define LWPKT_CFG_CRC32_SLICE_BY 1
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` hardware CRC calculation hook
+ * \note            \ref LWPKT_CFG_USE_CRC must be enabled for this feature to work
+ *
+ * When enabled, application must implement \ref lwpkt_crc_hw_in function,
+ * which is called for every block of data, before software engine is used.
+ * It can be used to offload calculation to CRC peripheral or CPU CRC instructions.
+ */
+#ifndef LWPKT_CFG_CRC_HW
+#define LWPKT_CFG_CRC_HW 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` custom CRC descriptors
+ * \note            \ref LWPKT_CFG_USE_CRC must be enabled for this feature to work
+ *
+ * When enabled, CRC algorithm (width, polynomial, initial value, output XOR and reflection)
+ * can be selected per instance with \ref lwpkt_set_crc_desc function.
+ * Built-in descriptors for `CRC-16/CCITT` (\ref lwpkt_crc_desc_crc16_ccitt)
+ * and `CRC-32C` (\ref lwpkt_crc_desc_crc32c) are available.
+ *
+ * With \ref LWPKT_CFG_CRC_TABLE set to `2`, lookup tables of built-in descriptors use additional `2kB` of RAM.
+ */
+#ifndef LWPKT_CFG_CRC_DESC
+#define LWPKT_CFG_CRC_DESC 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` CPU instructions for built-in `CRC-32C` descriptor
+ * \note            \ref LWPKT_CFG_CRC_DESC must be enabled for this feature to work
+ *
+ * Calculation uses `SSE4.2` instructions on `x86` or `CRC32` extension on `ARMv8`,
+ * which must be enabled in the compiler, for example with `-msse4.2` or `-march=armv8-a+crc`.
+ */
+#ifndef LWPKT_CFG_CRC32C_HW
+#define LWPKT_CFG_CRC32C_HW 0
+#endif
+
 /**
  * \brief           Enables `1` or disables `0` flags field in the protocol.
  * 
@@ -205,11 +272,205 @@ extern "C" {
 #define LWPKT_CFG_USE_FLAGS 0
 #endif
 
+/**
+ * \brief           Enables COBS framing of the packets
+ *
+ * When enabled, fields from address until CRC are encoded with
+ * Consistent Overhead Byte Stuffing (COBS) and each packet is terminated with `0x00` delimiter.
+ * Start and stop bytes are not used. Delimiter never appears in the packet,
+ * which allows to find packet boundaries with single scan of received data.
+ *
+ * Encoding adds `1` byte per `254` bytes of packet, plus delimiter.
+ *
+ * \note            \ref LWPKT_CFG_RX_ZERO_COPY cannot be used with this feature
+ *
+ * Configuration options:
+ *  - `0`: Feature is globally disabled in the library
+ *  - `1`: Feature is globally enabled in the library
+ *  - `2`: Feature is dynamically enabled/disabled in the library, according to the LwPKT object instance.
+ *      If set to `2`, feature is by default disabled, as it changes packet format,
+ *      but it can be enabled with appropriate API function.
+ */
+#ifndef LWPKT_CFG_USE_COBS
+#define LWPKT_CFG_USE_COBS 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` zero-copy receive mode
+ *
+ * When enabled, data part of the packet is not copied to the packet instance.
+ * It is left in the RX buffer and application accesses it with \ref lwpkt_get_view function,
+ * as one or two segments, when data wrap around the end of the buffer.
+ * Buffer memory is released with \ref lwpkt_release_view function,
+ * or automatically when \ref lwpkt_read is called next time.
+ *
+ * \note            Data array is not part of the packet instance, which reduces memory footprint.
+ *                  Full packet, starting at data part, must fit into the RX buffer.
+ */
+#ifndef LWPKT_CFG_RX_ZERO_COPY
+#define LWPKT_CFG_RX_ZERO_COPY 0
+#endif
+
+/**
+ * \brief           Number of slots in receive packet queue. Set to `0` to disable the queue
+ *
+ * When enabled, each received packet is written directly to the free slot of the queue,
+ * together with its header fields. Application takes packets from the queue with \ref lwpkt_rxq_get
+ * and returns slots with \ref lwpkt_rxq_release, while parser continues with next packets.
+ *
+ * When all slots are used, new packets are dropped, \ref lwpkt_read returns \ref lwpktERRMEM
+ * and \ref lwpkt_rxq_get_overflow counter is incremented.
+ *
+ * \note            Data array is not part of the packet instance, each slot has its own.
+ *                  \ref LWPKT_CFG_RX_ZERO_COPY cannot be used with this feature
+ */
+#ifndef LWPKT_CFG_RX_QUEUE
+#define LWPKT_CFG_RX_QUEUE 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` receive data memory, provided by the application
+ *
+ * When enabled, data array of \ref LWPKT_CFG_MAX_DATA_LEN bytes is not part of the packet instance.
+ * Application provides memory and its size to \ref lwpkt_init_ex function,
+ * and maximum length of data part is set per instance.
+ *
+ * \note            \ref LWPKT_CFG_RX_ZERO_COPY and \ref LWPKT_CFG_RX_QUEUE cannot be used with this feature
+ */
+#ifndef LWPKT_CFG_RX_DATA_EXT
+#define LWPKT_CFG_RX_DATA_EXT 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` streaming transmit mode
+ *
+ * When enabled, packet can be written in multiple steps, with \ref lwpkt_write_begin,
+ * \ref lwpkt_write_chunk and \ref lwpkt_write_end functions.
+ * Data part can be larger than TX buffer and is written as buffer memory gets free.
+ */
+#ifndef LWPKT_CFG_USE_TX_STREAM
+#define LWPKT_CFG_USE_TX_STREAM 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` multi-producer transmit mode
+ *
+ * When enabled, write functions can be called for the same packet instance
+ * from multiple threads or interrupts at the same time, without mutex in \ref LWPKT_EVT_PRE_WRITE
+ * and \ref LWPKT_EVT_POST_WRITE events.
+ * Each writer atomically claims memory for full packet in TX buffer, and publishes it when packet is written.
+ * Buffer write pointer only moves over fully written packets, in the order memory was claimed.
+ *
+ * \note            TX buffer must be read by single consumer only.
+ *                  It must not be written by any other function than packet write functions
+ * \note            While streaming transmit packet is in progress, other writes return \ref lwpktERR
+ * \note            Up to `63` writers can hold claimed memory at the same time, other writes return \ref lwpktERRMEM.
+ *                  Batch of \ref LWPKT_CFG_USE_TX_BATCH counts as one writer
+ * \note            Atomic operations must be enabled in LwRB, with TX buffer size up to `16MB`
+ */
+#ifndef LWPKT_CFG_TX_MPSC
+#define LWPKT_CFG_TX_MPSC 0
+#endif
+
+/**
+ * \brief           Number of entries in transmit frame queue. Set to `0` to disable the queue
+ *
+ * When enabled, location of each packet, written to TX buffer, is stored in the queue.
+ * Application, for example DMA driver, takes frames with \ref lwpkt_txq_get,
+ * transmits them and releases their memory in TX buffer with \ref lwpkt_txq_release.
+ *
+ * When all entries are used, write functions return \ref lwpktERRMEM.
+ *
+ * \note            TX buffer must be read only with frame queue functions.
+ *                  \ref LWPKT_CFG_USE_TX_STREAM and \ref LWPKT_CFG_TX_MPSC cannot be used with this feature
+ */
+#ifndef LWPKT_CFG_TX_FRAMES
+#define LWPKT_CFG_TX_FRAMES 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` contiguous placement of transmit frames
+ * \note            \ref LWPKT_CFG_TX_FRAMES must be enabled for this feature to work
+ *
+ * When enabled, packet that does not fit to the end of TX buffer memory is written
+ * to the beginning of the memory instead. Unused memory at the end is filled with `0x00` padding bytes,
+ * that are released together with the frame. Every frame is then transmitted with single transfer.
+ */
+#ifndef LWPKT_CFG_TX_FRAMES_NOWRAP
+#define LWPKT_CFG_TX_FRAMES_NOWRAP 0
+#endif
+
+/**
+ * \brief           Number of priority lanes of transmit scheduler. Set to `0` to disable the scheduler
+ * \note            \ref LWPKT_CFG_TX_FRAMES must be enabled for this feature to work
+ *
+ * Each lane is packet instance with its own TX buffer and frame queue.
+ * Scheduler hands over whole frames to the application, always from the highest priority lane with frames,
+ * with \ref lwpkt_tx_sched_get and \ref lwpkt_tx_sched_release functions.
+ * Frame of high priority lane waits at most for one frame of lower priority lane, that is already in transmission.
+ */
+#ifndef LWPKT_CFG_TX_LANES
+#define LWPKT_CFG_TX_LANES 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` batch transmit mode
+ *
+ * When enabled, multiple packets can be written with \ref lwpkt_batch_begin, \ref lwpkt_batch_write
+ * and \ref lwpkt_batch_commit functions. Packets are written back to back and committed to TX buffer at once,
+ * with single pair of write events.
+ */
+#ifndef LWPKT_CFG_USE_TX_BATCH
+#define LWPKT_CFG_USE_TX_BATCH 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` streaming receive mode
+ *
+ * When enabled, packets with data part that cannot be stored in the packet instance
+ * (or in the RX buffer, in zero-copy mode) are not rejected.
+ * Data are delivered to the application in fragments, as they arrive,
+ * with \ref LWPKT_EVT_STREAM_START, \ref LWPKT_EVT_STREAM_DATA and \ref LWPKT_EVT_STREAM_END events.
+ *
+ * \note            \ref LWPKT_CFG_USE_EVT must be enabled for this feature to work
+ */
+#ifndef LWPKT_CFG_USE_RX_STREAM
+#define LWPKT_CFG_USE_RX_STREAM 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` fast resynchronization after packet error
+ *
+ * When enabled, bytes of the packet being received stay in the RX buffer until packet is finished.
+ * If packet is invalid (wrong CRC, missing stop byte or too long data part),
+ * only its start byte is removed and the rest of the data is scanned again for the next start byte.
+ * This allows to receive valid packet, that started inside the corrupted one.
+ *
+ * \note            When RX buffer gets full, bytes are released and current packet is processed without resynchronization
+ */
+#ifndef LWPKT_CFG_RX_RESYNC
+#define LWPKT_CFG_RX_RESYNC 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` receive filter
+ *
+ * When enabled, header of received packet is checked with filter, set by \ref lwpkt_set_filter.
+ * Data part and CRC of packets, that are not accepted, are skipped without processing,
+ * and such packets are not reported to the application.
+ */
+#ifndef LWPKT_CFG_RX_FILTER
+#define LWPKT_CFG_RX_FILTER 0
+#endif
+
 /**
  * \brief           Defines timeout time before packet is considered as not valid
  *                  when too long time in data-read mode
  *
- * Used with \ref lwpkt_process function
+ * Used with \ref lwpkt_process function. Timeout starts again with every received byte.
+ * Value is in units of time argument of \ref lwpkt_process, which is milliseconds by default.
+ * It is initial value of every instance, application changes it with \ref lwpkt_set_timeout,
+ * for example to use microsecond timer ticks.
  */
 #ifndef LWPKT_CFG_PROCESS_INPROG_TIMEOUT
 #define LWPKT_CFG_PROCESS_INPROG_TIMEOUT 100
@@ -223,6 +484,158 @@ extern "C" {
 #define LWPKT_CFG_USE_EVT 1
 #endif
 
+/**
+ * \brief           Enables `1` or disables `0` statistics counters of packet instance
+ *
+ * When enabled, every instance counts packets, bytes, errors by type,
+ * discarded bytes and ring buffers high-water marks.
+ * Counters are read with \ref lwpkt_get_stats function.
+ */
+#ifndef LWPKT_CFG_USE_STATS
+#define LWPKT_CFG_USE_STATS 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` execution time measurement of read and write operations
+ * \note            \ref LWPKT_CFG_USE_STATS must be enabled for this feature to work
+ *
+ * When enabled, application must implement \ref lwpkt_stats_get_cycles function,
+ * which returns current value of free-running cycle counter, such as `DWT->CYCCNT` on Cortex-M.
+ */
+#ifndef LWPKT_CFG_STATS_CYCLES
+#define LWPKT_CFG_STATS_CYCLES 0
+#endif
+
+/**
+ * \brief           Number of records in packet latency trace. Set to `0` to disable the trace
+ *
+ * When enabled, every received packet gets trace record with time of start byte detection,
+ * complete header, complete data part, packet result and event dispatch.
+ * Application must implement \ref lwpkt_trace_get_time function, which returns current time,
+ * such as free-running cycle counter or microsecond timer.
+ *
+ * Finished records are read with \ref lwpkt_trace_read function.
+ * When all records are used, new records are dropped and \ref lwpkt_trace_get_lost counter is incremented.
+ */
+#ifndef LWPKT_CFG_TRACE
+#define LWPKT_CFG_TRACE 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` multi-channel packet engine
+ *
+ * Engine services many packet instances at once.
+ * Only instances, that received new data since last call, are processed,
+ * and timeouts of all instances are tracked in single timer wheel.
+ *
+ * \note            \ref LWPKT_CFG_USE_EVT must be enabled for this feature to work
+ */
+#ifndef LWPKT_CFG_USE_ENGINE
+#define LWPKT_CFG_USE_ENGINE 0
+#endif
+
+/**
+ * \brief           Maximum number of packet instances in one engine
+ *
+ * \note            Value must be between `1` and `32`
+ */
+#ifndef LWPKT_CFG_ENGINE_CHANNELS
+#define LWPKT_CFG_ENGINE_CHANNELS 8
+#endif
+
+/**
+ * \brief           Number of slots in the engine timer wheel
+ *
+ * Together with \ref LWPKT_CFG_ENGINE_WHEEL_TICK it defines the time range covered by one wheel turn.
+ * Timeouts longer than one turn are still handled, but their channels are checked on every turn.
+ */
+#ifndef LWPKT_CFG_ENGINE_WHEEL_SLOTS
+#define LWPKT_CFG_ENGINE_WHEEL_SLOTS 16
+#endif
+
+/**
+ * \brief           Time of one engine timer wheel slot
+ *
+ * Value is in units of time argument of \ref lwpkt_process, which is milliseconds by default.
+ * It must be scaled together with timeout of instances, set with \ref lwpkt_set_timeout.
+ * Timeout is detected with resolution of one slot
+ */
+#ifndef LWPKT_CFG_ENGINE_WHEEL_TICK
+#define LWPKT_CFG_ENGINE_WHEEL_TICK 10
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` fragmentation layer
+ *
+ * Fragmentation layer splits messages, larger than packet data part,
+ * to multiple packets, and reassembles them on the receiver side.
+ * Each fragment starts with header of \ref LWPKT_FRAG_HDR_LEN bytes,
+ * hence no packet feature has to be enabled for this layer.
+ *
+ * Functions are part of `lwpkt_frag.h` module
+ */
+#ifndef LWPKT_CFG_USE_FRAG
+#define LWPKT_CFG_USE_FRAG 0
+#endif
+
+/**
+ * \brief           Maximum number of fragments of one received message
+ *
+ * It defines size of bitmap of received fragments in each fragmentation instance
+ *
+ * \note            Value must be between `1` and `65535`
+ */
+#ifndef LWPKT_CFG_FRAG_MAX_CNT
+#define LWPKT_CFG_FRAG_MAX_CNT 64
+#endif
+
+/**
+ * \brief           Default time to wait for next fragment of received message, before message is aborted
+ *
+ * Value is in units of time argument of \ref lwpkt_frag_process function.
+ * It can be changed for each instance with \ref lwpkt_frag_set_timeout function
+ */
+#ifndef LWPKT_CFG_FRAG_TIMEOUT
+#define LWPKT_CFG_FRAG_TIMEOUT 1000
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` Linux gateway
+ *
+ * Gateway terminates many serial or network streams, each with its own packet instance.
+ * Worker threads read file descriptors with `epoll` directly to RX buffers,
+ * and process packet instances in parallel, each stream always by the same worker.
+ *
+ * Functions are part of `lwpkt_gw.h` module and `lwpkt_gw` CMake target, available only on Linux
+ */
+#ifndef LWPKT_CFG_USE_GW
+#define LWPKT_CFG_USE_GW 0
+#endif
+
+/**
+ * \brief           Maximum number of worker threads in one gateway instance
+ */
+#ifndef LWPKT_CFG_GW_WORKERS
+#define LWPKT_CFG_GW_WORKERS 8
+#endif
+
+/**
+ * \brief           Maximum number of streams in one gateway instance
+ */
+#ifndef LWPKT_CFG_GW_STREAMS
+#define LWPKT_CFG_GW_STREAMS 64
+#endif
+
+/**
+ * \brief           Period in units of milliseconds, in which worker processes all its streams
+ *
+ * It checks timeout of packets in progress and continues with streams,
+ * which have been waiting for free slot in receive packet queue
+ */
+#ifndef LWPKT_CFG_GW_TICK
+#define LWPKT_CFG_GW_TICK 10
+#endif
+
 /**
  * \}
  */
@@ -0,0 +1,146 @@
+/**
+ * \file            lwpkt_varint.h
+ * \brief           Variable length integer encoding
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#ifndef LWPKT_VARINT_HDR_H
+#define LWPKT_VARINT_HDR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \defgroup        LWPKT_VARINT Variable length integer
+ * \brief           Encoding of length, flags, extended address and command fields
+ * \{
+ *
+ * Number is split to `7-bit` groups, least significant group first.
+ * MSB of the byte is set when more bytes follow. `32-bit` number takes up to `5` bytes.
+ */
+
+/**
+ * \brief           Maximum length of encoded `32-bit` number in units of bytes
+ */
+#define LWPKT_VARINT_MAX_LEN 5U
+
+/**
+ * \brief           Get length of encoded number
+ * \param[in]       num: Number to encode
+ * \return          Number of bytes, from `1` to \ref LWPKT_VARINT_MAX_LEN
+ */
+static inline size_t
+lwpkt_varint_len(uint32_t num) {
+#if defined(__GNUC__) || defined(__clang__)
+    /* Number of significant bits, rounded up to 7-bit groups */
+    return (size_t)((32U - (uint32_t)__builtin_clz(num | 1U) + 6U) / 7U);
+#else  /* defined(__GNUC__) || defined(__clang__) */
+    return (size_t)(1U + (num > 0x7FUL) + (num > 0x3FFFUL) + (num > 0x1FFFFFUL) + (num > 0xFFFFFFFUL));
+#endif /* !(defined(__GNUC__) || defined(__clang__)) */
+}
+
+/**
+ * \brief           Encode number to output memory
+ * \param[out]      out: Output memory, at least \ref LWPKT_VARINT_MAX_LEN bytes long
+ * \param[in]       num: Number to encode
+ * \return          Number of bytes written
+ */
+static inline size_t
+lwpkt_varint_encode(uint8_t* out, uint32_t num) {
+    size_t len = lwpkt_varint_len(num), idx;
+
+    for (idx = 0; idx + 1U < len; ++idx) {
+        out[idx] = (uint8_t)(num | 0x80U);
+        num >>= 7U;
+    }
+    out[idx] = (uint8_t)num;
+    return len;
+}
+
+/**
+ * \brief           Decode number from input memory
+ * \param[in]       d: Input bytes, starting with first byte of the number
+ * \param[in]       d_len: Number of available bytes in `d`
+ * \param[out]      num: Output variable to write decoded number to
+ * \return          Number of bytes used, `0` if number is not complete in `d`
+ *                  or is longer than \ref LWPKT_VARINT_MAX_LEN bytes
+ */
+static inline size_t
+lwpkt_varint_decode(const uint8_t* d, size_t d_len, uint32_t* num) {
+    uint32_t val;
+
+    /* Single byte numbers are the most common */
+    if (d_len > 0 && d[0] < 0x80U) {
+        *num = d[0];
+        return 1;
+    }
+    if (d_len > LWPKT_VARINT_MAX_LEN) {
+        d_len = LWPKT_VARINT_MAX_LEN;
+    }
+    val = 0;
+    for (size_t idx = 0; idx < d_len; ++idx) {
+        val |= (uint32_t)(d[idx] & 0x7FU) << (7U * idx);
+        if ((d[idx] & 0x80U) == 0) {
+            *num = val;
+            return idx + 1U;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Add one byte to number, decoded byte by byte
+ * \note            Bytes above \ref LWPKT_VARINT_MAX_LEN are ignored
+ * \param[in]       num: Number, decoded from previous bytes
+ * \param[in]       b: Received byte
+ * \param[in]       idx: Index of the byte in encoded number
+ * \return          Updated number
+ */
+static inline uint32_t
+lwpkt_varint_add(uint32_t num, uint8_t b, size_t idx) {
+    if (idx >= LWPKT_VARINT_MAX_LEN) {
+        return num;
+    }
+    return num | ((uint32_t)(b & 0x7FU) << (7U * idx));
+}
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LWPKT_VARINT_HDR_H */
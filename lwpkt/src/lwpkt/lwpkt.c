@@ -34,7 +34,15 @@
 #include <stdint.h>
 #include <string.h>
 #include "lwpkt/lwpkt.h"
+#include "lwpkt/lwpkt_varint.h"
 #include "lwrb/lwrb.h"
+#if LWPKT_CFG_CRC32C_HW
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif /* defined(__ARM_FEATURE_CRC32) */
+#endif /* LWPKT_CFG_CRC32C_HW */
 
 /* Validate user configuration */
 #if LWPKT_CFG_ADDR_EXTENDED && !LWPKT_CFG_USE_ADDR
@@ -46,8 +54,48 @@
 #if LWPKT_CFG_CRC32 && !LWPKT_CFG_USE_CRC
 #error "LWPKT_CFG_CRC32 must be disabled if LWPKT_CFG_USE_CRC is not enabled"
 #endif
+#if LWPKT_CFG_CRC_DESC && !LWPKT_CFG_USE_CRC
+#error "LWPKT_CFG_CRC_DESC must be disabled if LWPKT_CFG_USE_CRC is not enabled"
+#endif
+#if LWPKT_CFG_CRC32C_HW && !LWPKT_CFG_CRC_DESC
+#error "LWPKT_CFG_CRC32C_HW must be disabled if LWPKT_CFG_CRC_DESC is not enabled"
+#endif
+#if LWPKT_CFG_CRC32C_HW && !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+#error "LWPKT_CFG_CRC32C_HW requires SSE4.2 or ARMv8 CRC32 instructions to be enabled in the compiler"
+#endif
+#if LWPKT_CFG_CRC32_SLICE_BY != 1 && LWPKT_CFG_CRC32_SLICE_BY != 4 && LWPKT_CFG_CRC32_SLICE_BY != 8
+#error "LWPKT_CFG_CRC32_SLICE_BY must be set to 1, 4 or 8"
+#endif
+#if LWPKT_CFG_CRC32_SLICE_BY > 1 && LWPKT_CFG_CRC_TABLE != 2
+#error "LWPKT_CFG_CRC32_SLICE_BY greater than 1 requires LWPKT_CFG_CRC_TABLE set to 2"
+#endif
+#if LWPKT_CFG_USE_COBS && LWPKT_CFG_RX_ZERO_COPY
+#error "LWPKT_CFG_USE_COBS cannot be used together with LWPKT_CFG_RX_ZERO_COPY"
+#endif
+#if LWPKT_CFG_USE_RX_STREAM && !LWPKT_CFG_USE_EVT
+#error "LWPKT_CFG_USE_RX_STREAM must be disabled if LWPKT_CFG_USE_EVT is not enabled"
+#endif
+#if LWPKT_CFG_RX_QUEUE && LWPKT_CFG_RX_ZERO_COPY
+#error "LWPKT_CFG_RX_QUEUE cannot be used together with LWPKT_CFG_RX_ZERO_COPY"
+#endif
+#if LWPKT_CFG_RX_DATA_EXT && (LWPKT_CFG_RX_QUEUE || LWPKT_CFG_RX_ZERO_COPY)
+#error "LWPKT_CFG_RX_DATA_EXT cannot be used together with LWPKT_CFG_RX_QUEUE or LWPKT_CFG_RX_ZERO_COPY"
+#endif
+#if LWPKT_CFG_TX_MPSC && defined(LWRB_DISABLE_ATOMIC)
+#error "LWPKT_CFG_TX_MPSC requires atomic operations in LwRB, LWRB_DISABLE_ATOMIC must not be defined"
+#endif
+#if LWPKT_CFG_TX_FRAMES && (LWPKT_CFG_USE_TX_STREAM || LWPKT_CFG_TX_MPSC)
+#error "LWPKT_CFG_TX_FRAMES cannot be used together with LWPKT_CFG_USE_TX_STREAM or LWPKT_CFG_TX_MPSC"
+#endif
+#if LWPKT_CFG_TX_LANES && !LWPKT_CFG_TX_FRAMES
+#error "LWPKT_CFG_TX_LANES requires LWPKT_CFG_TX_FRAMES to be enabled"
+#endif
+#if LWPKT_CFG_RX_FILTER && !LWPKT_CFG_USE_ADDR && !LWPKT_CFG_USE_CMD
+#error "LWPKT_CFG_RX_FILTER requires LWPKT_CFG_USE_ADDR or LWPKT_CFG_USE_CMD to be enabled"
+#endif
 
 #define LWPKT_IS_VALID(p) ((p) != NULL)
+#define LWPKT_MIN(x, y)   ((x) < (y) ? (x) : (y))
 #define LWPKT_SET_STATE(p, s)                                                                                          \
     do {                                                                                                               \
         (p)->m.state = (s);                                                                                            \
@@ -68,28 +116,18 @@
 #define CRC_POLY_8       0x8CUL
 
 #if LWPKT_CFG_USE_CRC
-#define WRITE_WITH_CRC(pkt, crc, tx_rb, b, len)                                                                        \
-    do {                                                                                                               \
-        lwrb_write((tx_rb), (b), (len));                                                                               \
-        if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CRC, LWPKT_FLAG_USE_CRC)) {                           \
-            prv_crc_in((pkt), (crc), (b), (len));                                                                      \
-        }                                                                                                              \
-    } while (0)
 #define ADD_IN_TO_CRC(pkt, crc, val, len)                                                                              \
     do {                                                                                                               \
-        if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CRC, LWPKT_FLAG_USE_CRC)) {                           \
+        if (CRC_LEN_USED(pkt) > 0) {                                                                                   \
             prv_crc_in((pkt), (crc), (val), (len));                                                                    \
         }                                                                                                              \
     } while (0)
 #define INIT_CRC(pkt, crc) prv_crc_init((pkt), (crc))
-#define CRC_DATA_LEN(pkt)  (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CRC32, LWPKT_FLAG_CRC32) ? 4 : 1)
+#define CRC_LEN_USED(pkt)  ((size_t)LAYOUT(pkt)->crc_len)
 #else /* LWPKT_CFG_USE_CRC */
-#define WRITE_WITH_CRC(pkt, crc, tx_rb, b, len)                                                                        \
-    do {                                                                                                               \
-        lwrb_write((tx_rb), (b), (len));                                                                               \
-    } while (0)
 #define ADD_IN_TO_CRC(pkt, crc, val, len)
 #define INIT_CRC(pkt, crc)
+#define CRC_LEN_USED(pkt) 0
 #endif /* !LWPKT_CFG_USE_CRC */
 
 #if LWPKT_CFG_USE_EVT
@@ -101,6 +139,120 @@
 #define SEND_EVT(p, t)
 #endif /* !LWPKT_CFG_USE_EVT */
 
+/* Check if data part of received packet can be stored */
+#if LWPKT_CFG_RX_ZERO_COPY
+#define RX_DATA_FITS(p) (((p)->m.len + CRC_LEN_USED(p) + 1U) < (p)->rx_rb->size)
+#elif LWPKT_CFG_RX_DATA_EXT
+#define RX_DATA_FITS(p) ((p)->m.len <= (p)->data_size)
+#else /* LWPKT_CFG_RX_ZERO_COPY */
+#define RX_DATA_FITS(p) ((p)->m.len <= LWPKT_CFG_MAX_DATA_LEN)
+#endif /* !LWPKT_CFG_RX_ZERO_COPY */
+
+#if LWPKT_CFG_RX_QUEUE || LWPKT_CFG_TX_FRAMES || LWPKT_CFG_TRACE
+/* Queue counters are shared between the library and the application */
+#ifdef LWRB_DISABLE_ATOMIC
+#define QUEUE_LOAD(var, type)       (var)
+#define QUEUE_STORE(var, val, type) (var) = (val)
+#else
+#define QUEUE_LOAD(var, type)       atomic_load_explicit(&(var), (type))
+#define QUEUE_STORE(var, val, type) atomic_store_explicit(&(var), (val), (type))
+#endif /* LWRB_DISABLE_ATOMIC */
+#endif /* LWPKT_CFG_RX_QUEUE || LWPKT_CFG_TX_FRAMES || LWPKT_CFG_TRACE */
+
+#if LWPKT_CFG_TX_FRAMES
+#define TXQ_CNT_MOD (2U * LWPKT_CFG_TX_FRAMES)
+#endif /* LWPKT_CFG_TX_FRAMES */
+
+/* Memory and frames of current batch, written but not committed yet */
+#if LWPKT_CFG_USE_TX_BATCH && !LWPKT_CFG_TX_MPSC
+#define TX_BATCH_LEN(p) ((p)->tx_batch.len)
+#define TX_BATCH_CNT(p) ((p)->tx_batch.cnt)
+#else /* LWPKT_CFG_USE_TX_BATCH && !LWPKT_CFG_TX_MPSC */
+#define TX_BATCH_LEN(p) ((size_t)0)
+#define TX_BATCH_CNT(p) ((size_t)0)
+#endif /* !(LWPKT_CFG_USE_TX_BATCH && !LWPKT_CFG_TX_MPSC) */
+
+/* In multi-producer mode, batch holds claim of TX buffer memory from its first packet */
+#if LWPKT_CFG_USE_TX_BATCH && LWPKT_CFG_TX_MPSC
+#define TX_BATCH_HOLD(p, batch) (uint8_t)((batch) && (p)->tx_batch.cnt > 0)
+#else /* LWPKT_CFG_USE_TX_BATCH && LWPKT_CFG_TX_MPSC */
+#define TX_BATCH_HOLD(p, batch) (uint8_t)0
+#endif /* !(LWPKT_CFG_USE_TX_BATCH && LWPKT_CFG_TX_MPSC) */
+
+#if LWPKT_CFG_RX_QUEUE
+#define RXQ_CNT_MOD    (2U * LWPKT_CFG_RX_QUEUE)
+#define RX_DATA_BUF(p) ((p)->rxq.slot[QUEUE_LOAD((p)->rxq.w, memory_order_relaxed) % LWPKT_CFG_RX_QUEUE].data)
+#else /* LWPKT_CFG_RX_QUEUE */
+#define RX_DATA_BUF(p) ((p)->data)
+#endif /* !LWPKT_CFG_RX_QUEUE */
+
+#if LWPKT_CFG_USE_RX_STREAM
+#define RX_STREAM_END(p, r)                                                                                            \
+    do {                                                                                                               \
+        if ((p)->m.stream.active) {                                                                                    \
+            (p)->m.stream.res = (r);                                                                                   \
+            SEND_EVT((p), LWPKT_EVT_STREAM_END);                                                                       \
+        }                                                                                                              \
+    } while (0)
+#else /* LWPKT_CFG_USE_RX_STREAM */
+#define RX_STREAM_END(p, r)
+#endif /* !LWPKT_CFG_USE_RX_STREAM */
+
+#if LWPKT_CFG_USE_STATS
+#define STATS_ADD(p, f, v) (p)->stats.f += (v)
+#define STATS_MAX(p, f, v)                                                                                             \
+    do {                                                                                                               \
+        size_t val_ = (v);                                                                                             \
+        if (val_ > (p)->stats.f) {                                                                                     \
+            (p)->stats.f = val_;                                                                                       \
+        }                                                                                                              \
+    } while (0)
+#else /* LWPKT_CFG_USE_STATS */
+#define STATS_ADD(p, f, v)
+#define STATS_MAX(p, f, v)
+#endif /* !LWPKT_CFG_USE_STATS */
+
+#if LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES
+/* Measure execution time between begin and end, "c" is local variable name */
+#define STATS_CYCLES_BEGIN(c) uint32_t c = lwpkt_stats_get_cycles()
+#define STATS_CYCLES_END(p, c, n)                                                                                      \
+    do {                                                                                                               \
+        c = lwpkt_stats_get_cycles() - c;                                                                              \
+        ++(p)->stats.n##_calls;                                                                                        \
+        (p)->stats.n##_cycles += c;                                                                                    \
+        if (c > (p)->stats.n##_cycles_max) {                                                                           \
+            (p)->stats.n##_cycles_max = c;                                                                             \
+        }                                                                                                              \
+    } while (0)
+#else /* LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES */
+#define STATS_CYCLES_BEGIN(c)
+#define STATS_CYCLES_END(p, c, n)
+#endif /* !(LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES) */
+
+#if LWPKT_CFG_TRACE
+#define TRACE_CNT_MOD (2U * LWPKT_CFG_TRACE)
+/* Record time of stage "s" to field "f" of current trace record */
+#define TRACE_STAGE(p, f, s)                                                                                           \
+    do {                                                                                                               \
+        (p)->trace.cur.f = lwpkt_trace_get_time();                                                                     \
+        (p)->trace.cur.stages |= (s);                                                                                  \
+    } while (0)
+#define TRACE_BEGIN(p)                                                                                                 \
+    do {                                                                                                               \
+        LWPKT_MEMSET(&(p)->trace.cur, 0x00, sizeof((p)->trace.cur));                                                   \
+        TRACE_STAGE((p), start, LWPKT_TRACE_STAGE_START);                                                              \
+    } while (0)
+#define TRACE_END(p, r)   prv_trace_end((p), (r))
+#define TRACE_DEFER(p)    (p)->trace.defer = 1
+#define TRACE_COMMIT(p)   prv_trace_commit(p)
+#else /* LWPKT_CFG_TRACE */
+#define TRACE_STAGE(p, f, s)
+#define TRACE_BEGIN(p)
+#define TRACE_END(p, r)
+#define TRACE_DEFER(p)
+#define TRACE_COMMIT(p)
+#endif /* !LWPKT_CFG_TRACE */
+
 /* Flags for dynamically settable features in the library */
 #define LWPKT_FLAG_USE_CRC       ((uint8_t)0x01)
 #define LWPKT_FLAG_CRC32         ((uint8_t)0x02)
@@ -109,6 +261,7 @@
 #define LWPKT_FLAG_USE_CMD       ((uint8_t)0x10)
 #define LWPKT_FLAG_CMD_EXTENDED  ((uint8_t)0x20)
 #define LWPKT_FLAG_USE_FLAGS     ((uint8_t)0x40)
+#define LWPKT_FLAG_USE_COBS      ((uint8_t)0x80)
 
 /* Checks if feature is enabled for specific pkt instance */
 #define CHECK_FEATURE_CONFIG_MODE_ENABLED(_pkt_, _feature_, _flag_)                                                    \
@@ -117,18 +270,204 @@
      || ((_feature_) == 2 && ((_pkt_)->flags & (_flag_))) /* 2 == feature is dynamically enabled */                    \
     )
 
-/* Calculates number of bytes required to encode length. Result is increased for num_var (+= operand)*/
-#define CALC_BYTES_NUM_FOR_LEN(num_var, len_var)                                                                       \
-    do {                                                                                                               \
-        uint32_t len_local = (len_var);                                                                                \
-        do {                                                                                                           \
-            ++(num_var);                                                                                               \
-            len_local >>= (uint8_t)7U;                                                                                 \
-        } while (len_local > 0U);                                                                                      \
-    } while (0)
+/* Bit of the state in the layout variable length mask */
+#define LAYOUT_VAR(s) ((uint8_t)(1U << (s)))
+
+/* Prepare packet layout for set of enabled features */
+#define LAYOUT_INIT(addr, addr_ext, flags, cmd, cmd_ext, crc, crc32)                                                   \
+    {                                                                                                                  \
+        {                                                                                                              \
+            /* LWPKT_STATE_START */ (addr)    ? LWPKT_STATE_FROM                                                       \
+            : (flags)                         ? LWPKT_STATE_FLAGS                                                      \
+            : (cmd)                           ? LWPKT_STATE_CMD                                                        \
+                                              : LWPKT_STATE_LEN,                                                       \
+            /* LWPKT_STATE_FROM */ LWPKT_STATE_TO,                                                                     \
+            /* LWPKT_STATE_TO */ (flags) ? LWPKT_STATE_FLAGS : (cmd) ? LWPKT_STATE_CMD : LWPKT_STATE_LEN,              \
+            /* LWPKT_STATE_CMD */ LWPKT_STATE_LEN,                                                                     \
+            /* LWPKT_STATE_FLAGS */ (cmd) ? LWPKT_STATE_CMD : LWPKT_STATE_LEN,                                         \
+            /* LWPKT_STATE_LEN */ LWPKT_STATE_DATA,                                                                    \
+            /* LWPKT_STATE_DATA */ (crc) ? LWPKT_STATE_CRC : LWPKT_STATE_STOP,                                         \
+            /* LWPKT_STATE_CRC */ LWPKT_STATE_STOP,                                                                    \
+            /* LWPKT_STATE_STOP */ LWPKT_STATE_START,                                                                  \
+        },                                                                                                             \
+        (uint8_t)(((addr_ext) ? (LAYOUT_VAR(LWPKT_STATE_FROM) | LAYOUT_VAR(LWPKT_STATE_TO)) : 0U)                      \
+                  | ((cmd_ext) ? LAYOUT_VAR(LWPKT_STATE_CMD) : 0U) | LAYOUT_VAR(LWPKT_STATE_FLAGS)                     \
+                  | LAYOUT_VAR(LWPKT_STATE_LEN)),                                                                      \
+        (uint8_t)((crc) ? ((crc32) ? 4U : 1U) : 0U),                                                                   \
+    }
+
+/* Layout is taken from the instance only when it depends on the instance flags */
+#if LWPKT_LAYOUT_DYNAMIC
+#define LAYOUT(p) (&(p)->layout)
+#else /* LWPKT_LAYOUT_DYNAMIC */
+static const lwpkt_layout_t layout_static = LAYOUT_INIT(LWPKT_CFG_USE_ADDR, LWPKT_CFG_ADDR_EXTENDED,
+                                                        LWPKT_CFG_USE_FLAGS, LWPKT_CFG_USE_CMD, LWPKT_CFG_CMD_EXTENDED,
+                                                        LWPKT_CFG_USE_CRC, LWPKT_CFG_CRC32);
+#define LAYOUT(p) (&layout_static)
+#endif /* !LWPKT_LAYOUT_DYNAMIC */
+#define LAYOUT_IS_VAR(p, s) ((LAYOUT(p)->var & LAYOUT_VAR(s)) != 0)
+
+/* Map optional API parameters to internal functions, that always take all parameters */
+#if LWPKT_CFG_USE_ADDR
+#define PRV_ARG_TO(x) (x)
+#else /* LWPKT_CFG_USE_ADDR */
+#define PRV_ARG_TO(x) 0
+#endif /* !LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+#define PRV_ARG_FLAGS(x) (x)
+#else /* LWPKT_CFG_USE_FLAGS */
+#define PRV_ARG_FLAGS(x) 0
+#endif /* !LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+#define PRV_ARG_CMD(x) (x)
+#else /* LWPKT_CFG_USE_CMD */
+#define PRV_ARG_CMD(x) 0
+#endif /* !LWPKT_CFG_USE_CMD */
+
+/* Maximum length of packet header (start, from, to, flags, cmd, len) and trailer (crc, stop) */
+#define LWPKT_HDR_MAX_LEN (1U + 5U * LWPKT_VARINT_MAX_LEN)
+#define LWPKT_TRL_MAX_LEN (4U + 1U)
 
 #if LWPKT_CFG_USE_CRC
 
+#if LWPKT_CFG_CRC_TABLE == 1
+/* Pre-calculated CRC tables for reversed polynomials */
+static const uint8_t crc8_table[256] = {
+    0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+    0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E, 0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+    0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+    0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+    0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5, 0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+    0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+    0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+    0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B, 0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+    0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+    0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+    0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C, 0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+    0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+    0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+    0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4, 0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+    0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+    0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35,
+};
+static const uint32_t crc32_table[256] = {
+    0x00000000UL, 0x77073096UL, 0xEE0E612CUL, 0x990951BAUL, 0x076DC419UL, 0x706AF48FUL, 0xE963A535UL, 0x9E6495A3UL,
+    0x0EDB8832UL, 0x79DCB8A4UL, 0xE0D5E91EUL, 0x97D2D988UL, 0x09B64C2BUL, 0x7EB17CBDUL, 0xE7B82D07UL, 0x90BF1D91UL,
+    0x1DB71064UL, 0x6AB020F2UL, 0xF3B97148UL, 0x84BE41DEUL, 0x1ADAD47DUL, 0x6DDDE4EBUL, 0xF4D4B551UL, 0x83D385C7UL,
+    0x136C9856UL, 0x646BA8C0UL, 0xFD62F97AUL, 0x8A65C9ECUL, 0x14015C4FUL, 0x63066CD9UL, 0xFA0F3D63UL, 0x8D080DF5UL,
+    0x3B6E20C8UL, 0x4C69105EUL, 0xD56041E4UL, 0xA2677172UL, 0x3C03E4D1UL, 0x4B04D447UL, 0xD20D85FDUL, 0xA50AB56BUL,
+    0x35B5A8FAUL, 0x42B2986CUL, 0xDBBBC9D6UL, 0xACBCF940UL, 0x32D86CE3UL, 0x45DF5C75UL, 0xDCD60DCFUL, 0xABD13D59UL,
+    0x26D930ACUL, 0x51DE003AUL, 0xC8D75180UL, 0xBFD06116UL, 0x21B4F4B5UL, 0x56B3C423UL, 0xCFBA9599UL, 0xB8BDA50FUL,
+    0x2802B89EUL, 0x5F058808UL, 0xC60CD9B2UL, 0xB10BE924UL, 0x2F6F7C87UL, 0x58684C11UL, 0xC1611DABUL, 0xB6662D3DUL,
+    0x76DC4190UL, 0x01DB7106UL, 0x98D220BCUL, 0xEFD5102AUL, 0x71B18589UL, 0x06B6B51FUL, 0x9FBFE4A5UL, 0xE8B8D433UL,
+    0x7807C9A2UL, 0x0F00F934UL, 0x9609A88EUL, 0xE10E9818UL, 0x7F6A0DBBUL, 0x086D3D2DUL, 0x91646C97UL, 0xE6635C01UL,
+    0x6B6B51F4UL, 0x1C6C6162UL, 0x856530D8UL, 0xF262004EUL, 0x6C0695EDUL, 0x1B01A57BUL, 0x8208F4C1UL, 0xF50FC457UL,
+    0x65B0D9C6UL, 0x12B7E950UL, 0x8BBEB8EAUL, 0xFCB9887CUL, 0x62DD1DDFUL, 0x15DA2D49UL, 0x8CD37CF3UL, 0xFBD44C65UL,
+    0x4DB26158UL, 0x3AB551CEUL, 0xA3BC0074UL, 0xD4BB30E2UL, 0x4ADFA541UL, 0x3DD895D7UL, 0xA4D1C46DUL, 0xD3D6F4FBUL,
+    0x4369E96AUL, 0x346ED9FCUL, 0xAD678846UL, 0xDA60B8D0UL, 0x44042D73UL, 0x33031DE5UL, 0xAA0A4C5FUL, 0xDD0D7CC9UL,
+    0x5005713CUL, 0x270241AAUL, 0xBE0B1010UL, 0xC90C2086UL, 0x5768B525UL, 0x206F85B3UL, 0xB966D409UL, 0xCE61E49FUL,
+    0x5EDEF90EUL, 0x29D9C998UL, 0xB0D09822UL, 0xC7D7A8B4UL, 0x59B33D17UL, 0x2EB40D81UL, 0xB7BD5C3BUL, 0xC0BA6CADUL,
+    0xEDB88320UL, 0x9ABFB3B6UL, 0x03B6E20CUL, 0x74B1D29AUL, 0xEAD54739UL, 0x9DD277AFUL, 0x04DB2615UL, 0x73DC1683UL,
+    0xE3630B12UL, 0x94643B84UL, 0x0D6D6A3EUL, 0x7A6A5AA8UL, 0xE40ECF0BUL, 0x9309FF9DUL, 0x0A00AE27UL, 0x7D079EB1UL,
+    0xF00F9344UL, 0x8708A3D2UL, 0x1E01F268UL, 0x6906C2FEUL, 0xF762575DUL, 0x806567CBUL, 0x196C3671UL, 0x6E6B06E7UL,
+    0xFED41B76UL, 0x89D32BE0UL, 0x10DA7A5AUL, 0x67DD4ACCUL, 0xF9B9DF6FUL, 0x8EBEEFF9UL, 0x17B7BE43UL, 0x60B08ED5UL,
+    0xD6D6A3E8UL, 0xA1D1937EUL, 0x38D8C2C4UL, 0x4FDFF252UL, 0xD1BB67F1UL, 0xA6BC5767UL, 0x3FB506DDUL, 0x48B2364BUL,
+    0xD80D2BDAUL, 0xAF0A1B4CUL, 0x36034AF6UL, 0x41047A60UL, 0xDF60EFC3UL, 0xA867DF55UL, 0x316E8EEFUL, 0x4669BE79UL,
+    0xCB61B38CUL, 0xBC66831AUL, 0x256FD2A0UL, 0x5268E236UL, 0xCC0C7795UL, 0xBB0B4703UL, 0x220216B9UL, 0x5505262FUL,
+    0xC5BA3BBEUL, 0xB2BD0B28UL, 0x2BB45A92UL, 0x5CB36A04UL, 0xC2D7FFA7UL, 0xB5D0CF31UL, 0x2CD99E8BUL, 0x5BDEAE1DUL,
+    0x9B64C2B0UL, 0xEC63F226UL, 0x756AA39CUL, 0x026D930AUL, 0x9C0906A9UL, 0xEB0E363FUL, 0x72076785UL, 0x05005713UL,
+    0x95BF4A82UL, 0xE2B87A14UL, 0x7BB12BAEUL, 0x0CB61B38UL, 0x92D28E9BUL, 0xE5D5BE0DUL, 0x7CDCEFB7UL, 0x0BDBDF21UL,
+    0x86D3D2D4UL, 0xF1D4E242UL, 0x68DDB3F8UL, 0x1FDA836EUL, 0x81BE16CDUL, 0xF6B9265BUL, 0x6FB077E1UL, 0x18B74777UL,
+    0x88085AE6UL, 0xFF0F6A70UL, 0x66063BCAUL, 0x11010B5CUL, 0x8F659EFFUL, 0xF862AE69UL, 0x616BFFD3UL, 0x166CCF45UL,
+    0xA00AE278UL, 0xD70DD2EEUL, 0x4E048354UL, 0x3903B3C2UL, 0xA7672661UL, 0xD06016F7UL, 0x4969474DUL, 0x3E6E77DBUL,
+    0xAED16A4AUL, 0xD9D65ADCUL, 0x40DF0B66UL, 0x37D83BF0UL, 0xA9BCAE53UL, 0xDEBB9EC5UL, 0x47B2CF7FUL, 0x30B5FFE9UL,
+    0xBDBDF21CUL, 0xCABAC28AUL, 0x53B39330UL, 0x24B4A3A6UL, 0xBAD03605UL, 0xCDD70693UL, 0x54DE5729UL, 0x23D967BFUL,
+    0xB3667A2EUL, 0xC4614AB8UL, 0x5D681B02UL, 0x2A6F2B94UL, 0xB40BBE37UL, 0xC30C8EA1UL, 0x5A05DF1BUL, 0x2D02EF8DUL,
+};
+#if LWPKT_CFG_CRC_DESC
+/* Pre-calculated tables of built-in descriptors */
+static const uint32_t crc16_ccitt_table[256] = {
+    0x00000000UL, 0x00001021UL, 0x00002042UL, 0x00003063UL, 0x00004084UL, 0x000050A5UL, 0x000060C6UL, 0x000070E7UL,
+    0x00008108UL, 0x00009129UL, 0x0000A14AUL, 0x0000B16BUL, 0x0000C18CUL, 0x0000D1ADUL, 0x0000E1CEUL, 0x0000F1EFUL,
+    0x00001231UL, 0x00000210UL, 0x00003273UL, 0x00002252UL, 0x000052B5UL, 0x00004294UL, 0x000072F7UL, 0x000062D6UL,
+    0x00009339UL, 0x00008318UL, 0x0000B37BUL, 0x0000A35AUL, 0x0000D3BDUL, 0x0000C39CUL, 0x0000F3FFUL, 0x0000E3DEUL,
+    0x00002462UL, 0x00003443UL, 0x00000420UL, 0x00001401UL, 0x000064E6UL, 0x000074C7UL, 0x000044A4UL, 0x00005485UL,
+    0x0000A56AUL, 0x0000B54BUL, 0x00008528UL, 0x00009509UL, 0x0000E5EEUL, 0x0000F5CFUL, 0x0000C5ACUL, 0x0000D58DUL,
+    0x00003653UL, 0x00002672UL, 0x00001611UL, 0x00000630UL, 0x000076D7UL, 0x000066F6UL, 0x00005695UL, 0x000046B4UL,
+    0x0000B75BUL, 0x0000A77AUL, 0x00009719UL, 0x00008738UL, 0x0000F7DFUL, 0x0000E7FEUL, 0x0000D79DUL, 0x0000C7BCUL,
+    0x000048C4UL, 0x000058E5UL, 0x00006886UL, 0x000078A7UL, 0x00000840UL, 0x00001861UL, 0x00002802UL, 0x00003823UL,
+    0x0000C9CCUL, 0x0000D9EDUL, 0x0000E98EUL, 0x0000F9AFUL, 0x00008948UL, 0x00009969UL, 0x0000A90AUL, 0x0000B92BUL,
+    0x00005AF5UL, 0x00004AD4UL, 0x00007AB7UL, 0x00006A96UL, 0x00001A71UL, 0x00000A50UL, 0x00003A33UL, 0x00002A12UL,
+    0x0000DBFDUL, 0x0000CBDCUL, 0x0000FBBFUL, 0x0000EB9EUL, 0x00009B79UL, 0x00008B58UL, 0x0000BB3BUL, 0x0000AB1AUL,
+    0x00006CA6UL, 0x00007C87UL, 0x00004CE4UL, 0x00005CC5UL, 0x00002C22UL, 0x00003C03UL, 0x00000C60UL, 0x00001C41UL,
+    0x0000EDAEUL, 0x0000FD8FUL, 0x0000CDECUL, 0x0000DDCDUL, 0x0000AD2AUL, 0x0000BD0BUL, 0x00008D68UL, 0x00009D49UL,
+    0x00007E97UL, 0x00006EB6UL, 0x00005ED5UL, 0x00004EF4UL, 0x00003E13UL, 0x00002E32UL, 0x00001E51UL, 0x00000E70UL,
+    0x0000FF9FUL, 0x0000EFBEUL, 0x0000DFDDUL, 0x0000CFFCUL, 0x0000BF1BUL, 0x0000AF3AUL, 0x00009F59UL, 0x00008F78UL,
+    0x00009188UL, 0x000081A9UL, 0x0000B1CAUL, 0x0000A1EBUL, 0x0000D10CUL, 0x0000C12DUL, 0x0000F14EUL, 0x0000E16FUL,
+    0x00001080UL, 0x000000A1UL, 0x000030C2UL, 0x000020E3UL, 0x00005004UL, 0x00004025UL, 0x00007046UL, 0x00006067UL,
+    0x000083B9UL, 0x00009398UL, 0x0000A3FBUL, 0x0000B3DAUL, 0x0000C33DUL, 0x0000D31CUL, 0x0000E37FUL, 0x0000F35EUL,
+    0x000002B1UL, 0x00001290UL, 0x000022F3UL, 0x000032D2UL, 0x00004235UL, 0x00005214UL, 0x00006277UL, 0x00007256UL,
+    0x0000B5EAUL, 0x0000A5CBUL, 0x000095A8UL, 0x00008589UL, 0x0000F56EUL, 0x0000E54FUL, 0x0000D52CUL, 0x0000C50DUL,
+    0x000034E2UL, 0x000024C3UL, 0x000014A0UL, 0x00000481UL, 0x00007466UL, 0x00006447UL, 0x00005424UL, 0x00004405UL,
+    0x0000A7DBUL, 0x0000B7FAUL, 0x00008799UL, 0x000097B8UL, 0x0000E75FUL, 0x0000F77EUL, 0x0000C71DUL, 0x0000D73CUL,
+    0x000026D3UL, 0x000036F2UL, 0x00000691UL, 0x000016B0UL, 0x00006657UL, 0x00007676UL, 0x00004615UL, 0x00005634UL,
+    0x0000D94CUL, 0x0000C96DUL, 0x0000F90EUL, 0x0000E92FUL, 0x000099C8UL, 0x000089E9UL, 0x0000B98AUL, 0x0000A9ABUL,
+    0x00005844UL, 0x00004865UL, 0x00007806UL, 0x00006827UL, 0x000018C0UL, 0x000008E1UL, 0x00003882UL, 0x000028A3UL,
+    0x0000CB7DUL, 0x0000DB5CUL, 0x0000EB3FUL, 0x0000FB1EUL, 0x00008BF9UL, 0x00009BD8UL, 0x0000ABBBUL, 0x0000BB9AUL,
+    0x00004A75UL, 0x00005A54UL, 0x00006A37UL, 0x00007A16UL, 0x00000AF1UL, 0x00001AD0UL, 0x00002AB3UL, 0x00003A92UL,
+    0x0000FD2EUL, 0x0000ED0FUL, 0x0000DD6CUL, 0x0000CD4DUL, 0x0000BDAAUL, 0x0000AD8BUL, 0x00009DE8UL, 0x00008DC9UL,
+    0x00007C26UL, 0x00006C07UL, 0x00005C64UL, 0x00004C45UL, 0x00003CA2UL, 0x00002C83UL, 0x00001CE0UL, 0x00000CC1UL,
+    0x0000EF1FUL, 0x0000FF3EUL, 0x0000CF5DUL, 0x0000DF7CUL, 0x0000AF9BUL, 0x0000BFBAUL, 0x00008FD9UL, 0x00009FF8UL,
+    0x00006E17UL, 0x00007E36UL, 0x00004E55UL, 0x00005E74UL, 0x00002E93UL, 0x00003EB2UL, 0x00000ED1UL, 0x00001EF0UL,
+};
+static const uint32_t crc32c_table[256] = {
+    0x00000000UL, 0xF26B8303UL, 0xE13B70F7UL, 0x1350F3F4UL, 0xC79A971FUL, 0x35F1141CUL, 0x26A1E7E8UL, 0xD4CA64EBUL,
+    0x8AD958CFUL, 0x78B2DBCCUL, 0x6BE22838UL, 0x9989AB3BUL, 0x4D43CFD0UL, 0xBF284CD3UL, 0xAC78BF27UL, 0x5E133C24UL,
+    0x105EC76FUL, 0xE235446CUL, 0xF165B798UL, 0x030E349BUL, 0xD7C45070UL, 0x25AFD373UL, 0x36FF2087UL, 0xC494A384UL,
+    0x9A879FA0UL, 0x68EC1CA3UL, 0x7BBCEF57UL, 0x89D76C54UL, 0x5D1D08BFUL, 0xAF768BBCUL, 0xBC267848UL, 0x4E4DFB4BUL,
+    0x20BD8EDEUL, 0xD2D60DDDUL, 0xC186FE29UL, 0x33ED7D2AUL, 0xE72719C1UL, 0x154C9AC2UL, 0x061C6936UL, 0xF477EA35UL,
+    0xAA64D611UL, 0x580F5512UL, 0x4B5FA6E6UL, 0xB93425E5UL, 0x6DFE410EUL, 0x9F95C20DUL, 0x8CC531F9UL, 0x7EAEB2FAUL,
+    0x30E349B1UL, 0xC288CAB2UL, 0xD1D83946UL, 0x23B3BA45UL, 0xF779DEAEUL, 0x05125DADUL, 0x1642AE59UL, 0xE4292D5AUL,
+    0xBA3A117EUL, 0x4851927DUL, 0x5B016189UL, 0xA96AE28AUL, 0x7DA08661UL, 0x8FCB0562UL, 0x9C9BF696UL, 0x6EF07595UL,
+    0x417B1DBCUL, 0xB3109EBFUL, 0xA0406D4BUL, 0x522BEE48UL, 0x86E18AA3UL, 0x748A09A0UL, 0x67DAFA54UL, 0x95B17957UL,
+    0xCBA24573UL, 0x39C9C670UL, 0x2A993584UL, 0xD8F2B687UL, 0x0C38D26CUL, 0xFE53516FUL, 0xED03A29BUL, 0x1F682198UL,
+    0x5125DAD3UL, 0xA34E59D0UL, 0xB01EAA24UL, 0x42752927UL, 0x96BF4DCCUL, 0x64D4CECFUL, 0x77843D3BUL, 0x85EFBE38UL,
+    0xDBFC821CUL, 0x2997011FUL, 0x3AC7F2EBUL, 0xC8AC71E8UL, 0x1C661503UL, 0xEE0D9600UL, 0xFD5D65F4UL, 0x0F36E6F7UL,
+    0x61C69362UL, 0x93AD1061UL, 0x80FDE395UL, 0x72966096UL, 0xA65C047DUL, 0x5437877EUL, 0x4767748AUL, 0xB50CF789UL,
+    0xEB1FCBADUL, 0x197448AEUL, 0x0A24BB5AUL, 0xF84F3859UL, 0x2C855CB2UL, 0xDEEEDFB1UL, 0xCDBE2C45UL, 0x3FD5AF46UL,
+    0x7198540DUL, 0x83F3D70EUL, 0x90A324FAUL, 0x62C8A7F9UL, 0xB602C312UL, 0x44694011UL, 0x5739B3E5UL, 0xA55230E6UL,
+    0xFB410CC2UL, 0x092A8FC1UL, 0x1A7A7C35UL, 0xE811FF36UL, 0x3CDB9BDDUL, 0xCEB018DEUL, 0xDDE0EB2AUL, 0x2F8B6829UL,
+    0x82F63B78UL, 0x709DB87BUL, 0x63CD4B8FUL, 0x91A6C88CUL, 0x456CAC67UL, 0xB7072F64UL, 0xA457DC90UL, 0x563C5F93UL,
+    0x082F63B7UL, 0xFA44E0B4UL, 0xE9141340UL, 0x1B7F9043UL, 0xCFB5F4A8UL, 0x3DDE77ABUL, 0x2E8E845FUL, 0xDCE5075CUL,
+    0x92A8FC17UL, 0x60C37F14UL, 0x73938CE0UL, 0x81F80FE3UL, 0x55326B08UL, 0xA759E80BUL, 0xB4091BFFUL, 0x466298FCUL,
+    0x1871A4D8UL, 0xEA1A27DBUL, 0xF94AD42FUL, 0x0B21572CUL, 0xDFEB33C7UL, 0x2D80B0C4UL, 0x3ED04330UL, 0xCCBBC033UL,
+    0xA24BB5A6UL, 0x502036A5UL, 0x4370C551UL, 0xB11B4652UL, 0x65D122B9UL, 0x97BAA1BAUL, 0x84EA524EUL, 0x7681D14DUL,
+    0x2892ED69UL, 0xDAF96E6AUL, 0xC9A99D9EUL, 0x3BC21E9DUL, 0xEF087A76UL, 0x1D63F975UL, 0x0E330A81UL, 0xFC588982UL,
+    0xB21572C9UL, 0x407EF1CAUL, 0x532E023EUL, 0xA145813DUL, 0x758FE5D6UL, 0x87E466D5UL, 0x94B49521UL, 0x66DF1622UL,
+    0x38CC2A06UL, 0xCAA7A905UL, 0xD9F75AF1UL, 0x2B9CD9F2UL, 0xFF56BD19UL, 0x0D3D3E1AUL, 0x1E6DCDEEUL, 0xEC064EEDUL,
+    0xC38D26C4UL, 0x31E6A5C7UL, 0x22B65633UL, 0xD0DDD530UL, 0x0417B1DBUL, 0xF67C32D8UL, 0xE52CC12CUL, 0x1747422FUL,
+    0x49547E0BUL, 0xBB3FFD08UL, 0xA86F0EFCUL, 0x5A048DFFUL, 0x8ECEE914UL, 0x7CA56A17UL, 0x6FF599E3UL, 0x9D9E1AE0UL,
+    0xD3D3E1ABUL, 0x21B862A8UL, 0x32E8915CUL, 0xC083125FUL, 0x144976B4UL, 0xE622F5B7UL, 0xF5720643UL, 0x07198540UL,
+    0x590AB964UL, 0xAB613A67UL, 0xB831C993UL, 0x4A5A4A90UL, 0x9E902E7BUL, 0x6CFBAD78UL, 0x7FAB5E8CUL, 0x8DC0DD8FUL,
+    0xE330A81AUL, 0x115B2B19UL, 0x020BD8EDUL, 0xF0605BEEUL, 0x24AA3F05UL, 0xD6C1BC06UL, 0xC5914FF2UL, 0x37FACCF1UL,
+    0x69E9F0D5UL, 0x9B8273D6UL, 0x88D28022UL, 0x7AB90321UL, 0xAE7367CAUL, 0x5C18E4C9UL, 0x4F48173DUL, 0xBD23943EUL,
+    0xF36E6F75UL, 0x0105EC76UL, 0x12551F82UL, 0xE03E9C81UL, 0x34F4F86AUL, 0xC69F7B69UL, 0xD5CF889DUL, 0x27A40B9EUL,
+    0x79B737BAUL, 0x8BDCB4B9UL, 0x988C474DUL, 0x6AE7C44EUL, 0xBE2DA0A5UL, 0x4C4623A6UL, 0x5F16D052UL, 0xAD7D5351UL,
+};
+#endif /* LWPKT_CFG_CRC_DESC */
+#elif LWPKT_CFG_CRC_TABLE == 2
+/* CRC tables, generated on first library initialization */
+static uint8_t crc8_table[256];
+static uint32_t crc32_table[LWPKT_CFG_CRC32_SLICE_BY][256];
+#if LWPKT_CFG_CRC_DESC
+static uint32_t crc16_ccitt_table[256];
+static uint32_t crc32c_table[256];
+#endif /* LWPKT_CFG_CRC_DESC */
+static lwrb_ulong_t crc_tables_state; /* Instances may be initialized from multiple threads or interrupts */
+#endif /* LWPKT_CFG_CRC_TABLE == 2 */
+
+#if LWPKT_CFG_CRC_TABLE != 1
+
 /**
  * \brief           Calculate one bloc of data
  * 
@@ -150,6 +489,253 @@ prv_crc_calc_one(uint32_t crc_curr, uint32_t new_entry, uint32_t poly) {
     return crc_curr;
 }
 
+#endif /* LWPKT_CFG_CRC_TABLE != 1 */
+
+#if LWPKT_CFG_CRC_DESC
+
+/* Descriptor width is supported by the library */
+#define CRC_DESC_WIDTH_VALID(d) ((d)->width == 8U || (d)->width == 16U || (d)->width == 32U)
+
+/* Mask of valid bits in the CRC register */
+#define CRC_DESC_MASK(d)        ((d)->width >= 32U ? 0xFFFFFFFFUL : ((1UL << (d)->width) - 1UL))
+
+/**
+ * \brief           Reflect bit order of the value
+ * \param[in]       val: Value to reflect
+ * \param[in]       width: Number of bits to reflect
+ * \return          Reflected value
+ */
+static uint32_t
+prv_crc_reflect(uint32_t val, uint8_t width) {
+    uint32_t res = 0;
+
+    for (uint8_t i = 0; i < width; ++i, val >>= 1U) {
+        res = (res << 1U) | (val & 0x01UL);
+    }
+    return res;
+}
+
+/**
+ * \brief           Get descriptor polynomial, prepared for the shift direction
+ * \param[in]       desc: CRC descriptor
+ * \return          Polynomial for calculation
+ */
+static uint32_t
+prv_crc_desc_poly(const lwpkt_crc_desc_t* desc) {
+    return desc->reflect ? prv_crc_reflect(desc->poly, desc->width) : (desc->poly & CRC_DESC_MASK(desc));
+}
+
+/**
+ * \brief           Process one byte bit-wise, with parameters of the descriptor
+ * \param[in]       desc: CRC descriptor
+ * \param[in]       poly: Polynomial, prepared with \ref prv_crc_desc_poly
+ * \param[in]       crc: Current CRC register value
+ * \param[in]       b: Byte to process
+ * \return          New CRC register value
+ */
+static uint32_t
+prv_crc_desc_calc_one(const lwpkt_crc_desc_t* desc, uint32_t poly, uint32_t crc, uint8_t b) {
+    if (desc->reflect) {
+        crc ^= b;
+        for (uint8_t j = 0; j < 8U; ++j) {
+            crc = (crc & 0x01UL) ? ((crc >> 1U) ^ poly) : (crc >> 1U);
+        }
+    } else {
+        uint32_t top = 1UL << (desc->width - 1U);
+
+        crc ^= (uint32_t)b << (desc->width - 8U);
+        for (uint8_t j = 0; j < 8U; ++j) {
+            crc = (crc & top) ? ((crc << 1U) ^ poly) : (crc << 1U);
+        }
+        crc &= CRC_DESC_MASK(desc);
+    }
+    return crc;
+}
+
+/**
+ * \brief           Add data to CRC, calculated with parameters of the descriptor
+ * \param[in]       crcobj: CRC instance with descriptor
+ * \param[in]       table: Lookup table of the descriptor, or `NULL` for bit-wise calculation
+ * \param[in]       p_data: Input data
+ * \param[in]       len: Number of bytes to process
+ * \return          New CRC register value
+ */
+static uint32_t
+prv_crc_desc_in(const lwpkt_crc_t* crcobj, const uint32_t* table, const uint8_t* p_data, size_t len) {
+    const lwpkt_crc_desc_t* desc = crcobj->desc;
+    uint32_t crc = crcobj->crc;
+
+    if (desc->block_fn != NULL) {
+        return desc->block_fn(crc, p_data, len);
+    }
+    if (table == NULL) {
+        for (; len > 0; --len, ++p_data) {
+            crc = prv_crc_desc_calc_one(desc, crcobj->poly, crc, *p_data);
+        }
+    } else if (desc->reflect) {
+        for (; len > 0; --len, ++p_data) {
+            crc = (crc >> 8U) ^ table[(crc ^ *p_data) & 0xFFU];
+        }
+    } else {
+        uint32_t mask = CRC_DESC_MASK(desc);
+        uint8_t shift = (uint8_t)(desc->width - 8U);
+
+        for (; len > 0; --len, ++p_data) {
+            crc = ((crc << 8U) ^ table[((crc >> shift) ^ *p_data) & 0xFFU]) & mask;
+        }
+    }
+    return crc;
+}
+
+#if LWPKT_CFG_CRC32C_HW
+
+/**
+ * \brief           Calculate `CRC-32C` with CPU instructions
+ * \param[in]       crc: Current CRC register value
+ * \param[in]       data: Data to process
+ * \param[in]       len: Number of bytes to process
+ * \return          New CRC register value
+ */
+static uint32_t
+prv_crc32c_hw(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p_data = data;
+
+#if defined(__SSE4_2__)
+#if defined(__x86_64__)
+    for (; len >= 8U; len -= 8U, p_data += 8U) {
+        uint64_t val;
+
+        LWPKT_MEMCPY(&val, p_data, sizeof(val)); /* Data may not be aligned */
+        crc = (uint32_t)_mm_crc32_u64(crc, val);
+    }
+#endif /* defined(__x86_64__) */
+    for (; len > 0; --len, ++p_data) {
+        crc = _mm_crc32_u8(crc, *p_data);
+    }
+#else  /* defined(__SSE4_2__) */
+    for (; len >= 8U; len -= 8U, p_data += 8U) {
+        uint64_t val;
+
+        LWPKT_MEMCPY(&val, p_data, sizeof(val)); /* Data may not be aligned */
+        crc = __crc32cd(crc, val);
+    }
+    for (; len > 0; --len, ++p_data) {
+        crc = __crc32cb(crc, *p_data);
+    }
+#endif /* !defined(__SSE4_2__) */
+    return crc;
+}
+
+#define CRC32C_BLOCK_FN prv_crc32c_hw
+#else /* LWPKT_CFG_CRC32C_HW */
+#define CRC32C_BLOCK_FN NULL
+#endif /* !LWPKT_CFG_CRC32C_HW */
+
+#if LWPKT_CFG_CRC_TABLE
+#define CRC_DESC_TBL(t) (t)
+#else /* LWPKT_CFG_CRC_TABLE */
+#define CRC_DESC_TBL(t) NULL
+#endif /* !LWPKT_CFG_CRC_TABLE */
+
+/**
+ * \brief           `CRC-16/CCITT` descriptor, also known as `CRC-16/CCITT-FALSE`.
+ *                  Polynomial `0x1021`, initial value `0xFFFF`, not reflected
+ */
+const lwpkt_crc_desc_t lwpkt_crc_desc_crc16_ccitt = {
+    16U,                                  /* Width */
+    0U,                                   /* Reflect */
+    0x1021UL,                             /* Polynomial */
+    0xFFFFUL,                             /* Initial value */
+    0x0000UL,                             /* Output XOR */
+    CRC_DESC_TBL(crc16_ccitt_table), NULL /* Table and block function */
+};
+
+/**
+ * \brief           `CRC-32C` (Castagnoli) descriptor.
+ *                  Polynomial `0x1EDC6F41`, initial value and output XOR `0xFFFFFFFF`, reflected
+ */
+const lwpkt_crc_desc_t lwpkt_crc_desc_crc32c = {
+    32U,                                        /* Width */
+    1U,                                         /* Reflect */
+    0x1EDC6F41UL,                               /* Polynomial */
+    0xFFFFFFFFUL,                               /* Initial value */
+    0xFFFFFFFFUL,                               /* Output XOR */
+    CRC_DESC_TBL(crc32c_table), CRC32C_BLOCK_FN /* Table and block function */
+};
+
+#endif /* LWPKT_CFG_CRC_DESC */
+
+#if LWPKT_CFG_CRC_TABLE == 2
+
+/* CRC tables generation state flags */
+#define CRC_TABLES_FLAG_BUSY  0x01UL
+#define CRC_TABLES_FLAG_READY 0x02UL
+
+#ifdef LWRB_DISABLE_ATOMIC
+#define CRC_TABLES_IS_READY() ((crc_tables_state & CRC_TABLES_FLAG_READY) != 0)
+#else /* LWRB_DISABLE_ATOMIC */
+#define CRC_TABLES_IS_READY()                                                                                          \
+    ((atomic_load_explicit(&crc_tables_state, memory_order_acquire) & CRC_TABLES_FLAG_READY) != 0)
+#endif /* !LWRB_DISABLE_ATOMIC */
+
+/**
+ * \brief           Generate CRC lookup tables in RAM.
+ * Tables are shared between all instances, hence generated only once.
+ * Function never waits. When other thread or interrupt is already generating the tables,
+ * it returns immediately and CRC is calculated bit-wise until tables are ready
+ */
+static void
+prv_crc_tables_init(void) {
+#ifdef LWRB_DISABLE_ATOMIC
+    if (crc_tables_state != 0) {
+        return;
+    }
+    crc_tables_state = CRC_TABLES_FLAG_BUSY;
+#else  /* LWRB_DISABLE_ATOMIC */
+    if (atomic_fetch_or_explicit(&crc_tables_state, CRC_TABLES_FLAG_BUSY, memory_order_acquire) != 0) {
+        return;
+    }
+#endif /* !LWRB_DISABLE_ATOMIC */
+    for (uint32_t i = 0; i < 256U; ++i) {
+        crc8_table[i] = (uint8_t)prv_crc_calc_one(0, i, CRC_POLY_8);
+        crc32_table[0][i] = prv_crc_calc_one(0, i, CRC_POLY_32);
+    }
+
+    /* Each next table continues with one zero byte on top of previous one */
+    for (size_t k = 1; k < LWPKT_CFG_CRC32_SLICE_BY; ++k) {
+        for (size_t i = 0; i < 256U; ++i) {
+            uint32_t prev = crc32_table[k - 1][i];
+            crc32_table[k][i] = (prev >> 8U) ^ crc32_table[0][prev & 0xFFU];
+        }
+    }
+#if LWPKT_CFG_CRC_DESC
+    lwpkt_crc_table_gen(&lwpkt_crc_desc_crc16_ccitt, crc16_ccitt_table);
+    lwpkt_crc_table_gen(&lwpkt_crc_desc_crc32c, crc32c_table);
+#endif /* LWPKT_CFG_CRC_DESC */
+
+    /* Publish tables to instances, that check the flag before table access */
+#ifdef LWRB_DISABLE_ATOMIC
+    crc_tables_state |= CRC_TABLES_FLAG_READY;
+#else  /* LWRB_DISABLE_ATOMIC */
+    atomic_fetch_or_explicit(&crc_tables_state, CRC_TABLES_FLAG_READY, memory_order_release);
+#endif /* !LWRB_DISABLE_ATOMIC */
+}
+
+#define CRC32_TBL(k, i) crc32_table[(k)][(i)]
+#elif LWPKT_CFG_CRC_TABLE == 1
+#define CRC32_TBL(k, i) crc32_table[(i)]
+#define CRC_TABLES_IS_READY() 1
+#endif /* LWPKT_CFG_CRC_TABLE == 1 */
+
+#if LWPKT_CFG_CRC_DESC
+#if LWPKT_CFG_CRC_TABLE == 2
+/* Built-in descriptors point to RAM tables, which are not used until generated */
+#define CRC_DESC_TBL_GET(d) (CRC_TABLES_IS_READY() ? (d)->table : NULL)
+#else /* LWPKT_CFG_CRC_TABLE == 2 */
+#define CRC_DESC_TBL_GET(d) ((d)->table)
+#endif /* LWPKT_CFG_CRC_TABLE != 2 */
+#endif /* LWPKT_CFG_CRC_DESC */
+
 /**
  * \brief           Add new value to CRC instance
  * \param           pkt: LwPKT object
@@ -159,18 +745,76 @@ prv_crc_calc_one(uint32_t crc_curr, uint32_t new_entry, uint32_t poly) {
  * \return          Current CRC calculated value after all bytes or `0` on error input data
  */
 static uint32_t
-prv_crc_in(lwpkt_t* pkt, lwpkt_crc_t* crcobj, const void* inp, const size_t len) {
+prv_crc_in(lwpkt_t* pkt, lwpkt_crc_t* crcobj, const void* inp, size_t len) {
     const uint8_t* p_data = inp;
+    uint32_t crc;
 
+    (void)pkt;
     if (crcobj == NULL || p_data == NULL || len == 0) {
         return 0;
     }
 
-    for (size_t i = 0; i < len; ++i, ++p_data) {
-        crcobj->crc = prv_crc_calc_one(
-            crcobj->crc, *p_data,
-            CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CRC32, LWPKT_FLAG_CRC32) ? CRC_POLY_32 : CRC_POLY_8);
+#if LWPKT_CFG_CRC_HW
+    /* Let application process it first */
+    if (lwpkt_crc_hw_in(crcobj, inp, len)) {
+        return crcobj->crc;
+    }
+#endif /* LWPKT_CFG_CRC_HW */
+#if LWPKT_CFG_CRC_DESC
+    if (crcobj->desc != NULL) {
+        crcobj->crc = prv_crc_desc_in(crcobj, CRC_DESC_TBL_GET(crcobj->desc), p_data, len);
+        return crcobj->crc;
+    }
+#endif /* LWPKT_CFG_CRC_DESC */
+
+    /* Polynomial has been selected in the init phase, no need to check flags for every byte */
+    crc = crcobj->crc;
+    if (crcobj->is_crc32) {
+#if LWPKT_CFG_CRC_TABLE
+        if (CRC_TABLES_IS_READY()) {
+#if LWPKT_CFG_CRC32_SLICE_BY >= 4
+            /* Process data in blocks, independent on the CPU endianness and data alignment */
+            for (; len >= LWPKT_CFG_CRC32_SLICE_BY;
+                 len -= LWPKT_CFG_CRC32_SLICE_BY, p_data += LWPKT_CFG_CRC32_SLICE_BY) {
+                uint32_t one = crc
+                               ^ ((uint32_t)p_data[0] | ((uint32_t)p_data[1] << 8U) | ((uint32_t)p_data[2] << 16U)
+                                  | ((uint32_t)p_data[3] << 24U));
+#if LWPKT_CFG_CRC32_SLICE_BY == 8
+                crc = CRC32_TBL(7, one & 0xFFU) ^ CRC32_TBL(6, (one >> 8U) & 0xFFU)
+                      ^ CRC32_TBL(5, (one >> 16U) & 0xFFU) ^ CRC32_TBL(4, one >> 24U) ^ CRC32_TBL(3, p_data[4])
+                      ^ CRC32_TBL(2, p_data[5]) ^ CRC32_TBL(1, p_data[6]) ^ CRC32_TBL(0, p_data[7]);
+#else  /* LWPKT_CFG_CRC32_SLICE_BY == 8 */
+                crc = CRC32_TBL(3, one & 0xFFU) ^ CRC32_TBL(2, (one >> 8U) & 0xFFU)
+                      ^ CRC32_TBL(1, (one >> 16U) & 0xFFU) ^ CRC32_TBL(0, one >> 24U);
+#endif /* LWPKT_CFG_CRC32_SLICE_BY != 8 */
+            }
+#endif /* LWPKT_CFG_CRC32_SLICE_BY >= 4 */
+            for (; len > 0; --len, ++p_data) {
+                crc = (crc >> 8U) ^ CRC32_TBL(0, (crc ^ *p_data) & 0xFFU);
+            }
+        }
+#endif /* LWPKT_CFG_CRC_TABLE */
+#if LWPKT_CFG_CRC_TABLE != 1
+        /* Without tables or while tables are being generated */
+        for (; len > 0; --len, ++p_data) {
+            crc = prv_crc_calc_one(crc, *p_data, CRC_POLY_32);
+        }
+#endif /* LWPKT_CFG_CRC_TABLE != 1 */
+    } else {
+#if LWPKT_CFG_CRC_TABLE
+        if (CRC_TABLES_IS_READY()) {
+            for (; len > 0; --len, ++p_data) {
+                crc = crc8_table[(crc ^ *p_data) & 0xFFU];
+            }
+        }
+#endif /* LWPKT_CFG_CRC_TABLE */
+#if LWPKT_CFG_CRC_TABLE != 1
+        for (; len > 0; --len, ++p_data) {
+            crc = prv_crc_calc_one(crc, *p_data, CRC_POLY_8);
+        }
+#endif /* LWPKT_CFG_CRC_TABLE != 1 */
     }
+    crcobj->crc = crc;
     return crcobj->crc;
 }
 
@@ -184,7 +828,14 @@ prv_crc_in(lwpkt_t* pkt, lwpkt_crc_t* crcobj, const void* inp, const size_t len)
  */
 static uint32_t
 prv_crc_finish(lwpkt_t* pkt, lwpkt_crc_t* crcobj) {
-    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CRC32, LWPKT_FLAG_CRC32)) {
+    (void)pkt;
+#if LWPKT_CFG_CRC_DESC
+    if (crcobj->desc != NULL) {
+        crcobj->crc = (crcobj->crc ^ crcobj->desc->xorout) & CRC_DESC_MASK(crcobj->desc);
+        return crcobj->crc;
+    }
+#endif /* LWPKT_CFG_CRC_DESC */
+    if (crcobj->is_crc32) {
         crcobj->crc ^= 0xFFFFFFFF;
     }
     return crcobj->crc;
@@ -200,209 +851,793 @@ prv_crc_init(lwpkt_t* pkt, lwpkt_crc_t* crcobj) {
     (void)pkt;
     LWPKT_MEMSET(crcobj, 0x00, sizeof(*crcobj));
 
-    /* Set default value */
-    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CRC32, LWPKT_FLAG_CRC32)) {
+    /* Select the CRC type once for the full packet */
+#if LWPKT_CFG_CRC_DESC
+    if (pkt->crc_desc != NULL && CRC_LEN_USED(pkt) > 0) {
+        const lwpkt_crc_desc_t* desc = pkt->crc_desc;
+
+        crcobj->desc = desc;
+        crcobj->poly = prv_crc_desc_poly(desc);
+        crcobj->crc = desc->reflect ? prv_crc_reflect(desc->init, desc->width) : (desc->init & CRC_DESC_MASK(desc));
+        return;
+    }
+#endif /* LWPKT_CFG_CRC_DESC */
+    if (CRC_LEN_USED(pkt) == 4U) {
+        crcobj->is_crc32 = 1;
         crcobj->crc = 0xFFFFFFFFUL;
     }
 }
 
 #endif /* LWPKT_CFG_USE_CRC */
 
+#if LWPKT_LAYOUT_DYNAMIC
+
 /**
- * \brief           Write data to the output stream, with variable length array
- * 
- * \param           pkt: Packet object
- * \param           crc: CRC object
- * \param           var_num: Number to encode
- * \return          Number of bytes used to encode the number
+ * \brief           Prepare packet layout for features, currently enabled in the instance
+ * \param[in]       pkt: Packet instance
  */
-static uint8_t
-write_bytes_var_encoded(lwpkt_t* pkt, lwpkt_crc_t* crc, uint32_t var_num) {
-    uint8_t cnt = 0;
-    do {
-        uint8_t byt = (var_num & 0x7FU) | (var_num > 0x7FU ? 0x80U : 0);
-        WRITE_WITH_CRC(pkt, crc, pkt->tx_rb, &byt, 1);
-        var_num >>= (uint8_t)7U;
-        ++cnt;
-    } while (var_num > 0);
-    return cnt;
+static void
+prv_layout_update(lwpkt_t* pkt) {
+    const lwpkt_layout_t layout = LAYOUT_INIT(
+        CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_ADDR, LWPKT_FLAG_USE_ADDR),
+        CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_ADDR_EXTENDED, LWPKT_FLAG_ADDR_EXTENDED),
+        CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_FLAGS, LWPKT_FLAG_USE_FLAGS),
+        CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CMD, LWPKT_FLAG_USE_CMD),
+        CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CMD_EXTENDED, LWPKT_FLAG_CMD_EXTENDED),
+        CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CRC, LWPKT_FLAG_USE_CRC),
+        CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CRC32, LWPKT_FLAG_CRC32));
+
+    pkt->layout = layout;
+#if LWPKT_CFG_CRC_DESC
+    /* Length of CRC field is defined by the descriptor */
+    if (pkt->layout.crc_len > 0 && pkt->crc_desc != NULL) {
+        pkt->layout.crc_len = (uint8_t)(pkt->crc_desc->width / 8U);
+    }
+#endif /* LWPKT_CFG_CRC_DESC */
 }
 
+#define LAYOUT_UPDATE(p) prv_layout_update(p)
+#else /* LWPKT_LAYOUT_DYNAMIC */
+#define LAYOUT_UPDATE(p)
+#endif /* !LWPKT_LAYOUT_DYNAMIC */
+
 /**
- * \brief           Single function to define steps between packet states
+ * \brief           Build packet header, from start byte until the end of length field
  * 
- * \param           pkt: Packet handle
+ * \param[in]       pkt: Packet instance
+ * \param[out]      hdr: Output memory, at least \ref LWPKT_HDR_MAX_LEN bytes long
+ * \param[in]       to: End device address. Ignored if addressing is not used
+ * \param[in]       flags: Custom flags. Ignored if flags are not used
+ * \param[in]       cmd: Packet command. Ignored if command is not used
+ * \param[in]       len: Length of data part
+ * \return          Number of bytes written to header
  */
-static void
-prv_go_to_next_packet_rx_state(lwpkt_t* pkt) {
-    lwpkt_state_t next_state = LWPKT_STATE_END;
-    switch (pkt->m.state) {
-        /*
-         * Start, addressing, flags and command are all optional 
-         * and all of them are in a sequence.
-         * 
-         * If one of them is disabled, we can simply use a fall-through mode
-         * and check for a next state to move to, if that state is enabled.
-         * 
-         * This is very valid C syntax
-         * 
-         * From start state, we can go to:
-         * 
-         * 1. addressing, if addressing is enabled.
-         * 2. flags management
-         * 2. command, if it is enabled
-         * 4. Final option is to go directly to packet length check
-         */
-        case LWPKT_STATE_START: {
-            if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_ADDR, LWPKT_FLAG_USE_ADDR)) {
-                next_state = LWPKT_STATE_FROM;
-                break;
-            }
-            /* Go to next step if address isn't enabled */
-        } /* fallthrough */
-        case LWPKT_STATE_TO: {
-            if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_FLAGS, LWPKT_FLAG_USE_FLAGS)) {
-                next_state = LWPKT_STATE_FLAGS;
-                break;
-            }
-            /* Go to next step if flags aren't enabled */
-        } /* fallthrough */
-        case LWPKT_STATE_FLAGS: {
-            if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CMD, LWPKT_FLAG_USE_CMD)) {
-                next_state = LWPKT_STATE_CMD;
-                break;
-            }
-        } /* fallthrough */
-        case LWPKT_STATE_CMD: {
-            next_state = LWPKT_STATE_LEN;
-            break;
-        }
-        case LWPKT_STATE_LEN: {
-            /*
-             * If data length is zero, skip data part
-             *
-             * 1. Go to DATA if len != 0
-             * 2. Go to CRC if enabled
-             * 3. Go to STOP check
-             */
-            if (pkt->m.len > 0) {
-                next_state = LWPKT_STATE_DATA;
-                break;
-            }
-        } /* fallthrough */
-        case LWPKT_STATE_DATA: {
-            if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CRC, LWPKT_FLAG_USE_CRC)) {
-                next_state = LWPKT_STATE_CRC;
-                break;
-            }
-            /* Go to next step if CRC isn't enabled */
-        } /* fallthrough */
-        case LWPKT_STATE_CRC: {
-            next_state = LWPKT_STATE_STOP;
-            break;
-        }
-        case LWPKT_STATE_STOP: {
-            next_state = LWPKT_STATE_START;
-            break;
+static size_t
+prv_hdr_build(lwpkt_t* pkt, uint8_t* hdr, uint32_t to, uint32_t flags, uint32_t cmd, size_t len) {
+    const lwpkt_layout_t* layout = LAYOUT(pkt);
+    size_t hdr_len = 0;
+    uint32_t val = 0;
+
+    (void)pkt;
+    (void)to;
+    (void)flags;
+    (void)cmd;
+
+    /* Optional fields, in order of the packet layout */
+    hdr[hdr_len++] = LWPKT_START_BYTE;
+    for (uint8_t state = layout->next[LWPKT_STATE_START]; state != LWPKT_STATE_LEN; state = layout->next[state]) {
+        switch (state) {
+#if LWPKT_CFG_USE_ADDR
+            case LWPKT_STATE_FROM: val = pkt->addr; break;
+            case LWPKT_STATE_TO: val = to; break;
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+            case LWPKT_STATE_FLAGS: val = flags; break;
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+            case LWPKT_STATE_CMD: val = cmd; break;
+#endif /* LWPKT_CFG_USE_CMD */
+            default: break;
         }
-        case LWPKT_STATE_FROM: {
-            /* Step between FROM and TO, always in a sequence */
-            /* There is no other way but to handle second part of addressing */
-            next_state = LWPKT_STATE_TO;
-            break;
+        if (layout->var & LAYOUT_VAR(state)) {
+            hdr_len += lwpkt_varint_encode(&hdr[hdr_len], val);
+        } else {
+            hdr[hdr_len++] = (uint8_t)val;
         }
-        default: {
+    }
+    hdr_len += lwpkt_varint_encode(&hdr[hdr_len], (uint32_t)len);
+    return hdr_len;
+}
+
+/**
+ * \brief           Build packet trailer, CRC and stop byte
+ * 
+ * \param[in]       pkt: Packet instance
+ * \param[in]       crc: CRC object with all header and data bytes already processed
+ * \param[out]      trl: Output memory, at least \ref LWPKT_TRL_MAX_LEN bytes long
+ * \return          Number of bytes written to trailer
+ */
+static size_t
+prv_trl_build(lwpkt_t* pkt, lwpkt_crc_t* crc, uint8_t* trl) {
+    size_t trl_len = 0;
+
+    (void)pkt;
+    (void)crc;
+#if LWPKT_CFG_USE_CRC
+    if (CRC_LEN_USED(pkt) > 0) {
+        uint32_t crc_data = prv_crc_finish(pkt, crc);
+        for (size_t i = 0; i < CRC_LEN_USED(pkt); ++i, crc_data >>= 8UL) {
+            trl[trl_len++] = (uint8_t)(crc_data & 0xFFUL);
         }
     }
-    if (next_state != LWPKT_STATE_END) {
-        LWPKT_SET_STATE(pkt, next_state);
+#endif /* LWPKT_CFG_USE_CRC */
+    trl[trl_len++] = LWPKT_STOP_BYTE;
+    return trl_len;
+}
+
+/**
+ * \brief           Copy data to the free memory of the ring buffer, without committing them.
+ *                  Caller must ensure there is enough free memory available
+ * 
+ * \param[in]       rb: Ring buffer instance
+ * \param[in]       idx: Index in buffer memory to start writing at
+ * \param[in]       data: Data to copy
+ * \param[in]       len: Number of bytes to copy
+ * \return          Index in buffer memory after last written byte
+ */
+static size_t
+prv_rb_put(lwrb_t* rb, size_t idx, const void* data, size_t len) {
+    const uint8_t* d = data;
+    size_t lin_len;
+
+    if (len == 0) {
+        return idx;
     }
+    lin_len = LWPKT_MIN(len, rb->size - idx);
+    LWPKT_MEMCPY(&rb->buff[idx], d, lin_len);
+    if (lin_len < len) {
+        LWPKT_MEMCPY(rb->buff, &d[lin_len], len - lin_len);
+        return len - lin_len;
+    }
+    idx += lin_len;
+    return idx == rb->size ? 0 : idx;
 }
 
+#if LWPKT_CFG_TX_MPSC
+
+/* Multi-producer TX state word: claimed write index, number of writers and flags */
+#define TX_CLAIM_IDX_MASK    0x00FFFFFFUL
+#define TX_CLAIM_CNT_ONE     0x01000000UL
+#define TX_CLAIM_CNT_MASK    0x3F000000UL
+#define TX_CLAIM_FLAG_PUB    0x40000000UL /* Set while one of the writers moves the buffer write pointer */
+#define TX_CLAIM_FLAG_STREAM 0x80000000UL /* Set while streaming transmit packet is in progress */
+
 /**
- * \brief           Initialize packet instance and set device address
+ * \brief           Get free memory in TX buffer, after all claimed regions
  * \param[in]       pkt: Packet instance
- * \param[in]       tx_rb: TX LwRB instance for data write
- * \param[in]       rx_rb: RX LwRB instance for data read
- * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ * \param[in]       claim: Multi-producer TX state word
+ * \param[out]      idx: Index in buffer memory to start writing at
+ * \return          Number of free bytes
  */
-lwpktr_t
-lwpkt_init(lwpkt_t* pkt, lwrb_t* tx_rb, lwrb_t* rx_rb) {
-    if (pkt == NULL) {
-        return lwpktERR;
+static size_t
+prv_tx_free(lwpkt_t* pkt, unsigned long claim, size_t* idx) {
+    lwrb_t* rb = pkt->tx_rb;
+    size_t r;
+
+    /* Without writers, writing continues at buffer write pointer, also after buffer reset */
+    if ((claim & (TX_CLAIM_CNT_MASK | TX_CLAIM_FLAG_PUB)) == 0) {
+        *idx = (size_t)atomic_load_explicit(&rb->w, memory_order_relaxed);
+    } else {
+        *idx = (size_t)(claim & TX_CLAIM_IDX_MASK);
     }
+    r = (size_t)atomic_load_explicit(&rb->r, memory_order_acquire);
+    return r > *idx ? (r - *idx - 1U) : (rb->size - *idx + r - 1U);
+}
 
-    LWPKT_MEMSET(pkt, 0x00, sizeof(*pkt));
-    LWPKT_RESET(pkt);
+#endif /* LWPKT_CFG_TX_MPSC */
 
-    pkt->tx_rb = tx_rb;
-    pkt->rx_rb = rx_rb;
-    pkt->flags |= 0xFFU; /* By default enable all dynamically enabled features */
+/**
+ * \brief           Claim memory in TX buffer for writing.
+ *                  Data are copied to claimed memory with \ref prv_rb_put and committed with \ref prv_tx_commit
+ *
+ * In multi-producer mode, claim fails if streaming transmit state does not match expected one.
+ * Writer, that already holds a claim, extends it with new memory, without being counted again.
+ *
+ * \param[in]       pkt: Packet instance
+ * \param[in]       len: Number of bytes to claim
+ * \param[in]       stream: Expected streaming transmit state. Set to `1` if stream packet must be in progress
+ * \param[in]       stream_next: Streaming transmit state after the claim
+ * \param[in]       hold: Set to `1` if writer holds a claim, not published yet
+ * \param[out]      idx: Index in buffer memory to start writing at
+ * \return          \ref lwpktOK on success, \ref lwpktERRMEM if not enough memory or too many writers,
+ *                      member of \ref lwpktr_t otherwise
+ */
+static lwpktr_t
+prv_tx_claim(lwpkt_t* pkt, size_t len, uint8_t stream, uint8_t stream_next, uint8_t hold, size_t* idx) {
+#if LWPKT_CFG_TX_MPSC
+    unsigned long claim, claim_next;
+    size_t end;
 
+    claim = atomic_load_explicit(&pkt->tx_claim, memory_order_acquire);
+    do {
+        if (!!(claim & TX_CLAIM_FLAG_STREAM) != !!stream) {
+            return lwpktERR;
+        }
+        if (!hold && (claim & TX_CLAIM_CNT_MASK) == TX_CLAIM_CNT_MASK) {
+            return lwpktERRMEM;
+        }
+        if (prv_tx_free(pkt, claim, idx) < len) {
+            return lwpktERRMEM;
+        }
+        end = *idx + len;
+        if (end >= pkt->tx_rb->size) {
+            end -= pkt->tx_rb->size;
+        }
+        claim_next = ((claim & ~(TX_CLAIM_IDX_MASK | TX_CLAIM_FLAG_STREAM)) + (hold ? 0 : TX_CLAIM_CNT_ONE))
+                     | (unsigned long)end | (stream_next ? TX_CLAIM_FLAG_STREAM : 0);
+    } while (!atomic_compare_exchange_weak_explicit(&pkt->tx_claim, &claim, claim_next, memory_order_acq_rel,
+                                                    memory_order_acquire));
+#else  /* LWPKT_CFG_TX_MPSC */
+    size_t off = TX_BATCH_LEN(pkt);
+
+    (void)stream;
+    (void)stream_next;
+    (void)hold;
+    if (lwrb_get_free(pkt->tx_rb) < off + len) {
+        return lwpktERRMEM;
+    }
+#if LWPKT_CFG_TX_FRAMES
+    /* Empty buffer has no frames, also when it has been read or reset without the queue */
+    if (lwrb_get_full(pkt->tx_rb) == 0 && TX_BATCH_CNT(pkt) == 0) {
+        QUEUE_STORE(pkt->txq.w, QUEUE_LOAD(pkt->txq.r, memory_order_acquire), memory_order_relaxed);
+#if LWPKT_CFG_TX_FRAMES_NOWRAP
+        if (pkt->tx_rb->size - (size_t)((uint8_t*)lwrb_get_linear_block_write_address(pkt->tx_rb) - pkt->tx_rb->buff)
+            < len) {
+            lwrb_reset(pkt->tx_rb); /* Start at the beginning of the memory, without padding */
+        }
+#endif /* LWPKT_CFG_TX_FRAMES_NOWRAP */
+    }
+    if (lwpkt_txq_get_count(pkt) + TX_BATCH_CNT(pkt) == LWPKT_CFG_TX_FRAMES) {
+        return lwpktERRMEM;
+    }
+#endif /* LWPKT_CFG_TX_FRAMES */
+    *idx = (size_t)((uint8_t*)lwrb_get_linear_block_write_address(pkt->tx_rb) - pkt->tx_rb->buff) + off;
+    if (*idx >= pkt->tx_rb->size) {
+        *idx -= pkt->tx_rb->size;
+    }
+#if LWPKT_CFG_TX_FRAMES
+    pkt->txq.pad = 0;
+#if LWPKT_CFG_TX_FRAMES_NOWRAP
+    /* Frame is moved to the beginning of the memory, when it does not fit to the end */
+    if (*idx + len > pkt->tx_rb->size) {
+        pkt->txq.pad = pkt->tx_rb->size - *idx;
+        if (lwrb_get_free(pkt->tx_rb) < off + pkt->txq.pad + len) {
+            return lwpktERRMEM;
+        }
+        LWPKT_MEMSET(&pkt->tx_rb->buff[*idx], 0x00, pkt->txq.pad);
+        *idx = 0;
+    }
+#endif /* LWPKT_CFG_TX_FRAMES_NOWRAP */
+    pkt->txq.idx = *idx;
+#endif /* LWPKT_CFG_TX_FRAMES */
+#endif /* !LWPKT_CFG_TX_MPSC */
     return lwpktOK;
 }
 
-#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+#if LWPKT_CFG_TX_MPSC
 
 /**
- * \brief           Set device address for packet instance
+ * \brief           Finish one writer, previously claimed memory with \ref prv_tx_claim
+ *
+ * Last writer to finish moves buffer write pointer over all finished regions.
+ * Only one writer at a time moves the pointer, others hand over their regions to it.
+ *
  * \param[in]       pkt: Packet instance
- * \param[in]       addr: New device address
- * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
  */
-lwpktr_t
-lwpkt_set_addr(lwpkt_t* pkt, lwpkt_addr_t addr) {
-    if (!LWPKT_IS_VALID(pkt)) {
-        return lwpktERR;
+static void
+prv_tx_publish(lwpkt_t* pkt) {
+    unsigned long claim, claim_next, idx;
+    uint8_t again;
+
+    claim = atomic_load_explicit(&pkt->tx_claim, memory_order_relaxed);
+    do {
+        claim_next = claim - TX_CLAIM_CNT_ONE;
+        if ((claim_next & (TX_CLAIM_CNT_MASK | TX_CLAIM_FLAG_PUB)) == 0) {
+            claim_next |= TX_CLAIM_FLAG_PUB;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&pkt->tx_claim, &claim, claim_next, memory_order_acq_rel,
+                                                    memory_order_relaxed));
+    if ((claim & TX_CLAIM_FLAG_PUB) || !(claim_next & TX_CLAIM_FLAG_PUB)) {
+        return; /* Other writer is still writing or publishing */
     }
-    pkt->addr = addr;
 
-    return lwpktOK;
+    /* Publish, until no more writers finished meanwhile */
+    claim = claim_next;
+    do {
+        idx = claim & TX_CLAIM_IDX_MASK;
+        atomic_store_explicit(&pkt->tx_rb->w, idx, memory_order_release);
+        do {
+            again = (claim & TX_CLAIM_CNT_MASK) == 0 && (claim & TX_CLAIM_IDX_MASK) != idx;
+        } while (!again
+                 && !atomic_compare_exchange_weak_explicit(&pkt->tx_claim, &claim, claim & ~TX_CLAIM_FLAG_PUB,
+                                                           memory_order_acq_rel, memory_order_acquire));
+    } while (again);
 }
 
-#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#endif /* LWPKT_CFG_TX_MPSC */
+
+#if LWPKT_CFG_TX_FRAMES
 
 /**
- * \brief           Read raw data from RX ring buffer, parse the characters
- *                  and try to construct the receive packet
+ * \brief           Write frame entry for memory, claimed with \ref prv_tx_claim, after all entries of current batch.
+ *                  Entry is not visible to the application until write counter is moved
  * \param[in]       pkt: Packet instance
- * \return          \ref lwpktVALID when packet valid, member of \ref lwpktr_t otherwise
+ * \param[in]       len: Number of bytes written
+ * \return          Number of bytes to commit, including padding before the frame
  */
-lwpktr_t
-lwpkt_read(lwpkt_t* pkt) {
-    lwpktr_t res = lwpktOK;
-    uint8_t b, e = 0;
-
-    if (!LWPKT_IS_VALID(pkt)) {
-        return lwpktERR;
-    }
+static size_t
+prv_txq_put(lwpkt_t* pkt, size_t len) {
+    lwrb_ulong_t w = QUEUE_LOAD(pkt->txq.w, memory_order_relaxed);
+    lwpkt_tx_frame_t* frame = &pkt->txq.frame[(w + TX_BATCH_CNT(pkt)) % LWPKT_CFG_TX_FRAMES];
+    size_t lin_len = LWPKT_MIN(len, pkt->tx_rb->size - pkt->txq.idx);
+
+    frame->seg[0].data = &pkt->tx_rb->buff[pkt->txq.idx];
+    frame->seg[0].len = lin_len;
+    frame->seg[1].data = pkt->tx_rb->buff;
+    frame->seg[1].len = len - lin_len;
+    frame->pad = pkt->txq.pad;
+    return pkt->txq.pad + len;
+}
 
-    SEND_EVT(pkt, LWPKT_EVT_PRE_READ);
+#endif /* LWPKT_CFG_TX_FRAMES */
 
-    /* Process bytes from RX ringbuffer */
-    /* Read byte by byte and go through state machine */
-    while (lwrb_read(pkt->rx_rb, &b, 1) == 1) {
-        e = 1;
-        switch (pkt->m.state) {
-            case LWPKT_STATE_START: {
-                if (b == LWPKT_START_BYTE) {
-                    LWPKT_RESET(pkt); /* Reset instance and make it ready for receiving */
-                    INIT_CRC(pkt, &pkt->m.crc);
-                    prv_go_to_next_packet_rx_state(pkt);
+/**
+ * \brief           Commit memory, previously claimed with \ref prv_tx_claim
+ *
+ * In multi-producer mode, last writer to finish moves buffer write pointer over all finished regions.
+ *
+ * \param[in]       pkt: Packet instance
+ * \param[in]       len: Number of bytes written. Must be equal to the claimed length in multi-producer mode
+ */
+static void
+prv_tx_commit(lwpkt_t* pkt, size_t len) {
+    STATS_ADD(pkt, tx_bytes, len);
+    STATS_MAX(pkt, tx_rb_max, lwrb_get_full(pkt->tx_rb) + len);
+#if LWPKT_CFG_TX_MPSC
+    (void)len;
+    prv_tx_publish(pkt);
+#elif LWPKT_CFG_TX_FRAMES
+    lwrb_advance(pkt->tx_rb, prv_txq_put(pkt, len));
+    QUEUE_STORE(pkt->txq.w, (QUEUE_LOAD(pkt->txq.w, memory_order_relaxed) + 1U) % TXQ_CNT_MOD,
+                memory_order_release);
+#else  /* LWPKT_CFG_TX_MPSC */
+    lwrb_advance(pkt->tx_rb, len);
+#endif /* !LWPKT_CFG_TX_MPSC */
+}
+
+#if LWPKT_CFG_USE_TX_BATCH
+
+/**
+ * \brief           Add memory, previously claimed with \ref prv_tx_claim, to current batch.
+ *                  Memory is committed with the rest of the batch in \ref lwpkt_batch_commit
+ * \param[in]       pkt: Packet instance
+ * \param[in]       len: Number of bytes written. Must be equal to the claimed length in multi-producer mode
+ */
+static void
+prv_tx_batch_put(lwpkt_t* pkt, size_t len) {
+    STATS_ADD(pkt, tx_bytes, len);
+#if LWPKT_CFG_TX_MPSC
+    (void)len; /* Batch holds single claim, extended by every packet */
+#else  /* LWPKT_CFG_TX_MPSC */
+#if LWPKT_CFG_TX_FRAMES
+    len = prv_txq_put(pkt, len);
+#endif /* LWPKT_CFG_TX_FRAMES */
+    pkt->tx_batch.len += len;
+    STATS_MAX(pkt, tx_rb_max, lwrb_get_full(pkt->tx_rb) + pkt->tx_batch.len);
+#endif /* !LWPKT_CFG_TX_MPSC */
+    ++pkt->tx_batch.cnt;
+}
+
+#endif /* LWPKT_CFG_USE_TX_BATCH */
+
+/**
+ * \brief           Commit memory of the packet, or add it to current batch
+ * \param[in]       pkt: Packet instance
+ * \param[in]       len: Number of bytes written
+ * \param[in]       batch: Set to `1` if packet is part of the batch
+ */
+static void
+prv_tx_finish(lwpkt_t* pkt, size_t len, uint8_t batch) {
+#if LWPKT_CFG_USE_TX_BATCH
+    if (batch) {
+        prv_tx_batch_put(pkt, len);
+        return;
+    }
+#else  /* LWPKT_CFG_USE_TX_BATCH */
+    (void)batch;
+#endif /* !LWPKT_CFG_USE_TX_BATCH */
+    prv_tx_commit(pkt, len);
+}
+
+#if LWPKT_CFG_USE_COBS
+
+/* COBS delimiter and maximum encoded length of "n" bytes, including delimiter */
+#define LWPKT_COBS_DELIM      0x00U
+#define LWPKT_COBS_MAX_LEN(n) ((n) + (n) / 254U + 2U)
+
+/**
+ * \brief           COBS encoder, writing directly to free memory of the ring buffer
+ */
+typedef struct {
+    lwrb_t* rb;      /*!< Ring buffer instance */
+    size_t code_idx; /*!< Buffer index of the code byte of current block */
+    size_t idx;      /*!< Buffer index of next byte to write */
+    size_t len;      /*!< Number of bytes written so far */
+    uint8_t code;    /*!< Code value of current block */
+} prv_cobs_enc_t;
+
+/**
+ * \brief           Finish current COBS block and reserve code byte for the next one
+ * \param[in]       enc: Encoder instance
+ */
+static void
+prv_cobs_enc_block(prv_cobs_enc_t* enc) {
+    enc->rb->buff[enc->code_idx] = enc->code;
+    enc->code_idx = enc->idx;
+    enc->idx = (enc->idx + 1U) == enc->rb->size ? 0 : (enc->idx + 1U);
+    enc->code = 1;
+    ++enc->len;
+}
+
+/**
+ * \brief           Start COBS encoding at buffer index
+ * \param[in]       enc: Encoder instance
+ * \param[in]       rb: Ring buffer instance
+ * \param[in]       idx: Index in buffer memory to start writing at
+ */
+static void
+prv_cobs_enc_init(prv_cobs_enc_t* enc, lwrb_t* rb, size_t idx) {
+    enc->rb = rb;
+    enc->code_idx = idx;
+    enc->idx = (idx + 1U) == rb->size ? 0 : (idx + 1U);
+    enc->code = 1;
+    enc->len = 1;
+}
+
+/**
+ * \brief           Encode data with COBS.
+ *                  Bytes between zeros are copied to the buffer in bulk
+ * \param[in]       enc: Encoder instance
+ * \param[in]       data: Data to encode
+ * \param[in]       len: Number of bytes to encode
+ */
+static void
+prv_cobs_enc_put(prv_cobs_enc_t* enc, const void* data, size_t len) {
+    const uint8_t* d = data;
+
+    while (len > 0) {
+        const uint8_t* zero;
+        size_t run;
+
+        if (*d == 0x00) {
+            prv_cobs_enc_block(enc);
+            ++d;
+            --len;
+            continue;
+        }
+        run = LWPKT_MIN(len, (size_t)(0xFFU - enc->code));
+        zero = memchr(d, 0x00, run);
+        if (zero != NULL) {
+            run = (size_t)(zero - d);
+        }
+        enc->idx = prv_rb_put(enc->rb, enc->idx, d, run);
+        enc->code += (uint8_t)run;
+        enc->len += run;
+        d += run;
+        len -= run;
+        if (enc->code == 0xFFU) {
+            prv_cobs_enc_block(enc);
+        }
+    }
+}
+
+/**
+ * \brief           Finish COBS encoding and write delimiter
+ * \param[in]       enc: Encoder instance
+ * \return          Number of bytes written to the buffer
+ */
+static size_t
+prv_cobs_enc_finish(prv_cobs_enc_t* enc) {
+    enc->rb->buff[enc->code_idx] = enc->code;
+    enc->rb->buff[enc->idx] = LWPKT_COBS_DELIM;
+    return enc->len + 1U;
+}
+
+#endif /* LWPKT_CFG_USE_COBS */
+
+#if LWPKT_CFG_RX_FILTER
+
+/**
+ * \brief           Check received packet header against receive filter
+ * \param[in]       pkt: Packet instance
+ * \return          `1` if packet is accepted, `0` otherwise
+ */
+static uint8_t
+prv_rx_filter_accept(lwpkt_t* pkt) {
+    const lwpkt_filter_t* filter = pkt->filter;
+
+    if (filter == NULL) {
+        return 1;
+    }
+#if LWPKT_CFG_USE_ADDR
+    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_ADDR, LWPKT_FLAG_USE_ADDR)
+        && !(filter->broadcast && pkt->m.to == LWPKT_CFG_ADDR_BROADCAST)
+        && ((pkt->m.to ^ pkt->addr) & filter->addr_mask) != 0) {
+        return 0;
+    }
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_CMD
+    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CMD, LWPKT_FLAG_USE_CMD) && filter->cmd != NULL) {
+        size_t idx;
+
+        for (idx = 0; idx < filter->cmd_cnt && filter->cmd[idx] != pkt->m.cmd; ++idx) {}
+        if (idx == filter->cmd_cnt) {
+            return 0;
+        }
+    }
+#endif /* LWPKT_CFG_USE_CMD */
+    return 1;
+}
+
+#endif /* LWPKT_CFG_RX_FILTER */
+
+/**
+ * \brief           Single function to define steps between packet states
+ *
+ * Next state is taken from the packet layout, prepared for enabled features.
+ * Data state is skipped, when packet has no data.
+ * Packet, not accepted by receive filter, continues with skipping data and CRC.
+ *
+ * \param           pkt: Packet handle
+ */
+static void
+prv_go_to_next_packet_rx_state(lwpkt_t* pkt) {
+    const lwpkt_layout_t* layout = LAYOUT(pkt);
+    lwpkt_state_t next_state;
+
+    if (pkt->m.state >= LWPKT_STATE_END) {
+        return;
+    }
+    next_state = (lwpkt_state_t)layout->next[pkt->m.state];
+#if LWPKT_CFG_TRACE
+    if (pkt->m.state == LWPKT_STATE_LEN) {
+        TRACE_STAGE(pkt, hdr, LWPKT_TRACE_STAGE_HDR);
+        pkt->trace.cur.len = (uint32_t)pkt->m.len;
+        if (pkt->m.len == 0) {
+            pkt->trace.cur.data = pkt->trace.cur.hdr;
+            pkt->trace.cur.stages |= LWPKT_TRACE_STAGE_DATA;
+        }
+    } else if (pkt->m.state == LWPKT_STATE_DATA) {
+        TRACE_STAGE(pkt, data, LWPKT_TRACE_STAGE_DATA);
+    }
+#endif /* LWPKT_CFG_TRACE */
+#if LWPKT_CFG_RX_FILTER
+    if (pkt->m.state == LWPKT_STATE_LEN && !prv_rx_filter_accept(pkt)) {
+        pkt->m.filtered = 1;
+        next_state = (pkt->m.len + CRC_LEN_USED(pkt)) > 0 ? LWPKT_STATE_DATA : LWPKT_STATE_STOP;
+        LWPKT_SET_STATE(pkt, next_state);
+        return;
+    }
+#endif /* LWPKT_CFG_RX_FILTER */
+    if (next_state == LWPKT_STATE_DATA && pkt->m.len == 0) {
+        next_state = (lwpkt_state_t)layout->next[LWPKT_STATE_DATA];
+    }
+    LWPKT_SET_STATE(pkt, next_state);
+}
+
+/**
+ * \brief           Mark bytes in RX buffer as read
+ * \param[in]       pkt: Packet instance
+ * \param[in]       len: Number of bytes to release
+ */
+static void
+prv_rx_skip(lwpkt_t* pkt, size_t len) {
+    lwrb_skip(pkt->rx_rb, len);
+    pkt->rx_cnt += len;
+    STATS_ADD(pkt, rx_bytes, len);
+}
+
+/**
+ * \brief           Get linear block of RX buffer data, starting at offset from read pointer
+ * \param[in]       pkt: Packet instance
+ * \param[in]       off: Offset from read pointer in units of bytes
+ * \param[out]      len: Output variable to write length of linear block
+ * \return          Pointer to first byte of block, `NULL` if there are no data at offset
+ */
+static const uint8_t*
+prv_rx_block(lwpkt_t* pkt, size_t off, size_t* len) {
+    const uint8_t* addr;
+    size_t full, idx;
+
+    full = lwrb_get_full(pkt->rx_rb);
+    if (off >= full) {
+        *len = 0;
+        return NULL;
+    }
+    addr = lwrb_get_linear_block_read_address(pkt->rx_rb);
+    idx = (size_t)(addr - pkt->rx_rb->buff) + off;
+    if (idx >= pkt->rx_rb->size) {
+        idx -= pkt->rx_rb->size;
+    }
+    *len = LWPKT_MIN(full - off, pkt->rx_rb->size - idx);
+    return &pkt->rx_rb->buff[idx];
+}
+
+/**
+ * \brief           Decode full packet header at once, from first field after start byte until the end of length field
+ * \note            Function is called right after start byte. When header is not complete in the block,
+ *                  nothing is processed and bytes go through the state machine instead
+ * \param[in]       pkt: Packet instance
+ * \param[in]       d: Received bytes, following the start byte
+ * \param[in]       d_len: Number of bytes in `d`
+ * \return          Number of processed header bytes, `0` if header is not complete
+ */
+static size_t
+prv_rx_hdr(lwpkt_t* pkt, const uint8_t* d, size_t d_len) {
+    const lwpkt_layout_t* layout = LAYOUT(pkt);
+    uint32_t val[LWPKT_STATE_LEN + 1] = {0};
+    size_t d_idx = 0, used;
+    uint8_t state;
+
+    /* Decode all fields to local memory first */
+    for (state = pkt->m.state;; state = layout->next[state]) {
+        if (layout->var & LAYOUT_VAR(state)) {
+            used = lwpkt_varint_decode(&d[d_idx], d_len - d_idx, &val[state]);
+        } else {
+            used = d_idx < d_len;
+            val[state] = used ? d[d_idx] : 0;
+        }
+        if (used == 0) {
+            return 0; /* Header not complete yet or field too long */
+        }
+        d_idx += used;
+        if (state == LWPKT_STATE_LEN) {
+            break;
+        }
+    }
+
+    /* Header is complete, continue with data part */
+#if LWPKT_CFG_USE_ADDR
+    pkt->m.from = (lwpkt_addr_t)val[LWPKT_STATE_FROM];
+    pkt->m.to = (lwpkt_addr_t)val[LWPKT_STATE_TO];
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+    pkt->m.flags = val[LWPKT_STATE_FLAGS];
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+    pkt->m.cmd = val[LWPKT_STATE_CMD];
+#endif /* LWPKT_CFG_USE_CMD */
+    pkt->m.len = val[LWPKT_STATE_LEN];
+    ADD_IN_TO_CRC(pkt, &pkt->m.crc, d, d_idx);
+    LWPKT_SET_STATE(pkt, LWPKT_STATE_LEN);
+    prv_go_to_next_packet_rx_state(pkt);
+    return d_idx;
+}
+
+/**
+ * \brief           Process received packet bytes, starting after start byte, with the state machine
+ * \note            Data part is processed in bulk, other fields byte by byte
+ * \param[in]       pkt: Packet instance
+ * \param[in]       d: Received bytes
+ * \param[in]       d_len: Number of bytes in `d`
+ * \param[out]      used: Output variable to write number of processed bytes
+ * \return          \ref lwpktOK when all bytes are processed and packet is not finished yet,
+ *                  \ref lwpktVALID when packet is valid, member of \ref lwpktr_t otherwise
+ */
+static lwpktr_t
+prv_rx_input(lwpkt_t* pkt, const uint8_t* d, size_t d_len, size_t* used) {
+    lwpktr_t res = lwpktOK;
+    size_t d_idx = 0;
+    uint8_t b;
+
+    while (res == lwpktOK && d_idx < d_len) {
+#if LWPKT_CFG_USE_COBS
+        /* There is no stop byte in COBS frame, packet ends with delimiter */
+        if (pkt->m.state == LWPKT_STATE_STOP
+            && CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_COBS, LWPKT_FLAG_USE_COBS)) {
+            break;
+        }
+#endif /* LWPKT_CFG_USE_COBS */
+#if LWPKT_CFG_RX_FILTER
+        /* Data and CRC of filtered packet are skipped, only stop byte is checked */
+        if (pkt->m.filtered) {
+            if (pkt->m.state == LWPKT_STATE_START) {
+                break; /* Filtered packet finished, start byte search continues */
+            }
+            if (pkt->m.state == LWPKT_STATE_DATA) {
+                size_t len = LWPKT_MIN(d_len - d_idx, pkt->m.len + CRC_LEN_USED(pkt) - pkt->m.index);
+
+                pkt->m.index += len;
+                d_idx += len;
+                if (pkt->m.index == pkt->m.len + CRC_LEN_USED(pkt)) {
+                    LWPKT_SET_STATE(pkt, LWPKT_STATE_STOP);
                 }
+                continue;
+            }
+        }
+#endif /* LWPKT_CFG_RX_FILTER */
+#if LWPKT_CFG_USE_RX_STREAM
+        /* Data part that cannot be stored is passed to application in fragments, directly from the buffer */
+        if (pkt->m.state == LWPKT_STATE_DATA && (pkt->m.stream.active || !RX_DATA_FITS(pkt))) {
+            size_t len = LWPKT_MIN(d_len - d_idx, pkt->m.len - pkt->m.index);
+
+            if (!pkt->m.stream.active) {
+                pkt->m.stream.active = 1;
+                SEND_EVT(pkt, LWPKT_EVT_STREAM_START);
+            }
+            ADD_IN_TO_CRC(pkt, &pkt->m.crc, &d[d_idx], len);
+            pkt->m.stream.data = &d[d_idx];
+            pkt->m.stream.len = len;
+            pkt->m.stream.offset = pkt->m.index;
+            SEND_EVT(pkt, LWPKT_EVT_STREAM_DATA);
+            pkt->m.index += len;
+            d_idx += len;
+            if (pkt->m.index == pkt->m.len) {
+                prv_go_to_next_packet_rx_state(pkt);
+            }
+            break; /* Caller must see active stream, before CRC may end it in the same block */
+        }
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+
+#if LWPKT_CFG_RX_ZERO_COPY
+        /* Data part is processed directly in the buffer */
+        if (pkt->m.state == LWPKT_STATE_DATA) {
+            break;
+        }
+#else  /* LWPKT_CFG_RX_ZERO_COPY */
+        /* Copy and calculate CRC for the longest available part of data */
+        if (pkt->m.state == LWPKT_STATE_DATA) {
+            size_t len;
+
+            if (!RX_DATA_FITS(pkt)) {
+                LWPKT_RESET(pkt);
+                res = lwpktERRMEM;
                 break;
             }
+            len = LWPKT_MIN(d_len - d_idx, pkt->m.len - pkt->m.index);
+#if LWPKT_CFG_RX_QUEUE
+            /* Without free slot at the start of data part, packet is received, but not stored */
+            if (pkt->m.index == 0 && lwpkt_rxq_get_count(pkt) == LWPKT_CFG_RX_QUEUE) {
+                pkt->m.drop = 1;
+            }
+            if (!pkt->m.drop)
+#endif /* LWPKT_CFG_RX_QUEUE */
+            {
+                LWPKT_MEMCPY(&RX_DATA_BUF(pkt)[pkt->m.index], &d[d_idx], len);
+            }
+            ADD_IN_TO_CRC(pkt, &pkt->m.crc, &d[d_idx], len);
+            pkt->m.index += len;
+            d_idx += len;
+            if (pkt->m.index == pkt->m.len) {
+                prv_go_to_next_packet_rx_state(pkt);
+            }
+            continue;
+        }
+#endif /* !LWPKT_CFG_RX_ZERO_COPY */
+
+        /* Others are processed byte by byte */
+        b = d[d_idx++];
+        switch (pkt->m.state) {
 #if LWPKT_CFG_USE_ADDR
             case LWPKT_STATE_FROM: {
                 ADD_IN_TO_CRC(pkt, &pkt->m.crc, &b, 1);
 
-                if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_ADDR_EXTENDED, LWPKT_FLAG_ADDR_EXTENDED)) {
-                    pkt->m.from |= (uint8_t)(b & 0x7FU) << ((size_t)7U * (size_t)pkt->m.index++);
+                if (LAYOUT_IS_VAR(pkt, LWPKT_STATE_FROM)) {
+                    pkt->m.from = (lwpkt_addr_t)lwpkt_varint_add(pkt->m.from, b, pkt->m.index++);
                 } else {
                     pkt->m.from = b;
                 }
-                if (!CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_ADDR_EXTENDED, LWPKT_FLAG_ADDR_EXTENDED)
-                    || (b & 0x80U) == 0x00) {
+                if (!LAYOUT_IS_VAR(pkt, LWPKT_STATE_FROM) || (b & 0x80U) == 0x00) {
                     prv_go_to_next_packet_rx_state(pkt);
                 }
                 break;
@@ -410,13 +1645,12 @@ lwpkt_read(lwpkt_t* pkt) {
             case LWPKT_STATE_TO: {
                 ADD_IN_TO_CRC(pkt, &pkt->m.crc, &b, 1);
 
-                if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_ADDR_EXTENDED, LWPKT_FLAG_ADDR_EXTENDED)) {
-                    pkt->m.to |= (uint8_t)(b & 0x7FU) << ((size_t)7U * (size_t)pkt->m.index++);
+                if (LAYOUT_IS_VAR(pkt, LWPKT_STATE_TO)) {
+                    pkt->m.to = (lwpkt_addr_t)lwpkt_varint_add(pkt->m.to, b, pkt->m.index++);
                 } else {
                     pkt->m.to = b;
                 }
-                if (!CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_ADDR_EXTENDED, LWPKT_FLAG_ADDR_EXTENDED)
-                    || (b & 0x80U) == 0x00) {
+                if (!LAYOUT_IS_VAR(pkt, LWPKT_STATE_TO) || (b & 0x80U) == 0x00) {
                     prv_go_to_next_packet_rx_state(pkt);
                 }
                 break;
@@ -426,7 +1660,7 @@ lwpkt_read(lwpkt_t* pkt) {
             case LWPKT_STATE_FLAGS: {
                 ADD_IN_TO_CRC(pkt, &pkt->m.crc, &b, 1U);
 
-                pkt->m.flags |= (b & 0x7FU) << ((size_t)7U * (size_t)pkt->m.index++);
+                pkt->m.flags = lwpkt_varint_add(pkt->m.flags, b, pkt->m.index++);
                 if ((b & 0x80U) == 0) {
                     prv_go_to_next_packet_rx_state(pkt);
                 }
@@ -437,13 +1671,12 @@ lwpkt_read(lwpkt_t* pkt) {
             case LWPKT_STATE_CMD: {
                 ADD_IN_TO_CRC(pkt, &pkt->m.crc, &b, 1);
 
-                if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CMD_EXTENDED, LWPKT_FLAG_CMD_EXTENDED)) {
-                    pkt->m.cmd |= (uint8_t)(b & 0x7FU) << ((size_t)7U * (size_t)pkt->m.index++);
+                if (LAYOUT_IS_VAR(pkt, LWPKT_STATE_CMD)) {
+                    pkt->m.cmd = lwpkt_varint_add(pkt->m.cmd, b, pkt->m.index++);
                 } else {
                     pkt->m.cmd = b;
                 }
-                if (!CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CMD_EXTENDED, LWPKT_FLAG_CMD_EXTENDED)
-                    || (b & 0x80U) == 0x00) {
+                if (!LAYOUT_IS_VAR(pkt, LWPKT_STATE_CMD) || (b & 0x80U) == 0x00) {
                     prv_go_to_next_packet_rx_state(pkt);
                 }
                 break;
@@ -452,275 +1685,1578 @@ lwpkt_read(lwpkt_t* pkt) {
             case LWPKT_STATE_LEN: {
                 ADD_IN_TO_CRC(pkt, &pkt->m.crc, &b, 1U);
 
-                pkt->m.len |= (b & 0x7FU) << ((size_t)7U * (size_t)pkt->m.index++);
-                if ((b & 0x80U) == 0) {
-                    prv_go_to_next_packet_rx_state(pkt);
-                }
-                break;
-            }
-            case LWPKT_STATE_DATA: {
-                if (pkt->m.index < sizeof(pkt->data)) {
-                    pkt->data[pkt->m.index++] = b;
-                    ADD_IN_TO_CRC(pkt, &pkt->m.crc, &b, 1U);
-                    if (pkt->m.index == pkt->m.len) {
-                        prv_go_to_next_packet_rx_state(pkt);
-                    }
-                } else {
-                    LWPKT_RESET(pkt);
-                    res = lwpktERRMEM;
-                    goto retpre;
-                }
-                break;
-            }
-#if LWPKT_CFG_USE_CRC
-            case LWPKT_STATE_CRC: {
-                if (pkt->m.index < CRC_DATA_LEN(pkt)) {
-                    pkt->m.crc_data |= b << (8 * pkt->m.index);
-                    ++pkt->m.index;
-                }
+                pkt->m.len = lwpkt_varint_add((uint32_t)pkt->m.len, b, pkt->m.index++);
+                if ((b & 0x80U) == 0) {
+                    prv_go_to_next_packet_rx_state(pkt);
+                }
+                break;
+            }
+#if LWPKT_CFG_USE_CRC
+            case LWPKT_STATE_CRC: {
+                if (pkt->m.index < CRC_LEN_USED(pkt)) {
+                    pkt->m.crc_data |= (uint32_t)b << (8U * pkt->m.index);
+                    ++pkt->m.index;
+                }
+
+                /* Check if we received all CRC bytes */
+                if (pkt->m.index == CRC_LEN_USED(pkt)) {
+                    uint32_t crc = prv_crc_finish(pkt, &pkt->m.crc);
+
+                    /* Check if calculated CRC matches the received data */
+                    if (crc == pkt->m.crc_data) {
+                        LWPKT_SET_STATE(pkt, LWPKT_STATE_STOP);
+                    } else {
+                        RX_STREAM_END(pkt, lwpktERRCRC);
+                        LWPKT_RESET(pkt);
+                        res = lwpktERRCRC;
+                    }
+                }
+                break;
+            }
+#endif /* LWPKT_CFG_USE_CRC */
+            case LWPKT_STATE_STOP: {
+                prv_go_to_next_packet_rx_state(pkt);
+                if (b == LWPKT_STOP_BYTE) {
+                    res = lwpktVALID; /* Packet fully valid, take data from it */
+                } else {
+                    res = lwpktERRSTOP; /* Packet is missing STOP byte! */
+                }
+#if LWPKT_CFG_RX_FILTER
+                if (pkt->m.filtered && res == lwpktVALID) {
+                    STATS_ADD(pkt, rx_filtered, 1);
+                    res = lwpktOK; /* Packet is not reported to application */
+                }
+#endif /* LWPKT_CFG_RX_FILTER */
+                RX_STREAM_END(pkt, res);
+                break;
+            }
+            default: {
+                LWPKT_RESET(pkt);
+                res = lwpktERR; /* Hard error */
+                break;
+            }
+        }
+    }
+    *used = d_idx;
+    return res;
+}
+
+#if LWPKT_CFG_USE_COBS
+
+/**
+ * \brief           Decode COBS framed bytes and process them with the state machine.
+ *                  Bytes of each COBS block are processed in bulk
+ * \param[in]       pkt: Packet instance
+ * \param[in]       d: Received bytes
+ * \param[in]       d_len: Number of bytes in `d`
+ * \param[out]      used: Output variable to write number of processed bytes
+ * \return          \ref lwpktOK when packet is not finished yet,
+ *                  \ref lwpktVALID when packet is valid, member of \ref lwpktr_t otherwise
+ */
+static lwpktr_t
+prv_rx_cobs(lwpkt_t* pkt, const uint8_t* d, size_t d_len, size_t* used) {
+    static const uint8_t zero = 0x00;
+    lwpktr_t res = lwpktOK;
+    size_t d_idx = 0, len;
+    uint8_t code;
+
+    /* After invalid packet, ignore everything until delimiter */
+    if (pkt->m.cobs.skip) {
+        const uint8_t* delim = memchr(d, LWPKT_COBS_DELIM, d_len);
+        if (delim == NULL) {
+            *used = d_len;
+        } else {
+            *used = (size_t)(delim - d) + 1U;
+            pkt->m.cobs.skip = 0;
+        }
+        STATS_ADD(pkt, rx_skipped, *used);
+        return lwpktOK;
+    }
+
+    /* Process data bytes of current block, delimiter inside block ends the packet */
+    if (pkt->m.cobs.run > 0) {
+        const uint8_t* delim;
+
+        len = LWPKT_MIN(d_len, (size_t)pkt->m.cobs.run);
+        delim = memchr(d, LWPKT_COBS_DELIM, len);
+        if (delim != NULL) {
+            len = (size_t)(delim - d);
+        }
+        if (len > 0) {
+            if (pkt->m.state == LWPKT_STATE_STOP) {
+                res = lwpktERRSTOP; /* More data than expected */
+            } else {
+                res = prv_rx_input(pkt, d, len, &d_idx);
+                pkt->m.cobs.run -= (uint8_t)d_idx;
+            }
+            goto result;
+        }
+    }
+
+    code = d[d_idx++];
+    if (code == LWPKT_COBS_DELIM) {
+        /* Delimiter: end of current packet and start of next one */
+        if (pkt->m.state != LWPKT_STATE_START) {
+            /* Packet too short, if delimiter is received before all fields */
+            res = (pkt->m.state == LWPKT_STATE_STOP && pkt->m.cobs.run == 0) ? lwpktVALID : lwpktERRSTOP;
+            RX_STREAM_END(pkt, res);
+            if (res == lwpktVALID) {
+                LWPKT_SET_STATE(pkt, LWPKT_STATE_START);
+            } else {
+                LWPKT_RESET(pkt);
+            }
+#if LWPKT_CFG_RX_FILTER
+            if (pkt->m.filtered && res == lwpktVALID) {
+                STATS_ADD(pkt, rx_filtered, 1);
+                res = lwpktOK; /* Packet is not reported to application */
+            }
+#endif /* LWPKT_CFG_RX_FILTER */
+        }
+        *used = d_idx;
+        return res;
+    }
+    if (pkt->m.state == LWPKT_STATE_START) {
+        LWPKT_RESET(pkt); /* First code byte of new packet */
+        TRACE_BEGIN(pkt);
+        INIT_CRC(pkt, &pkt->m.crc);
+        prv_go_to_next_packet_rx_state(pkt);
+    } else if (pkt->m.cobs.zero) {
+        /* Zero byte between previous and new block */
+        if (pkt->m.state == LWPKT_STATE_STOP) {
+            res = lwpktERRSTOP;
+        } else {
+            res = prv_rx_input(pkt, &zero, 1, &len);
+        }
+    }
+    pkt->m.cobs.run = code - 1U;
+    pkt->m.cobs.zero = code != 0xFFU;
+
+result:
+    if (res != lwpktOK) {
+        /* Invalid packet in the middle of the frame, wait for next delimiter */
+        RX_STREAM_END(pkt, res);
+        LWPKT_RESET(pkt);
+        pkt->m.cobs.skip = 1;
+    }
+    *used = d_idx;
+    return res;
+}
+
+#endif /* LWPKT_CFG_USE_COBS */
+
+#if LWPKT_CFG_RX_ZERO_COPY
+
+/**
+ * \brief           Process data part of the packet directly in the RX buffer, without copying it
+ * \note            Function is called in data state, header bytes are released only when packet is valid
+ * \param[in]       pkt: Packet instance
+ * \param[in]       hdr_len: Number of header bytes still kept in the buffer
+ * \return          \ref lwpktVALID when packet is valid and view is ready,
+ *                  \ref lwpktINPROG when waiting for more data, member of \ref lwpktr_t otherwise
+ */
+static lwpktr_t
+prv_rx_zero_copy(lwpkt_t* pkt, size_t hdr_len) {
+    uint8_t trailer[5];
+    size_t trailer_len, frame_len, lin_len;
+
+    trailer_len = CRC_LEN_USED(pkt) + 1U;
+    frame_len = pkt->m.len + trailer_len;
+
+    /* Full packet, from data part until stop byte, must fit to the buffer */
+    if ((hdr_len + frame_len) >= pkt->rx_rb->size) {
+        LWPKT_RESET(pkt);
+        return lwpktERRMEM;
+    }
+    if (lwrb_get_full(pkt->rx_rb) < (hdr_len + frame_len)) {
+        return lwpktINPROG;
+    }
+    TRACE_STAGE(pkt, data, LWPKT_TRACE_STAGE_DATA);
+
+    /* Data may be split in 2 parts, when they wrap around end of the buffer */
+    pkt->m.view[0].data = prv_rx_block(pkt, hdr_len, &lin_len);
+    pkt->m.view[0].len = LWPKT_MIN(lin_len, pkt->m.len);
+    pkt->m.view[1].len = pkt->m.len - pkt->m.view[0].len;
+    pkt->m.view[1].data = pkt->m.view[1].len > 0 ? pkt->rx_rb->buff : NULL;
+    lwrb_peek(pkt->rx_rb, hdr_len + pkt->m.len, trailer, trailer_len);
+
+#if LWPKT_CFG_USE_CRC
+    if (CRC_LEN_USED(pkt) > 0) {
+        ADD_IN_TO_CRC(pkt, &pkt->m.crc, pkt->m.view[0].data, pkt->m.view[0].len);
+        ADD_IN_TO_CRC(pkt, &pkt->m.crc, pkt->m.view[1].data, pkt->m.view[1].len);
+        for (size_t i = 0; i < CRC_LEN_USED(pkt); ++i) {
+            pkt->m.crc_data |= (uint32_t)trailer[i] << (8U * i);
+        }
+        if (prv_crc_finish(pkt, &pkt->m.crc) != pkt->m.crc_data) {
+            LWPKT_RESET(pkt);
+            return lwpktERRCRC;
+        }
+    }
+#endif /* LWPKT_CFG_USE_CRC */
+    if (trailer[trailer_len - 1U] != LWPKT_STOP_BYTE) {
+        LWPKT_RESET(pkt);
+        return lwpktERRSTOP;
+    }
+
+    /* Keep packet information, data are released on next read */
+    prv_rx_skip(pkt, hdr_len);
+    pkt->m.view_hold = frame_len;
+    LWPKT_SET_STATE(pkt, LWPKT_STATE_START);
+    return lwpktVALID;
+}
+
+#endif /* LWPKT_CFG_RX_ZERO_COPY */
+
+/**
+ * \brief           Initialize packet instance and set device address
+ * \param[in]       pkt: Packet instance
+ * \param[in]       tx_rb: TX LwRB instance for data write
+ * \param[in]       rx_rb: RX LwRB instance for data read
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_init(lwpkt_t* pkt, lwrb_t* tx_rb, lwrb_t* rx_rb) {
+    if (pkt == NULL) {
+        return lwpktERR;
+    }
+
+    LWPKT_MEMSET(pkt, 0x00, sizeof(*pkt));
+    LWPKT_RESET(pkt);
+#if LWPKT_CFG_USE_CRC && LWPKT_CFG_CRC_TABLE == 2
+    prv_crc_tables_init();
+#endif /* LWPKT_CFG_USE_CRC && LWPKT_CFG_CRC_TABLE == 2 */
+
+    pkt->tx_rb = tx_rb;
+    pkt->rx_rb = rx_rb;
+    pkt->timeout = LWPKT_CFG_PROCESS_INPROG_TIMEOUT;
+#if LWPKT_CFG_TX_MPSC
+    if (tx_rb != NULL && tx_rb->size > (TX_CLAIM_IDX_MASK + 1U)) {
+        return lwpktERR; /* Buffer index must fit to the state word */
+    }
+    atomic_init(&pkt->tx_claim, 0);
+#endif /* LWPKT_CFG_TX_MPSC */
+    pkt->flags |= 0xFFU; /* By default enable all dynamically enabled features */
+#if LWPKT_CFG_USE_COBS == 2
+    pkt->flags &= (uint8_t)~LWPKT_FLAG_USE_COBS; /* Except COBS framing, it changes packet format */
+#endif /* LWPKT_CFG_USE_COBS == 2 */
+    LAYOUT_UPDATE(pkt);
+
+    return lwpktOK;
+}
+
+#if LWPKT_CFG_RX_DATA_EXT || __DOXYGEN__
+
+/**
+ * \brief           Initialize packet instance with memory for received data
+ * \note            This function is only available, if \ref LWPKT_CFG_RX_DATA_EXT is enabled
+ * \note            Packets with data part longer than `rx_data_size` are dropped with \ref lwpktERRMEM,
+ *                  or passed to the application in fragments, when \ref LWPKT_CFG_USE_RX_STREAM is enabled
+ * \param[in]       pkt: Packet instance
+ * \param[in]       tx_rb: TX LwRB instance for data write
+ * \param[in]       rx_rb: RX LwRB instance for data read
+ * \param[in]       rx_data: Memory for data part of received packet. It must stay valid for the instance lifetime
+ * \param[in]       rx_data_size: Size of `rx_data` memory in units of bytes
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_init_ex(lwpkt_t* pkt, lwrb_t* tx_rb, lwrb_t* rx_rb, void* rx_data, size_t rx_data_size) {
+    lwpktr_t res;
+
+    if (rx_data == NULL && rx_data_size > 0) {
+        return lwpktERR;
+    }
+    res = lwpkt_init(pkt, tx_rb, rx_rb);
+    if (res == lwpktOK) {
+        pkt->data = rx_data;
+        pkt->data_size = rx_data_size;
+    }
+    return res;
+}
+
+#endif /* LWPKT_CFG_RX_DATA_EXT || __DOXYGEN__ */
+
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+
+/**
+ * \brief           Set device address for packet instance
+ * \param[in]       pkt: Packet instance
+ * \param[in]       addr: New device address
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_set_addr(lwpkt_t* pkt, lwpkt_addr_t addr) {
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+    pkt->addr = addr;
+
+    return lwpktOK;
+}
+
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+
+#if LWPKT_CFG_TRACE
+
+/**
+ * \brief           Put current trace record to the trace, if packet result is known
+ * \param[in]       pkt: Packet instance
+ */
+static void
+prv_trace_commit(lwpkt_t* pkt) {
+    unsigned long w;
+
+    pkt->trace.defer = 0;
+    if (!(pkt->trace.cur.stages & LWPKT_TRACE_STAGE_VERDICT)) {
+        return;
+    }
+    if (lwpkt_trace_get_count(pkt) == LWPKT_CFG_TRACE) {
+        ++pkt->trace.lost;
+    } else {
+        w = QUEUE_LOAD(pkt->trace.w, memory_order_relaxed);
+        pkt->trace.rec[w % LWPKT_CFG_TRACE] = pkt->trace.cur;
+        QUEUE_STORE(pkt->trace.w, (w + 1U) % TRACE_CNT_MOD, memory_order_release);
+    }
+    pkt->trace.cur.stages = 0;
+}
+
+/**
+ * \brief           Set result of current trace record.
+ *                  Record is put to the trace immediately, unless it waits for event dispatch
+ * \param[in]       pkt: Packet instance
+ * \param[in]       res: Packet result
+ */
+static void
+prv_trace_end(lwpkt_t* pkt, lwpktr_t res) {
+    if (!(pkt->trace.cur.stages & LWPKT_TRACE_STAGE_START)) {
+        return; /* No packet has been started */
+    }
+    TRACE_STAGE(pkt, verdict, LWPKT_TRACE_STAGE_VERDICT);
+    pkt->trace.cur.res = (uint8_t)res;
+    if (!pkt->trace.defer) {
+        prv_trace_commit(pkt);
+    }
+}
+
+#endif /* LWPKT_CFG_TRACE */
+
+#if LWPKT_CFG_RX_QUEUE
+
+/**
+ * \brief           Put valid packet to the receive queue.
+ *                  Data are already in the slot, header fields are copied to it
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktVALID on success, \ref lwpktERRMEM if packet has been dropped
+ */
+static lwpktr_t
+prv_rxq_put(lwpkt_t* pkt) {
+    lwpkt_rx_slot_t* slot;
+    unsigned long w;
+
+#if LWPKT_CFG_USE_RX_STREAM
+    if (pkt->m.stream.active) {
+        return lwpktVALID; /* Stream packet has been passed to application with events */
+    }
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+    if (pkt->m.drop || lwpkt_rxq_get_count(pkt) == LWPKT_CFG_RX_QUEUE) {
+        ++pkt->rxq.overflow;
+        return lwpktERRMEM;
+    }
+    w = QUEUE_LOAD(pkt->rxq.w, memory_order_relaxed);
+    slot = &pkt->rxq.slot[w % LWPKT_CFG_RX_QUEUE];
+#if LWPKT_CFG_USE_ADDR
+    slot->from = pkt->m.from;
+    slot->to = pkt->m.to;
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+    slot->flags = pkt->m.flags;
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+    slot->cmd = pkt->m.cmd;
+#endif /* LWPKT_CFG_USE_CMD */
+    slot->len = pkt->m.len;
+    QUEUE_STORE(pkt->rxq.w, (w + 1U) % RXQ_CNT_MOD, memory_order_release);
+    return lwpktVALID;
+}
+
+#endif /* LWPKT_CFG_RX_QUEUE */
+
+/**
+ * \brief           Read raw data from RX ring buffer, parse the characters
+ *                  and try to construct the receive packet
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktVALID when packet valid, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_read(lwpkt_t* pkt) {
+    lwpktr_t res = lwpktOK;
+    const uint8_t* d;
+    size_t d_len, d_idx, d_sync, used, off = 0;
+    uint8_t e = 0, hold = 0;
+
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+
+    SEND_EVT(pkt, LWPKT_EVT_PRE_READ);
+    STATS_CYCLES_BEGIN(cycles);
+    STATS_MAX(pkt, rx_rb_max, lwrb_get_full(pkt->rx_rb));
+#if LWPKT_CFG_RX_RESYNC
+    off = pkt->rx_hold.off;
+    hold = pkt->rx_hold.hold;
+#endif /* LWPKT_CFG_RX_RESYNC */
+
+#if LWPKT_CFG_RX_ZERO_COPY
+    /* Previous packet is not used anymore */
+    lwpkt_release_view(pkt);
+#endif /* LWPKT_CFG_RX_ZERO_COPY */
+
+    /*
+     * Process bytes from RX ringbuffer in linear blocks.
+     *
+     * Start byte search and data part are processed in bulk,
+     * other fields go byte by byte through the state machine.
+     * Processed bytes are marked as read once per block.
+     *
+     * In resync mode, bytes of current packet stay in the buffer (hold),
+     * "off" is number of processed bytes from the read pointer.
+     */
+    while (res == lwpktOK && (d = prv_rx_block(pkt, off, &d_len)) != NULL) {
+        d_idx = 0;
+        d_sync = 0;
+        e = 1;
+        while (res == lwpktOK && d_idx < d_len) {
+#if LWPKT_CFG_USE_COBS
+            /* Packets are separated with delimiters, start and stop bytes are not used */
+            if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_COBS, LWPKT_FLAG_USE_COBS)) {
+                res = prv_rx_cobs(pkt, &d[d_idx], d_len - d_idx, &used);
+                d_idx += used;
+                continue;
+            }
+#endif /* LWPKT_CFG_USE_COBS */
+
+            /* Scan for start byte, ignore everything else */
+            if (pkt->m.state == LWPKT_STATE_START) {
+                const uint8_t* start = memchr(&d[d_idx], LWPKT_START_BYTE, d_len - d_idx);
+                if (start == NULL) {
+                    STATS_ADD(pkt, rx_skipped, d_len - d_idx);
+                    d_idx = d_len;
+                } else {
+                    /* Release everything before start byte */
+                    STATS_ADD(pkt, rx_skipped, (size_t)(start - d) - d_idx);
+                    d_idx = (size_t)(start - d);
+                    prv_rx_skip(pkt, off + d_idx - d_sync);
+                    off = 0;
+                    d_sync = d_idx++;
+                    hold = LWPKT_CFG_RX_RESYNC;
+                    LWPKT_RESET(pkt); /* Reset instance and make it ready for receiving */
+                    TRACE_BEGIN(pkt);
+                    INIT_CRC(pkt, &pkt->m.crc);
+                    prv_go_to_next_packet_rx_state(pkt);
+                    d_idx += prv_rx_hdr(pkt, &d[d_idx], d_len - d_idx);
+                }
+                continue;
+            }
+
+#if LWPKT_CFG_RX_ZERO_COPY
+            /* Data stay in the buffer, header bytes are released once packet is valid */
+            if (pkt->m.state == LWPKT_STATE_DATA
+#if LWPKT_CFG_USE_RX_STREAM
+                && !pkt->m.stream.active && RX_DATA_FITS(pkt)
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+#if LWPKT_CFG_RX_FILTER
+                && !pkt->m.filtered
+#endif /* LWPKT_CFG_RX_FILTER */
+            ) {
+                off += d_idx - d_sync;
+                d_sync = d_idx;
+                if (!hold || (off + pkt->m.len + CRC_LEN_USED(pkt) + 1U) >= pkt->rx_rb->size) {
+                    prv_rx_skip(pkt, off); /* Release header, packet cannot be scanned again */
+                    off = 0;
+                    hold = 0;
+                }
+                res = prv_rx_zero_copy(pkt, off);
+                if (res == lwpktVALID) {
+                    off = 0;
+                }
+                break;
+            }
+#endif /* LWPKT_CFG_RX_ZERO_COPY */
+
+            res = prv_rx_input(pkt, &d[d_idx], d_len - d_idx, &used);
+            d_idx += used;
+#if LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_RX_STREAM
+            if (pkt->m.stream.active) {
+                hold = 0; /* Data are passed to application, packet cannot be scanned again */
+            }
+#endif /* LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_RX_STREAM */
+        }
+
+        off += d_idx - d_sync;
+#if LWPKT_CFG_RX_RESYNC
+        if (hold && res != lwpktOK && res != lwpktINPROG) {
+            if (res != lwpktVALID) {
+                off = 1; /* Invalid packet, release only its start byte and scan the rest again */
+                STATS_ADD(pkt, rx_resync, 1);
+            }
+            hold = 0;
+        }
+#if LWPKT_CFG_RX_FILTER
+        if (hold && res == lwpktOK && pkt->m.state == LWPKT_STATE_START) {
+            hold = 0; /* Filtered packet finished */
+        }
+#endif /* LWPKT_CFG_RX_FILTER */
+#endif /* LWPKT_CFG_RX_RESYNC */
+
+        /* Mark processed bytes as read */
+        if (!hold) {
+            prv_rx_skip(pkt, off);
+            off = 0;
+        }
+    }
+#if LWPKT_CFG_RX_RESYNC
+    /* Buffer is full and cannot receive rest of the packet, continue without resync */
+    if (hold && lwrb_get_free(pkt->rx_rb) == 0) {
+        prv_rx_skip(pkt, off);
+        off = 0;
+        hold = 0;
+    }
+    pkt->rx_hold.off = off;
+    pkt->rx_hold.hold = hold;
+#endif /* LWPKT_CFG_RX_RESYNC */
+#if LWPKT_CFG_RX_QUEUE
+    if (res == lwpktVALID) {
+        res = prv_rxq_put(pkt);
+    }
+#endif /* LWPKT_CFG_RX_QUEUE */
+    if (res == lwpktOK || res == lwpktINPROG) {
+        res = (pkt->m.state == LWPKT_STATE_START) ? lwpktWAITDATA : lwpktINPROG;
+    } else {
+        TRACE_END(pkt, res);
+    }
+#if LWPKT_CFG_USE_STATS
+    switch (res) {
+        case lwpktVALID: ++pkt->stats.rx_pkts; break;
+        case lwpktERRCRC: ++pkt->stats.rx_err_crc; break;
+        case lwpktERRSTOP: ++pkt->stats.rx_err_stop; break;
+        case lwpktERRMEM: ++pkt->stats.rx_err_mem; break;
+        case lwpktWAITDATA:
+        case lwpktINPROG: break;
+        default: ++pkt->stats.rx_err; break;
+    }
+#endif /* LWPKT_CFG_USE_STATS */
+    STATS_CYCLES_END(pkt, cycles, read);
+    SEND_EVT(pkt, LWPKT_EVT_POST_READ);
+    if (e) {
+        SEND_EVT(pkt, LWPKT_EVT_READ); /* Send read event */
+    }
+    return res;
+}
+
+/**
+ * \brief           Abort packet in progress, which cannot be finished anymore
+ * \param[in]       pkt: Packet instance
+ * \param[in]       time: Current time
+ */
+static void
+prv_process_abort(lwpkt_t* pkt, uint32_t time) {
+    RX_STREAM_END(pkt, lwpktERR);
+    TRACE_END(pkt, lwpktINPROG);
+    lwpkt_reset(pkt);
+    pkt->last_rx_time = time;
+    TRACE_STAGE(pkt, evt, LWPKT_TRACE_STAGE_EVT);
+    SEND_EVT(pkt, LWPKT_EVT_TIMEOUT);
+}
+
+/**
+ * \brief           Get number of bytes received to RX buffer, free-running counter
+ *
+ * Counter does not repeat, when RX buffer wraps by its size, unlike the buffer write address.
+ *
+ * \param[in]       pkt: Packet instance
+ * \return          Number of bytes read from RX buffer and bytes waiting in RX buffer
+ */
+static size_t
+prv_rx_received(const lwpkt_t* pkt) {
+    return pkt->rx_cnt + lwrb_get_full(pkt->rx_rb);
+}
+
+/**
+ * \brief           Process packet instance and read new data
+ *
+ * Packet in progress is aborted with \ref LWPKT_EVT_TIMEOUT event,
+ * when next byte is not received within instance timeout,
+ * or when all bytes, received before idle line notification, have been processed.
+ *
+ * \param[in]       pkt: Packet instance
+ * \param[in]       time: Current time, in units of the instance timeout
+ * \return          \ref lwpktOK if processing OK, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_process(lwpkt_t* pkt, uint32_t time) {
+    lwpktr_t pktres = lwpktERR;
+    size_t rx, idle_cnt;
+    uint32_t idle_seq;
+    uint8_t idle;
+
+    if (pkt == NULL) {
+        return pktres;
+    }
+
+    /* Sequence number is read first, byte count belongs to the same or newer notification */
+    idle_seq = pkt->rx_idle_seq;
+    idle_cnt = pkt->rx_idle_cnt;
+    idle = idle_seq != pkt->rx_idle_seen;
+
+    /* Packet protocol data read, trace record is finished after event dispatch */
+    TRACE_DEFER(pkt);
+    pktres = lwpkt_read(pkt);
+    rx = prv_rx_received(pkt);
+    if (pktres == lwpktVALID) {
+        pkt->last_rx_time = time;
+#if LWPKT_CFG_USE_RX_STREAM
+        /* Stream packet has already been reported with stream events */
+        if (!pkt->m.stream.active)
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+        {
+            TRACE_STAGE(pkt, evt, LWPKT_TRACE_STAGE_EVT);
+            SEND_EVT(pkt, LWPKT_EVT_PKT);
+        }
+    } else if (pktres == lwpktINPROG) {
+        if (rx != pkt->rx_seen) {
+            pkt->last_rx_time = time; /* New bytes have been received, timeout starts again */
+        }
+        if (idle && idle_cnt == rx) {
+            /* No bytes after idle line, all received bytes are processed */
+            STATS_ADD(pkt, rx_idle, 1);
+            prv_process_abort(pkt, time);
+        } else if ((time - pkt->last_rx_time) >= pkt->timeout) {
+            STATS_ADD(pkt, rx_timeout, 1);
+            prv_process_abort(pkt, time);
+        }
+    } else {
+        pkt->last_rx_time = time;
+    }
+    TRACE_COMMIT(pkt);
+
+    /* Idle line notification is not valid anymore, once new bytes are received */
+    if (idle && idle_cnt != rx) {
+        pkt->rx_idle_seen = idle_seq;
+    }
+    pkt->rx_seen = rx;
+    return pktres;
+}
+
+/**
+ * \brief           Set timeout of packet in progress, used by \ref lwpkt_process function
+ * \param[in]       pkt: Packet instance
+ * \param[in]       timeout: Maximum time between received bytes of the packet,
+ *                      in units of \ref lwpkt_process time argument
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_set_timeout(lwpkt_t* pkt, uint32_t timeout) {
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+    pkt->timeout = timeout;
+    return lwpktOK;
+}
+
+/**
+ * \brief           Notify instance, that RX line is idle, typically from UART idle line interrupt
+ *
+ * Packet, that is still in progress after all bytes received so far are processed,
+ * is aborted on next \ref lwpkt_process call, without waiting for timeout.
+ *
+ * \note            Function can be called from interrupt context, that preempts processing of the instance,
+ *                  after received bytes have been written to RX buffer
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_rx_idle(lwpkt_t* pkt) {
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+    pkt->rx_idle_cnt = prv_rx_received(pkt);
+    pkt->rx_idle_seq = pkt->rx_idle_seq + 1U; /* Published after byte count */
+    return lwpktOK;
+}
+
+/**
+ * \brief           Write packet with data from multiple segments to TX ringbuffer
+ *
+ * Header and trailer are prepared in local memory first,
+ * then full packet is copied to the TX buffer and committed at once.
+ *
+ * \param[in]       pkt: Packet instance
+ * \param[in]       to: End device address. Ignored if addressing is not used
+ * \param[in]       flags: Custom user flags. Ignored if flags are not used
+ * \param[in]       cmd: Packet command. Ignored if command is not used
+ * \param[in]       seg: Array of data segments
+ * \param[in]       seg_cnt: Number of entries in `seg` array
+ * \param[in]       batch: Set to `1` to add packet to current batch, without events and commit
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+static lwpktr_t
+prv_write(lwpkt_t* pkt, uint32_t to, uint32_t flags, uint32_t cmd, const lwpkt_seg_t* seg, size_t seg_cnt,
+          uint8_t batch) {
+    lwpktr_t res = lwpktOK;
+    lwpkt_crc_t crc;
+    uint8_t hdr[LWPKT_HDR_MAX_LEN], trl[LWPKT_TRL_MAX_LEN];
+    size_t hdr_len, trl_len, idx, len = 0;
+
+    if (!LWPKT_IS_VALID(pkt) || (seg == NULL && seg_cnt > 0)) {
+        return lwpktERR;
+    }
+    for (size_t i = 0; i < seg_cnt; ++i) {
+        if (seg[i].data == NULL && seg[i].len > 0) {
+            return lwpktERR;
+        }
+        len += seg[i].len;
+    }
+#if LWPKT_CFG_USE_TX_BATCH
+    /* Single writer owns the buffer until batch is committed, other writers are only allowed in multi-producer mode */
+    if ((batch && !pkt->tx_batch.active) || (!LWPKT_CFG_TX_MPSC && !batch && pkt->tx_batch.active)) {
+        return lwpktERR;
+    }
+#endif /* LWPKT_CFG_USE_TX_BATCH */
+
+    if (!batch) {
+        SEND_EVT(pkt, LWPKT_EVT_PRE_WRITE);
+    }
+    STATS_CYCLES_BEGIN(cycles);
+
+#if LWPKT_CFG_USE_TX_STREAM
+    /* Stream packet must be finished first */
+    if (pkt->tx_stream.active) {
+        res = lwpktERR;
+        goto fast_return;
+    }
+#endif /* LWPKT_CFG_USE_TX_STREAM */
+
+    /* Prepare header and trailer in local memory */
+    hdr_len = prv_hdr_build(pkt, hdr, to, flags, cmd, len);
+#if LWPKT_CFG_USE_CRC
+    if (CRC_LEN_USED(pkt) > 0) {
+        prv_crc_init(pkt, &crc);
+        prv_crc_in(pkt, &crc, &hdr[1], hdr_len - 1U); /* Start byte is not part of CRC */
+        for (size_t i = 0; i < seg_cnt; ++i) {
+            prv_crc_in(pkt, &crc, seg[i].data, seg[i].len);
+        }
+    }
+#endif /* LWPKT_CFG_USE_CRC */
+    trl_len = prv_trl_build(pkt, &crc, trl);
+
+#if LWPKT_CFG_USE_COBS
+    /* Encode all fields, except start and stop bytes, and terminate packet with delimiter */
+    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_COBS, LWPKT_FLAG_USE_COBS)) {
+        prv_cobs_enc_t enc;
+        size_t max_len = LWPKT_COBS_MAX_LEN(hdr_len + len + trl_len - 2U);
+
+        if ((res = prv_tx_claim(pkt, max_len, 0, 0, TX_BATCH_HOLD(pkt, batch), &idx)) != lwpktOK) {
+            goto fast_return;
+        }
+        prv_cobs_enc_init(&enc, pkt->tx_rb, idx);
+        prv_cobs_enc_put(&enc, &hdr[1], hdr_len - 1U);
+        for (size_t i = 0; i < seg_cnt; ++i) {
+            prv_cobs_enc_put(&enc, seg[i].data, seg[i].len);
+        }
+        prv_cobs_enc_put(&enc, trl, trl_len - 1U);
+        len = prv_cobs_enc_finish(&enc);
+#if LWPKT_CFG_TX_MPSC
+        /* Claimed length is fixed, fill the rest with delimiters, ignored by the receiver */
+        for (idx = enc.idx; len < max_len; ++len) {
+            idx = (idx + 1U) == pkt->tx_rb->size ? 0 : (idx + 1U);
+            pkt->tx_rb->buff[idx] = LWPKT_COBS_DELIM;
+        }
+#endif /* LWPKT_CFG_TX_MPSC */
+        prv_tx_finish(pkt, len, batch);
+        goto fast_return;
+    }
+#endif /* LWPKT_CFG_USE_COBS */
+
+    /* Claim memory for full packet, then write and commit it at once */
+    if ((res = prv_tx_claim(pkt, hdr_len + len + trl_len, 0, 0, TX_BATCH_HOLD(pkt, batch), &idx)) != lwpktOK) {
+        goto fast_return;
+    }
+    idx = prv_rb_put(pkt->tx_rb, idx, hdr, hdr_len);
+    for (size_t i = 0; i < seg_cnt; ++i) {
+        idx = prv_rb_put(pkt->tx_rb, idx, seg[i].data, seg[i].len);
+    }
+    prv_rb_put(pkt->tx_rb, idx, trl, trl_len);
+    prv_tx_finish(pkt, hdr_len + len + trl_len, batch);
+
+fast_return:
+    STATS_ADD(pkt, tx_pkts, res == lwpktOK);
+    STATS_ADD(pkt, tx_err_mem, res == lwpktERRMEM);
+    STATS_CYCLES_END(pkt, cycles, write);
+
+    /* Final step to notify app, batch sends events once at commit */
+    if (!batch) {
+        SEND_EVT(pkt, LWPKT_EVT_POST_WRITE); /* Release write event */
+        if (res == lwpktOK) {
+            SEND_EVT(pkt, LWPKT_EVT_WRITE); /* Send write event */
+        }
+    }
+    return res;
+}
+
+/**
+ * \brief           Write packet data to TX ringbuffer
+ * \param[in]       pkt: Packet instance
+ * \param[in]       to: End device address
+ * \param[in]       flags: Custom user flags
+ * \param[in]       cmd: Packet command
+ * \param[in]       data: Pointer to input data. Set to `NULL` if not used
+ * \param[in]       len: Length of input data. Must be set to `0` if `data == NULL`
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_write(lwpkt_t* pkt,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+            lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+            uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+            uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+            const void* data, size_t len) {
+    lwpkt_seg_t seg;
+
+    seg.data = data;
+    seg.len = len;
+    return prv_write(pkt, PRV_ARG_TO(to), PRV_ARG_FLAGS(flags), PRV_ARG_CMD(cmd), &seg, 1, 0);
+}
+
+/**
+ * \brief           Write packet to TX ringbuffer, with data part gathered from multiple segments.
+ *
+ * Length and CRC are calculated over all segments, that are copied directly to the TX buffer,
+ * without need for temporary buffer in the application.
+ *
+ * \param[in]       pkt: Packet instance
+ * \param[in]       to: End device address
+ * \param[in]       flags: Custom user flags
+ * \param[in]       cmd: Packet command
+ * \param[in]       seg: Array of data segments, in order of transmission. Set to `NULL` if not used
+ * \param[in]       seg_cnt: Number of entries in `seg` array. Must be set to `0` if `seg == NULL`
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_writev(lwpkt_t* pkt,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+             lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+             uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+             uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+             const lwpkt_seg_t* seg, size_t seg_cnt) {
+    return prv_write(pkt, PRV_ARG_TO(to), PRV_ARG_FLAGS(flags), PRV_ARG_CMD(cmd), seg, seg_cnt, 0);
+}
+
+#if LWPKT_CFG_USE_TX_BATCH || __DOXYGEN__
+
+/**
+ * \brief           Start batch of packets.
+ *
+ * Packets are added with \ref lwpkt_batch_write and written back to back to the TX buffer.
+ * They become visible to the buffer reader at once, with \ref lwpkt_batch_commit function.
+ * \ref LWPKT_EVT_PRE_WRITE event is sent here, \ref LWPKT_EVT_POST_WRITE and \ref LWPKT_EVT_WRITE at commit.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_TX_BATCH is enabled
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_batch_begin(lwpkt_t* pkt) {
+    if (!LWPKT_IS_VALID(pkt) || pkt->tx_batch.active
+#if LWPKT_CFG_USE_TX_STREAM
+        || pkt->tx_stream.active
+#endif /* LWPKT_CFG_USE_TX_STREAM */
+    ) {
+        return lwpktERR;
+    }
+    pkt->tx_batch.len = 0;
+    pkt->tx_batch.cnt = 0;
+    pkt->tx_batch.active = 1;
+    SEND_EVT(pkt, LWPKT_EVT_PRE_WRITE);
+    return lwpktOK;
+}
+
+/**
+ * \brief           Add packet to current batch.
+ *
+ * When there is no memory for the packet, batch stays valid with previously added packets.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_TX_BATCH is enabled
+ * \param[in]       pkt: Packet instance
+ * \param[in]       to: End device address
+ * \param[in]       flags: Custom user flags
+ * \param[in]       cmd: Packet command
+ * \param[in]       data: Pointer to input data. Set to `NULL` if not used
+ * \param[in]       len: Length of input data. Must be set to `0` if `data == NULL`
+ * \return          \ref lwpktOK on success, \ref lwpktERRMEM if there is no memory for the packet,
+ *                  member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_batch_write(lwpkt_t* pkt,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+                  lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+                  uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+                  uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+                  const void* data, size_t len) {
+    lwpkt_seg_t seg;
+
+    seg.data = data;
+    seg.len = len;
+    return prv_write(pkt, PRV_ARG_TO(to), PRV_ARG_FLAGS(flags), PRV_ARG_CMD(cmd), &seg, 1, 1);
+}
+
+/**
+ * \brief           Commit all packets of current batch to the TX buffer at once
+ *
+ * In multi-producer mode, batch holds single claim of TX buffer memory from its first packet until commit.
+ * Packets of other writers, written after first packet of the batch, are published after the batch.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_TX_BATCH is enabled
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_batch_commit(lwpkt_t* pkt) {
+    size_t cnt;
+
+    if (!LWPKT_IS_VALID(pkt) || !pkt->tx_batch.active) {
+        return lwpktERR;
+    }
+    cnt = pkt->tx_batch.cnt;
+#if LWPKT_CFG_TX_MPSC
+    if (cnt > 0) {
+        prv_tx_publish(pkt);
+    }
+#else  /* LWPKT_CFG_TX_MPSC */
+    lwrb_advance(pkt->tx_rb, pkt->tx_batch.len);
+#if LWPKT_CFG_TX_FRAMES
+    QUEUE_STORE(pkt->txq.w, (QUEUE_LOAD(pkt->txq.w, memory_order_relaxed) + cnt) % TXQ_CNT_MOD,
+                memory_order_release);
+#endif /* LWPKT_CFG_TX_FRAMES */
+#endif /* !LWPKT_CFG_TX_MPSC */
+    pkt->tx_batch.len = 0;
+    pkt->tx_batch.cnt = 0;
+    pkt->tx_batch.active = 0;
+
+    SEND_EVT(pkt, LWPKT_EVT_POST_WRITE);
+    if (cnt > 0) {
+        SEND_EVT(pkt, LWPKT_EVT_WRITE);
+    }
+    return lwpktOK;
+}
+
+#endif /* LWPKT_CFG_USE_TX_BATCH || __DOXYGEN__ */
+
+#if LWPKT_CFG_USE_TX_STREAM || __DOXYGEN__
+
+/**
+ * \brief           Start writing stream packet to TX ringbuffer.
+ *
+ * Function writes packet header. Data part is written with \ref lwpkt_write_chunk function
+ * and packet is finished with \ref lwpkt_write_end function.
+ * No other packet can be written until stream packet is finished.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_TX_STREAM is enabled
+ * \param[in]       pkt: Packet instance
+ * \param[in]       to: End device address
+ * \param[in]       flags: Custom user flags
+ * \param[in]       cmd: Packet command
+ * \param[in]       len: Total length of data part, that will be written with chunks
+ * \return          \ref lwpktOK on success, \ref lwpktERRMEM if there is no memory for header,
+ *                  member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_write_begin(lwpkt_t* pkt,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+                  lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+                  uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+                  uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+                  size_t len) {
+    lwpktr_t res = lwpktOK;
+    uint8_t hdr[LWPKT_HDR_MAX_LEN];
+    size_t hdr_len, idx;
+
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+
+    SEND_EVT(pkt, LWPKT_EVT_PRE_WRITE);
+    if (pkt->tx_stream.active
+#if LWPKT_CFG_USE_TX_BATCH && !LWPKT_CFG_TX_MPSC
+        /* Batch owns the buffer until it is committed */
+        || pkt->tx_batch.active
+#endif /* LWPKT_CFG_USE_TX_BATCH && !LWPKT_CFG_TX_MPSC */
+#if LWPKT_CFG_USE_COBS
+        /* COBS block codes depend on data not written yet */
+        || CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_COBS, LWPKT_FLAG_USE_COBS)
+#endif /* LWPKT_CFG_USE_COBS */
+    ) {
+        res = lwpktERR;
+        goto fast_return;
+    }
+
+    hdr_len = prv_hdr_build(pkt, hdr, PRV_ARG_TO(to), PRV_ARG_FLAGS(flags), PRV_ARG_CMD(cmd), len);
+    if ((res = prv_tx_claim(pkt, hdr_len, 0, 1, 0, &idx)) != lwpktOK) {
+        goto fast_return;
+    }
+#if LWPKT_CFG_USE_CRC
+    if (CRC_LEN_USED(pkt) > 0) {
+        prv_crc_init(pkt, &pkt->tx_stream.crc);
+        prv_crc_in(pkt, &pkt->tx_stream.crc, &hdr[1], hdr_len - 1U); /* Start byte is not part of CRC */
+    }
+#endif /* LWPKT_CFG_USE_CRC */
+    prv_rb_put(pkt->tx_rb, idx, hdr, hdr_len);
+    pkt->tx_stream.rem = len;
+    pkt->tx_stream.active = 1;
+    prv_tx_commit(pkt, hdr_len);
+
+fast_return:
+    STATS_ADD(pkt, tx_err_mem, res == lwpktERRMEM);
+    SEND_EVT(pkt, LWPKT_EVT_POST_WRITE);
+    if (res == lwpktOK) {
+        SEND_EVT(pkt, LWPKT_EVT_WRITE);
+    }
+    return res;
+}
+
+/**
+ * \brief           Write part of data for stream packet.
+ *
+ * Function writes as many bytes as there is free memory in the TX buffer.
+ * Application shall call it again, with remaining data, once more memory gets free,
+ * for example on buffer read event, when DMA finished transmission.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_TX_STREAM is enabled
+ * \param[in]       pkt: Packet instance
+ * \param[in]       data: Data to write
+ * \param[in]       len: Number of bytes to write. Bytes above declared packet length are ignored
+ * \param[out]      bw: Pointer to output variable to save number of bytes written. Can be set to `NULL`
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_write_chunk(lwpkt_t* pkt, const void* data, size_t len, size_t* bw) {
+    lwpktr_t res = lwpktOK;
+    size_t written = 0, idx;
+
+    if (!LWPKT_IS_VALID(pkt) || (data == NULL && len > 0)) {
+        return lwpktERR;
+    }
+
+    SEND_EVT(pkt, LWPKT_EVT_PRE_WRITE);
+    if (!pkt->tx_stream.active) {
+        res = lwpktERR;
+        goto fast_return;
+    }
+#if LWPKT_CFG_TX_MPSC
+    /* Other writers cannot claim memory while stream is in progress */
+    written = LWPKT_MIN(LWPKT_MIN(len, pkt->tx_stream.rem),
+                        prv_tx_free(pkt, atomic_load_explicit(&pkt->tx_claim, memory_order_acquire), &idx));
+#else  /* LWPKT_CFG_TX_MPSC */
+    written = LWPKT_MIN(LWPKT_MIN(len, pkt->tx_stream.rem), lwrb_get_free(pkt->tx_rb));
+#endif /* !LWPKT_CFG_TX_MPSC */
+    if (written > 0) {
+        if ((res = prv_tx_claim(pkt, written, 1, 1, 0, &idx)) != lwpktOK) {
+            written = 0;
+            goto fast_return;
+        }
+        ADD_IN_TO_CRC(pkt, &pkt->tx_stream.crc, data, written);
+        prv_rb_put(pkt->tx_rb, idx, data, written);
+        pkt->tx_stream.rem -= written;
+        prv_tx_commit(pkt, written);
+    }
+
+fast_return:
+    if (bw != NULL) {
+        *bw = written;
+    }
+    SEND_EVT(pkt, LWPKT_EVT_POST_WRITE);
+    if (written > 0) {
+        SEND_EVT(pkt, LWPKT_EVT_WRITE);
+    }
+    return res;
+}
+
+/**
+ * \brief           Finish stream packet by writing CRC and stop byte
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_TX_STREAM is enabled
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktOK on success, \ref lwpktERRMEM if there is no memory for trailer,
+ *                  member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_write_end(lwpkt_t* pkt) {
+    lwpktr_t res = lwpktOK;
+    lwpkt_crc_t crc;
+    uint8_t trl[LWPKT_TRL_MAX_LEN];
+    size_t trl_len, idx;
+
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+
+    SEND_EVT(pkt, LWPKT_EVT_PRE_WRITE);
+    if (!pkt->tx_stream.active || pkt->tx_stream.rem > 0) {
+        res = lwpktERR;
+        goto fast_return;
+    }
+
+    /* Work on a copy, so that function can be called again when there is no memory */
+    crc = pkt->tx_stream.crc;
+    trl_len = prv_trl_build(pkt, &crc, trl);
+    if ((res = prv_tx_claim(pkt, trl_len, 1, 0, 0, &idx)) != lwpktOK) {
+        goto fast_return;
+    }
+    prv_rb_put(pkt->tx_rb, idx, trl, trl_len);
+    pkt->tx_stream.active = 0;
+    prv_tx_commit(pkt, trl_len);
+
+fast_return:
+    STATS_ADD(pkt, tx_pkts, res == lwpktOK);
+    STATS_ADD(pkt, tx_err_mem, res == lwpktERRMEM);
+    SEND_EVT(pkt, LWPKT_EVT_POST_WRITE);
+    if (res == lwpktOK) {
+        SEND_EVT(pkt, LWPKT_EVT_WRITE);
+    }
+    return res;
+}
+
+#endif /* LWPKT_CFG_USE_TX_STREAM || __DOXYGEN__ */
+
+/**
+ * \brief           Reset packet state
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_reset(lwpkt_t* pkt) {
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+#if LWPKT_CFG_RX_ZERO_COPY
+    lwpkt_release_view(pkt);
+#endif /* LWPKT_CFG_RX_ZERO_COPY */
+#if LWPKT_CFG_RX_RESYNC
+    prv_rx_skip(pkt, pkt->rx_hold.off);
+    pkt->rx_hold.off = 0;
+    pkt->rx_hold.hold = 0;
+#endif /* LWPKT_CFG_RX_RESYNC */
+    LWPKT_RESET(pkt);
+    return lwpktOK;
+}
+
+#if LWPKT_CFG_RX_ZERO_COPY || __DOXYGEN__
+
+/**
+ * \brief           Get data part of the last valid packet, as reference to the RX buffer memory
+ * \note            This function is only available, if \ref LWPKT_CFG_RX_ZERO_COPY is enabled
+ * \param[in]       pkt: Packet instance
+ * \param[out]      seg: Array of `2` segments to fill. Second segment has length `0`,
+ *                      unless data wrap around end of the RX buffer
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_get_view(const lwpkt_t* pkt, lwpkt_seg_t* seg) {
+    if (!LWPKT_IS_VALID(pkt) || seg == NULL) {
+        return lwpktERR;
+    }
+    seg[0] = pkt->m.view[0];
+    seg[1] = pkt->m.view[1];
+    return lwpktOK;
+}
+
+/**
+ * \brief           Release RX buffer memory used by the last valid packet
+ * \note            This function is only available, if \ref LWPKT_CFG_RX_ZERO_COPY is enabled
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_release_view(lwpkt_t* pkt) {
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
+    }
+    if (pkt->m.view_hold > 0) {
+        prv_rx_skip(pkt, pkt->m.view_hold);
+        pkt->m.view_hold = 0;
+    }
+    LWPKT_MEMSET(pkt->m.view, 0x00, sizeof(pkt->m.view));
+    return lwpktOK;
+}
+
+#endif /* LWPKT_CFG_RX_ZERO_COPY || __DOXYGEN__ */
+
+#if LWPKT_CFG_RX_QUEUE || __DOXYGEN__
 
-                /* Check if we received all CRC bytes */
-                if (pkt->m.index == CRC_DATA_LEN(pkt)) {
-                    uint32_t crc = prv_crc_finish(pkt, &pkt->m.crc);
+/**
+ * \brief           Get number of packets in the receive queue
+ * \note            This function is only available, if \ref LWPKT_CFG_RX_QUEUE is greater than `0`
+ * \param[in]       pkt: Packet instance
+ * \return          Number of packets, waiting to be released
+ */
+size_t
+lwpkt_rxq_get_count(lwpkt_t* pkt) {
+    unsigned long w, r;
 
-                    /* Check if calculated CRC matches the received data */
-                    if (crc == pkt->m.crc_data) {
-                        LWPKT_SET_STATE(pkt, LWPKT_STATE_STOP);
-                    } else {
-                        LWPKT_RESET(pkt);
-                        res = lwpktERRCRC;
-                        goto retpre;
-                    }
-                }
-                break;
-            }
-#endif /* LWPKT_CFG_USE_CRC */
-            case LWPKT_STATE_STOP: {
-                prv_go_to_next_packet_rx_state(pkt);
-                if (b == LWPKT_STOP_BYTE) {
-                    res = lwpktVALID; /* Packet fully valid, take data from it */
-                    goto retpre;
-                } else {
-                    res = lwpktERRSTOP; /* Packet is missing STOP byte! */
-                    goto retpre;
-                }
-            }
-            default: {
-                LWPKT_RESET(pkt);
-                res = lwpktERR; /* Hard error */
-                goto retpre;
-            }
-        }
+    if (pkt == NULL) {
+        return 0;
     }
-    res = (pkt->m.state == LWPKT_STATE_START) ? lwpktWAITDATA : lwpktINPROG;
-retpre:
-    SEND_EVT(pkt, LWPKT_EVT_POST_READ);
-    if (e) {
-        SEND_EVT(pkt, LWPKT_EVT_READ); /* Send read event */
+    w = QUEUE_LOAD(pkt->rxq.w, memory_order_acquire);
+    r = QUEUE_LOAD(pkt->rxq.r, memory_order_acquire);
+    return (size_t)((w + RXQ_CNT_MOD - r) % RXQ_CNT_MOD);
+}
+
+/**
+ * \brief           Get oldest packet from the receive queue.
+ *                  Slot stays valid until it is released with \ref lwpkt_rxq_release
+ *
+ * Function can be called from other thread than \ref lwpkt_read, with single reader of the queue.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_RX_QUEUE is greater than `0`
+ * \param[in]       pkt: Packet instance
+ * \return          Pointer to the queue slot, `NULL` if queue is empty
+ */
+const lwpkt_rx_slot_t*
+lwpkt_rxq_get(lwpkt_t* pkt) {
+    if (lwpkt_rxq_get_count(pkt) == 0) {
+        return NULL;
     }
-    return res;
+    return &pkt->rxq.slot[QUEUE_LOAD(pkt->rxq.r, memory_order_relaxed) % LWPKT_CFG_RX_QUEUE];
 }
 
 /**
- * \brief           Process packet instance and read new data
+ * \brief           Release oldest packet in the receive queue, to make its slot available for new packet
+ * \note            This function is only available, if \ref LWPKT_CFG_RX_QUEUE is greater than `0`
  * \param[in]       pkt: Packet instance
- * \param[in]       time: Current time in units of milliseconds
- * \return          \ref lwpktOK if processing OK, member of \ref lwpktr_t otherwise
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
  */
 lwpktr_t
-lwpkt_process(lwpkt_t* pkt, uint32_t time) {
-    lwpktr_t pktres = lwpktERR;
+lwpkt_rxq_release(lwpkt_t* pkt) {
+    unsigned long r;
+
+    if (lwpkt_rxq_get_count(pkt) == 0) {
+        return lwpktERR;
+    }
+    r = QUEUE_LOAD(pkt->rxq.r, memory_order_relaxed);
+    QUEUE_STORE(pkt->rxq.r, (r + 1U) % RXQ_CNT_MOD, memory_order_release);
+    return lwpktOK;
+}
+
+#endif /* LWPKT_CFG_RX_QUEUE || __DOXYGEN__ */
+
+#if LWPKT_CFG_TX_FRAMES || __DOXYGEN__
+
+/**
+ * \brief           Get number of frames in the transmit queue
+ * \note            This function is only available, if \ref LWPKT_CFG_TX_FRAMES is greater than `0`
+ * \param[in]       pkt: Packet instance
+ * \return          Number of frames, waiting to be released
+ */
+size_t
+lwpkt_txq_get_count(lwpkt_t* pkt) {
+    unsigned long w, r;
 
     if (pkt == NULL) {
-        return pktres;
+        return 0;
     }
+    w = QUEUE_LOAD(pkt->txq.w, memory_order_acquire);
+    r = QUEUE_LOAD(pkt->txq.r, memory_order_acquire);
+    return (size_t)((w + TXQ_CNT_MOD - r) % TXQ_CNT_MOD);
+}
 
-    /* Packet protocol data read */
-    pktres = lwpkt_read(pkt);
-    if (pktres == lwpktVALID) {
-        pkt->last_rx_time = time;
-        SEND_EVT(pkt, LWPKT_EVT_PKT);
-    } else if (pktres == lwpktINPROG) {
-        if ((time - pkt->last_rx_time) >= LWPKT_CFG_PROCESS_INPROG_TIMEOUT) {
-            lwpkt_reset(pkt);
-            pkt->last_rx_time = time;
-            SEND_EVT(pkt, LWPKT_EVT_TIMEOUT);
-        }
-    } else {
-        pkt->last_rx_time = time;
+/**
+ * \brief           Get oldest frame from the transmit queue.
+ *                  Frame memory stays valid until it is released with \ref lwpkt_txq_release
+ *
+ * Function can be called from other thread or interrupt than write functions, with single reader of the queue.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_TX_FRAMES is greater than `0`
+ * \param[in]       pkt: Packet instance
+ * \return          Pointer to the frame, `NULL` if queue is empty
+ */
+const lwpkt_tx_frame_t*
+lwpkt_txq_get(lwpkt_t* pkt) {
+    if (lwpkt_txq_get_count(pkt) == 0) {
+        return NULL;
     }
-    return pktres;
+    return &pkt->txq.frame[QUEUE_LOAD(pkt->txq.r, memory_order_relaxed) % LWPKT_CFG_TX_FRAMES];
 }
 
 /**
- * \brief           Write packet data to TX ringbuffer
+ * \brief           Release oldest frame in the transmit queue, after it has been transmitted.
+ *                  Frame memory and its padding bytes are released in TX buffer
+ * \note            This function is only available, if \ref LWPKT_CFG_TX_FRAMES is greater than `0`
  * \param[in]       pkt: Packet instance
- * \param[in]       to: End device address
- * \param[in]       cmd: Packet command
- * \param[in]       data: Pointer to input data. Set to `NULL` if not used
- * \param[in]       len: Length of input data. Must be set to `0` if `data == NULL`
  * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
  */
 lwpktr_t
-lwpkt_write(lwpkt_t* pkt,
-#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
-            lwpkt_addr_t to,
-#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
-#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
-            uint32_t flags,
-#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
-#if LWPKT_CFG_USE_CMD || __DOXYGEN__
-            uint32_t cmd,
-#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
-            const void* data, size_t len) {
-    lwpktr_t res = lwpktOK;
-#if LWPKT_CFG_USE_CRC
-    lwpkt_crc_t crc;
-#endif /* LWPKT_CFG_USE_CRC */
-    size_t org_len = len;
-    uint8_t b;
-
-    SEND_EVT(pkt, LWPKT_EVT_PRE_WRITE);
+lwpkt_txq_release(lwpkt_t* pkt) {
+    const lwpkt_tx_frame_t* frame;
+    unsigned long r;
+    size_t len;
 
-    if (!LWPKT_IS_VALID(pkt)) {
-        res = lwpktERR;
-        goto fast_return;
-    } else {
-        /* Check for required memory for packet */
-        size_t min_mem = 2U;
+    if ((frame = lwpkt_txq_get(pkt)) == NULL) {
+        return lwpktERR;
+    }
+    len = frame->pad + frame->seg[0].len + frame->seg[1].len;
 
-        /* Addresses */
-#if LWPKT_CFG_USE_ADDR
-        if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_ADDR, LWPKT_FLAG_USE_ADDR)) {
-            if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_ADDR_EXTENDED, LWPKT_FLAG_ADDR_EXTENDED)) {
-                CALC_BYTES_NUM_FOR_LEN(min_mem, pkt->addr);
-                CALC_BYTES_NUM_FOR_LEN(min_mem, to);
-            } else {
-                min_mem += 2U; /* Static configuration */
-            }
-        }
-#endif /* LWPKT_CFG_USE_ADDR */
+    /* Entry is released before memory, buffer is never empty with frames in the queue */
+    r = QUEUE_LOAD(pkt->txq.r, memory_order_relaxed);
+    QUEUE_STORE(pkt->txq.r, (r + 1U) % TXQ_CNT_MOD, memory_order_release);
+    lwrb_skip(pkt->tx_rb, len);
+    return lwpktOK;
+}
 
-#if LWPKT_CFG_USE_FLAGS
-        if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_FLAGS, LWPKT_FLAG_USE_FLAGS)) {
-            CALC_BYTES_NUM_FOR_LEN(min_mem, flags);
-        }
-#endif /* LWPKT_CFG_USE_FLAGS */
+#endif /* LWPKT_CFG_TX_FRAMES || __DOXYGEN__ */
 
-        if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CMD, LWPKT_FLAG_USE_CMD)) {
-            if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CMD_EXTENDED, LWPKT_FLAG_CMD_EXTENDED)) {
-                CALC_BYTES_NUM_FOR_LEN(min_mem, cmd);
-            } else {
-                ++min_mem; /* Static configuration */
-            }
-        }
+#if LWPKT_CFG_TX_LANES || __DOXYGEN__
 
-        /* Encode data length number + add actual data space requirement */
-        CALC_BYTES_NUM_FOR_LEN(min_mem, len);
-        min_mem += len; /* Data length */
+/**
+ * \brief           Initialize transmit scheduler without lanes
+ * \note            This function is only available, if \ref LWPKT_CFG_TX_LANES is greater than `0`
+ * \param[in]       sched: Scheduler instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_tx_sched_init(lwpkt_tx_sched_t* sched) {
+    if (sched == NULL) {
+        return lwpktERR;
+    }
+    LWPKT_MEMSET(sched, 0x00, sizeof(*sched));
+    return lwpktOK;
+}
 
-        /* CRC part */
-        if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CRC, LWPKT_FLAG_USE_CRC)) {
-            min_mem += CRC_DATA_LEN(pkt);
-        }
+/**
+ * \brief           Set packet instance of the scheduler lane.
+ *                  Packets written to the instance are transmitted with lane priority
+ * \note            This function is only available, if \ref LWPKT_CFG_TX_LANES is greater than `0`
+ * \param[in]       sched: Scheduler instance
+ * \param[in]       prio: Lane priority, `0` is the highest. Must be lower than \ref LWPKT_CFG_TX_LANES
+ * \param[in]       pkt: Initialized packet instance. Set to `NULL` to remove the lane
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_tx_sched_set_lane(lwpkt_tx_sched_t* sched, size_t prio, lwpkt_t* pkt) {
+    if (sched == NULL || prio >= LWPKT_CFG_TX_LANES || (pkt != NULL && pkt->tx_rb == NULL)) {
+        return lwpktERR;
+    }
+    if (sched->cur != NULL && sched->cur == sched->lane[prio]) {
+        return lwpktERR; /* Frame of the lane is in transmission */
+    }
+    sched->lane[prio] = pkt;
+    return lwpktOK;
+}
 
-        /* Verify enough memory */
-        if (lwrb_get_free(pkt->tx_rb) < min_mem) {
-            res = lwpktERRMEM;
-            goto fast_return;
+/**
+ * \brief           Get next frame to transmit.
+ *                  Frame stays the same, until it is released with \ref lwpkt_tx_sched_release
+ *
+ * Frame is taken from the frame queue of the highest priority lane, that has at least one frame.
+ * Function can be called from other thread or interrupt than write functions, with single reader of the scheduler.
+ *
+ * \note            This function is only available, if \ref LWPKT_CFG_TX_LANES is greater than `0`
+ * \param[in]       sched: Scheduler instance
+ * \return          Pointer to the frame, `NULL` if all lanes are empty
+ */
+const lwpkt_tx_frame_t*
+lwpkt_tx_sched_get(lwpkt_tx_sched_t* sched) {
+    if (sched == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; sched->cur == NULL && i < LWPKT_CFG_TX_LANES; ++i) {
+        if (lwpkt_txq_get_count(sched->lane[i]) > 0) {
+            sched->cur = sched->lane[i];
         }
     }
+    return lwpkt_txq_get(sched->cur);
+}
 
-#if LWPKT_CFG_USE_CRC
-    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CRC, LWPKT_FLAG_USE_CRC)) {
-        prv_crc_init(pkt, &crc);
+/**
+ * \brief           Release frame, taken with \ref lwpkt_tx_sched_get, after it has been transmitted
+ * \note            This function is only available, if \ref LWPKT_CFG_TX_LANES is greater than `0`
+ * \param[in]       sched: Scheduler instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_tx_sched_release(lwpkt_tx_sched_t* sched) {
+    lwpktr_t res;
+
+    if (sched == NULL || sched->cur == NULL) {
+        return lwpktERR;
     }
-#endif /* LWPKT_CFG_USE_CRC */
+    res = lwpkt_txq_release(sched->cur);
+    sched->cur = NULL;
+    return res;
+}
 
-    /* Start byte */
-    b = LWPKT_START_BYTE;
-    lwrb_write(pkt->tx_rb, &b, 1U);
+#endif /* LWPKT_CFG_TX_LANES || __DOXYGEN__ */
 
-#if LWPKT_CFG_USE_ADDR
-    /* Add addresses */
-    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_ADDR, LWPKT_FLAG_USE_ADDR)) {
-        if (0) {
-#if LWPKT_CFG_ADDR_EXTENDED
-        } else if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_ADDR_EXTENDED, LWPKT_FLAG_ADDR_EXTENDED)) {
-            write_bytes_var_encoded(pkt, &crc, pkt->addr);
-            write_bytes_var_encoded(pkt, &crc, to);
-        } else {
-#endif /* !LWPKT_CFG_ADDR_EXTENDED */
-            WRITE_WITH_CRC(pkt, &crc, pkt->tx_rb, &pkt->addr, 1);
-            WRITE_WITH_CRC(pkt, &crc, pkt->tx_rb, &to, 1);
-        }
-    }
-#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_STATS || __DOXYGEN__
 
-#if LWPKT_CFG_USE_FLAGS
-    /* Flags part */
-    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_FLAGS, LWPKT_FLAG_USE_FLAGS)) {
-        write_bytes_var_encoded(pkt, &crc, flags);
+/**
+ * \brief           Get snapshot of statistics counters
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_STATS is enabled
+ * \note            Counters are not protected against concurrent update.
+ *                  Call function from the same context as read and write operations
+ * \param[in]       pkt: Packet instance
+ * \param[out]      stats: Output variable to copy counters to
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_get_stats(const lwpkt_t* pkt, lwpkt_stats_t* stats) {
+    if (!LWPKT_IS_VALID(pkt) || stats == NULL) {
+        return lwpktERR;
     }
-#endif
+    *stats = pkt->stats;
+    return lwpktOK;
+}
 
-#if LWPKT_CFG_USE_CMD
-    /* CMD byte */
-    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CMD, LWPKT_FLAG_USE_CMD)) {
-        if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_CMD_EXTENDED, LWPKT_FLAG_CMD_EXTENDED)) {
-            write_bytes_var_encoded(pkt, &crc, cmd);
-        } else {
-            WRITE_WITH_CRC(pkt, &crc, pkt->tx_rb, &cmd, 1);
-        }
+/**
+ * \brief           Reset all statistics counters to `0`
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_STATS is enabled
+ * \param[in]       pkt: Packet instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_reset_stats(lwpkt_t* pkt) {
+    if (!LWPKT_IS_VALID(pkt)) {
+        return lwpktERR;
     }
-#endif /* LWPKT_CFG_USE_CMD */
+    LWPKT_MEMSET(&pkt->stats, 0x00, sizeof(pkt->stats));
+    return lwpktOK;
+}
 
-    /* Length bytes */
-    write_bytes_var_encoded(pkt, &crc, len);
+#endif /* LWPKT_CFG_USE_STATS || __DOXYGEN__ */
 
-    /* Data bytes, but only if length more than 0 */
-    if (org_len > 0) {
-        WRITE_WITH_CRC(pkt, &crc, pkt->tx_rb, data, org_len);
-    }
+#if LWPKT_CFG_TRACE || __DOXYGEN__
 
-#if LWPKT_CFG_USE_CRC
-    /* CRC byte */
-    if (CHECK_FEATURE_CONFIG_MODE_ENABLED(pkt, LWPKT_CFG_USE_CRC, LWPKT_FLAG_USE_CRC)) {
-        uint32_t crc_data = prv_crc_finish(pkt, &crc);
-        for (size_t i = 0; i < CRC_DATA_LEN(pkt); ++i, crc_data >>= 8UL) {
-            uint8_t byt = crc_data & 0xFFUL;
-            lwrb_write(pkt->tx_rb, &byt, 1);
-        }
+/**
+ * \brief           Get number of finished records in the packet latency trace
+ * \note            This function is only available, if \ref LWPKT_CFG_TRACE is greater than `0`
+ * \param[in]       pkt: Packet instance
+ * \return          Number of records, waiting to be read
+ */
+size_t
+lwpkt_trace_get_count(lwpkt_t* pkt) {
+    unsigned long w, r;
+
+    if (pkt == NULL) {
+        return 0;
     }
-#endif /* LWPKT_CFG_USE_CRC */
+    w = QUEUE_LOAD(pkt->trace.w, memory_order_acquire);
+    r = QUEUE_LOAD(pkt->trace.r, memory_order_acquire);
+    return (size_t)((w + TRACE_CNT_MOD - r) % TRACE_CNT_MOD);
+}
 
-    /* Stop byte */
-    b = LWPKT_STOP_BYTE;
-    lwrb_write(pkt->tx_rb, &b, 1U);
+/**
+ * \brief           Read and remove oldest record from the packet latency trace
+ * \note            This function is only available, if \ref LWPKT_CFG_TRACE is greater than `0`
+ * \param[in]       pkt: Packet instance
+ * \param[out]      rec: Output variable to write trace record to
+ * \return          \ref lwpktOK on success, \ref lwpktERR if there is no record
+ */
+lwpktr_t
+lwpkt_trace_read(lwpkt_t* pkt, lwpkt_trace_t* rec) {
+    unsigned long r;
 
-fast_return:
-    /* Final step to notify app */
-    SEND_EVT(pkt, LWPKT_EVT_POST_WRITE); /* Release write event */
-    if (res == lwpktOK) {
-        SEND_EVT(pkt, LWPKT_EVT_WRITE); /* Send write event */
+    if (rec == NULL || lwpkt_trace_get_count(pkt) == 0) {
+        return lwpktERR;
     }
-    return res;
+    r = QUEUE_LOAD(pkt->trace.r, memory_order_relaxed);
+    *rec = pkt->trace.rec[r % LWPKT_CFG_TRACE];
+    QUEUE_STORE(pkt->trace.r, (r + 1U) % TRACE_CNT_MOD, memory_order_release);
+    return lwpktOK;
 }
 
+#endif /* LWPKT_CFG_TRACE || __DOXYGEN__ */
+
+#if LWPKT_CFG_RX_FILTER || __DOXYGEN__
+
 /**
- * \brief           Reset packet state
+ * \brief           Set receive filter for packet instance
+ * \note            This function is only available, if \ref LWPKT_CFG_RX_FILTER is enabled
+ * \note            Filter structure is not copied and must stay valid, until it is replaced
  * \param[in]       pkt: Packet instance
+ * \param[in]       filter: Receive filter. Set to `NULL` to accept all packets
  * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
  */
 lwpktr_t
-lwpkt_reset(lwpkt_t* pkt) {
+lwpkt_set_filter(lwpkt_t* pkt, const lwpkt_filter_t* filter) {
     if (!LWPKT_IS_VALID(pkt)) {
         return lwpktERR;
     }
-    LWPKT_RESET(pkt);
+    pkt->filter = filter;
+    return lwpktOK;
+}
+
+#endif /* LWPKT_CFG_RX_FILTER || __DOXYGEN__ */
+
+#if LWPKT_CFG_CRC_DESC || __DOXYGEN__
+
+/**
+ * \brief           Set CRC algorithm for packet instance
+ * \note            This function is only available, if \ref LWPKT_CFG_CRC_DESC is enabled
+ * \note            Descriptor is not copied and must stay valid, until it is replaced.
+ *                  Both sides of the link must use the same CRC algorithm
+ * \param[in]       pkt: Packet instance
+ * \param[in]       desc: CRC descriptor, for example \ref lwpkt_crc_desc_crc32c.
+ *                      Set to `NULL` to use `CRC-8` or `CRC-32`, as configured with \ref LWPKT_CFG_CRC32
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_set_crc_desc(lwpkt_t* pkt, const lwpkt_crc_desc_t* desc) {
+    if (!LWPKT_IS_VALID(pkt) || (desc != NULL && !CRC_DESC_WIDTH_VALID(desc))) {
+        return lwpktERR;
+    }
+    pkt->crc_desc = desc;
+    LAYOUT_UPDATE(pkt);
+    return lwpktOK;
+}
+
+/**
+ * \brief           Generate lookup table for CRC descriptor
+ * \note            This function is only available, if \ref LWPKT_CFG_CRC_DESC is enabled
+ * \param[in]       desc: CRC descriptor. Its `table` member is not used
+ * \param[out]      table: Memory for `256` table entries
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_crc_table_gen(const lwpkt_crc_desc_t* desc, uint32_t* table) {
+    uint32_t poly;
+
+    if (desc == NULL || table == NULL || !CRC_DESC_WIDTH_VALID(desc)) {
+        return lwpktERR;
+    }
+    poly = prv_crc_desc_poly(desc);
+    for (uint32_t i = 0; i < 256U; ++i) {
+        table[i] = prv_crc_desc_calc_one(desc, poly, 0, (uint8_t)i);
+    }
     return lwpktOK;
 }
 
+#endif /* LWPKT_CFG_CRC_DESC || __DOXYGEN__ */
+
 #if LWPKT_CFG_USE_EVT || __DOXYGEN__
 
 /**
@@ -754,6 +3290,7 @@ lwpkt_set_crc_enabled(lwpkt_t* pkt, uint8_t enable) {
     } else {
         pkt->flags &= ~LWPKT_FLAG_USE_CRC;
     }
+    LAYOUT_UPDATE(pkt);
 }
 
 #endif /* LWPKT_CFG_USE_CRC == 2 || __DOXYGEN__ */
@@ -774,6 +3311,7 @@ lwpkt_set_crc32_enabled(lwpkt_t* pkt, uint8_t enable) {
     } else {
         pkt->flags &= ~LWPKT_FLAG_CRC32;
     }
+    LAYOUT_UPDATE(pkt);
 }
 
 #endif /* LWPKT_CFG_CRC32 == 2 || __DOXYGEN__ */
@@ -794,6 +3332,7 @@ lwpkt_set_addr_enabled(lwpkt_t* pkt, uint8_t enable) {
     } else {
         pkt->flags &= ~LWPKT_FLAG_USE_ADDR;
     }
+    LAYOUT_UPDATE(pkt);
 }
 
 #endif /* LWPKT_CFG_USE_ADDR == 2 || __DOXYGEN__ */
@@ -814,6 +3353,7 @@ lwpkt_set_addr_extended_enabled(lwpkt_t* pkt, uint8_t enable) {
     } else {
         pkt->flags &= ~LWPKT_FLAG_ADDR_EXTENDED;
     }
+    LAYOUT_UPDATE(pkt);
 }
 
 #endif /* LWPKT_CFG_ADDR_EXTENDED == 2 || __DOXYGEN__ */
@@ -834,6 +3374,7 @@ lwpkt_set_cmd_enabled(lwpkt_t* pkt, uint8_t enable) {
     } else {
         pkt->flags &= ~LWPKT_FLAG_USE_CMD;
     }
+    LAYOUT_UPDATE(pkt);
 }
 
 #endif /* LWPKT_CFG_USE_CMD == 2 || __DOXYGEN__ */
@@ -854,6 +3395,7 @@ lwpkt_set_cmd_extended_enabled(lwpkt_t* pkt, uint8_t enable) {
     } else {
         pkt->flags &= ~LWPKT_FLAG_CMD_EXTENDED;
     }
+    LAYOUT_UPDATE(pkt);
 }
 
 #endif /* LWPKT_CFG_CMD_EXTENDED == 2 || __DOXYGEN__ */
@@ -874,6 +3416,27 @@ lwpkt_set_flags_enabled(lwpkt_t* pkt, uint8_t enable) {
     } else {
         pkt->flags &= ~LWPKT_FLAG_USE_FLAGS;
     }
+    LAYOUT_UPDATE(pkt);
 }
 
 #endif /* LWPKT_CFG_USE_FLAGS == 2 || __DOXYGEN__ */
+
+#if LWPKT_CFG_USE_COBS == 2 || __DOXYGEN__
+
+/**
+ * \brief           Enable COBS framing of the packets
+ * 
+ * \note            This function is only available, if \ref LWPKT_CFG_USE_COBS is `2`
+ * \param           pkt: LwPKT instance
+ * \param           enable: `1` to enable, `0` otherwise
+ */
+void
+lwpkt_set_cobs_enabled(lwpkt_t* pkt, uint8_t enable) {
+    if (enable) {
+        pkt->flags |= LWPKT_FLAG_USE_COBS;
+    } else {
+        pkt->flags &= ~LWPKT_FLAG_USE_COBS;
+    }
+}
+
+#endif /* LWPKT_CFG_USE_COBS == 2 || __DOXYGEN__ */
@@ -0,0 +1,320 @@
+/**
+ * \file            lwpkt_engine.c
+ * \brief           Multi-channel packet engine
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#include <stdint.h>
+#include <string.h>
+#include "lwpkt/lwpkt_engine.h"
+#include "lwrb/lwrb.h"
+
+#if LWPKT_CFG_USE_ENGINE || __DOXYGEN__
+
+/* Validate user configuration */
+#if !LWPKT_CFG_USE_EVT
+#error "LWPKT_CFG_USE_ENGINE must be disabled if LWPKT_CFG_USE_EVT is not enabled"
+#endif
+#if LWPKT_CFG_ENGINE_CHANNELS < 1 || LWPKT_CFG_ENGINE_CHANNELS > 32
+#error "LWPKT_CFG_ENGINE_CHANNELS must be set between 1 and 32"
+#endif
+#if LWPKT_CFG_ENGINE_WHEEL_SLOTS < 1 || LWPKT_CFG_ENGINE_WHEEL_SLOTS > 255
+#error "LWPKT_CFG_ENGINE_WHEEL_SLOTS must be set between 1 and 255"
+#endif
+#if LWPKT_CFG_ENGINE_WHEEL_TICK < 1
+#error "LWPKT_CFG_ENGINE_WHEEL_TICK must be greater than 0"
+#endif
+
+#define ENG_BIT(idx) ((uint32_t)1 << (idx))
+
+/* Ready mask is set from RX buffer event, possibly from interrupt context */
+#ifdef LWRB_DISABLE_ATOMIC
+#define ENG_INIT(var, val) (var) = (val)
+#define ENG_LOAD(var)      (uint32_t)(var)
+#define ENG_SET(var, mask) (var) |= (mask)
+#define ENG_CLR(var, mask) (var) &= ~(unsigned long)(mask)
+#define ENG_TAKE(var)      prv_take(&(var))
+
+/**
+ * \brief           Get and clear the mask
+ * \param[in,out]   var: Mask to take
+ * \return          Mask value before clear
+ */
+static uint32_t
+prv_take(lwrb_ulong_t* var) {
+    uint32_t mask = (uint32_t)*var;
+
+    *var = 0;
+    return mask;
+}
+#else
+#define ENG_INIT(var, val) atomic_init(&(var), (val))
+#define ENG_LOAD(var)      (uint32_t)atomic_load_explicit(&(var), memory_order_acquire)
+#define ENG_SET(var, mask) (void)atomic_fetch_or_explicit(&(var), (mask), memory_order_release)
+#define ENG_CLR(var, mask) (void)atomic_fetch_and_explicit(&(var), ~(unsigned long)(mask), memory_order_release)
+#define ENG_TAKE(var)      (uint32_t)atomic_exchange_explicit(&(var), 0, memory_order_acquire)
+#endif /* LWRB_DISABLE_ATOMIC */
+
+/**
+ * \brief           Get index of the lowest bit set in the mask
+ * \param[in]       mask: Bit mask. Must not be `0`
+ * \return          Bit index
+ */
+static uint8_t
+prv_bit_idx(uint32_t mask) {
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_ctz(mask);
+#else
+    uint8_t idx = 0;
+
+    for (; (mask & 0x01U) == 0; mask >>= 1, ++idx) {}
+    return idx;
+#endif /* defined(__GNUC__) */
+}
+
+/**
+ * \brief           RX buffer event function, marks channel as ready on new data
+ * \param[in]       buff: RX buffer of the channel
+ * \param[in]       evt: Buffer event type
+ * \param[in]       bp: Number of bytes written or read
+ */
+static void
+prv_rx_evt_fn(lwrb_t* buff, lwrb_evt_type_t evt, size_t bp) {
+    lwpkt_engine_ch_t* ch;
+
+    if (evt == LWRB_EVT_WRITE && bp > 0 && (ch = lwrb_get_arg(buff)) != NULL) {
+        ENG_SET(ch->eng->ready, ENG_BIT(ch - ch->eng->ch));
+    }
+}
+
+/**
+ * \brief           Remove channel from the timer wheel
+ * \param[in]       eng: Engine instance
+ * \param[in]       idx: Channel index
+ */
+static void
+prv_disarm(lwpkt_engine_t* eng, uint8_t idx) {
+    if (eng->armed & ENG_BIT(idx)) {
+        eng->wheel[eng->ch[idx].slot] &= ~ENG_BIT(idx);
+        eng->armed &= ~ENG_BIT(idx);
+    }
+}
+
+/**
+ * \brief           Insert channel to the timer wheel
+ *
+ * Channel is placed to the slot of the first tick, that starts at or after deadline time.
+ * When that slot is processed, deadline is guaranteed to be reached,
+ * unless deadline is more than one wheel turn away.
+ *
+ * \param[in]       eng: Engine instance
+ * \param[in]       idx: Channel index
+ * \param[in]       deadline: Timeout time in units of time argument of \ref lwpkt_process
+ */
+static void
+prv_arm(lwpkt_engine_t* eng, uint8_t idx, uint32_t deadline) {
+    lwpkt_engine_ch_t* ch = &eng->ch[idx];
+    uint32_t tick;
+
+    if ((eng->armed & ENG_BIT(idx)) && ch->deadline == deadline) {
+        return;
+    }
+    prv_disarm(eng, idx);
+
+    /* Rounded up, but never to the tick, that has been processed already */
+    tick = deadline / LWPKT_CFG_ENGINE_WHEEL_TICK + ((deadline % LWPKT_CFG_ENGINE_WHEEL_TICK) > 0);
+    if ((int32_t)(tick - eng->tick) <= 0) {
+        tick = eng->tick + 1;
+    }
+    ch->deadline = deadline;
+    ch->slot = (uint8_t)(tick % LWPKT_CFG_ENGINE_WHEEL_SLOTS);
+    eng->wheel[ch->slot] |= ENG_BIT(idx);
+    eng->armed |= ENG_BIT(idx);
+}
+
+/**
+ * \brief           Initialize engine instance
+ * \param[in]       eng: Engine instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_engine_init(lwpkt_engine_t* eng) {
+    if (eng == NULL) {
+        return lwpktERR;
+    }
+    memset(eng, 0x00, sizeof(*eng));
+    ENG_INIT(eng->ready, 0);
+    return lwpktOK;
+}
+
+/**
+ * \brief           Add packet instance to the engine
+ *
+ * Engine takes over event function and custom argument of the instance RX buffer,
+ * to get notified when new data are written to it.
+ * Instance is processed on next \ref lwpkt_engine_process call,
+ * to handle data already available in RX buffer.
+ *
+ * \note            Data must be written to RX buffer with \ref lwrb_write or \ref lwrb_advance,
+ *                  for the channel to be marked as ready
+ * \param[in]       eng: Engine instance
+ * \param[in]       pkt: Initialized packet instance
+ * \return          \ref lwpktOK on success, \ref lwpktERRMEM if all channels are used,
+ *                      member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_engine_add(lwpkt_engine_t* eng, lwpkt_t* pkt) {
+    lwpkt_engine_ch_t* ch = NULL;
+
+    if (eng == NULL || pkt == NULL || pkt->rx_rb == NULL) {
+        return lwpktERR;
+    }
+    for (size_t idx = 0; idx < LWPKT_CFG_ENGINE_CHANNELS; ++idx) {
+        if (eng->ch[idx].pkt == pkt) {
+            return lwpktERR;
+        } else if (eng->ch[idx].pkt == NULL && ch == NULL) {
+            ch = &eng->ch[idx];
+        }
+    }
+    if (ch == NULL) {
+        return lwpktERRMEM;
+    }
+    ch->pkt = pkt;
+    ch->eng = eng;
+    lwrb_set_arg(pkt->rx_rb, ch);
+    lwrb_set_evt_fn(pkt->rx_rb, prv_rx_evt_fn);
+    ENG_SET(eng->ready, ENG_BIT(ch - eng->ch));
+    return lwpktOK;
+}
+
+/**
+ * \brief           Remove packet instance from the engine
+ *
+ * Event function and custom argument of the instance RX buffer are cleared
+ *
+ * \param[in]       eng: Engine instance
+ * \param[in]       pkt: Packet instance, previously added with \ref lwpkt_engine_add
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_engine_remove(lwpkt_engine_t* eng, lwpkt_t* pkt) {
+    if (eng == NULL || pkt == NULL) {
+        return lwpktERR;
+    }
+    for (uint8_t idx = 0; idx < LWPKT_CFG_ENGINE_CHANNELS; ++idx) {
+        if (eng->ch[idx].pkt == pkt) {
+            lwrb_set_evt_fn(pkt->rx_rb, NULL);
+            lwrb_set_arg(pkt->rx_rb, NULL);
+            ENG_CLR(eng->ready, ENG_BIT(idx));
+            prv_disarm(eng, idx);
+            eng->ch[idx].pkt = NULL;
+            return lwpktOK;
+        }
+    }
+    return lwpktERR;
+}
+
+/**
+ * \brief           Process all channels with new data or expired timeout
+ *
+ * Every serviced channel is processed with \ref lwpkt_process,
+ * hence packet and timeout events are sent to the event function of each instance.
+ * At most one packet is read per channel in one call.
+ *
+ * \param[in]       eng: Engine instance
+ * \param[in]       time: Current time in units of time argument of \ref lwpkt_process,
+ *                      same time base as used for all registered instances
+ * \return          \ref lwpktOK if all channels have been serviced,
+ *                      \ref lwpktINPROG if some channels still have data to process,
+ *                      member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_engine_process(lwpkt_engine_t* eng, uint32_t time) {
+    lwpkt_engine_ch_t* ch;
+    lwpktr_t res;
+    uint32_t work = 0, mask, tick, cnt;
+    uint8_t idx;
+
+    if (eng == NULL) {
+        return lwpktERR;
+    }
+
+    /* Advance timer wheel and collect channels with reached deadline */
+    tick = time / LWPKT_CFG_ENGINE_WHEEL_TICK;
+    cnt = tick - eng->tick;
+    if (cnt > LWPKT_CFG_ENGINE_WHEEL_SLOTS) {
+        cnt = LWPKT_CFG_ENGINE_WHEEL_SLOTS;
+    }
+    for (; cnt > 0; --cnt) {
+        mask = eng->wheel[(tick - cnt + 1) % LWPKT_CFG_ENGINE_WHEEL_SLOTS];
+        for (; mask != 0; mask &= mask - 1) {
+            idx = prv_bit_idx(mask);
+            if ((int32_t)(time - eng->ch[idx].deadline) >= 0) {
+                prv_disarm(eng, idx);
+                work |= ENG_BIT(idx);
+            }
+        }
+    }
+    eng->tick = tick;
+
+    /* Channels with packet in progress and idle line are serviced immediately */
+    for (mask = eng->armed; mask != 0; mask &= mask - 1) {
+        idx = prv_bit_idx(mask);
+        if (eng->ch[idx].pkt->rx_idle_seq != eng->ch[idx].pkt->rx_idle_seen) {
+            work |= ENG_BIT(idx);
+        }
+    }
+
+    /* Service channels */
+    work |= ENG_TAKE(eng->ready);
+    for (; work != 0; work &= work - 1) {
+        idx = prv_bit_idx(work);
+        ch = &eng->ch[idx];
+        if (ch->pkt == NULL) {
+            continue;
+        }
+        res = lwpkt_process(ch->pkt, time);
+
+        /* Packet has been read or dropped, more data may be waiting in the buffer */
+        if (res != lwpktWAITDATA && res != lwpktINPROG) {
+            ENG_SET(eng->ready, ENG_BIT(idx));
+        }
+
+        /* Same timeout as checked by the process function */
+        if (ch->pkt->m.state != LWPKT_STATE_START) {
+            prv_arm(eng, idx, ch->pkt->last_rx_time + ch->pkt->timeout);
+        } else {
+            prv_disarm(eng, idx);
+        }
+    }
+    return ENG_LOAD(eng->ready) != 0 ? lwpktINPROG : lwpktOK;
+}
+
+#endif /* LWPKT_CFG_USE_ENGINE || __DOXYGEN__ */
@@ -0,0 +1,351 @@
+/**
+ * \file            lwpkt_frag.c
+ * \brief           Fragmentation and reassembly of large messages
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#include <stdint.h>
+#include <string.h>
+#include "lwpkt/lwpkt_frag.h"
+
+#if LWPKT_CFG_USE_FRAG || __DOXYGEN__
+
+/* Validate user configuration */
+#if LWPKT_CFG_FRAG_MAX_CNT < 1 || LWPKT_CFG_FRAG_MAX_CNT > 0xFFFF
+#error "LWPKT_CFG_FRAG_MAX_CNT must be set between 1 and 65535"
+#endif
+
+#define FRAG_MIN(x, y)       ((x) < (y) ? (x) : (y))
+#define FRAG_MAP_IS_SET(m, i) (((m)[(i) / 32U] & ((uint32_t)1 << ((i) % 32U))) != 0)
+#define FRAG_MAP_SET(m, i)    (m)[(i) / 32U] |= ((uint32_t)1 << ((i) % 32U))
+
+/**
+ * \brief           Write single fragment of current message
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       idx: Fragment index
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+static lwpktr_t
+prv_frag_write(lwpkt_frag_t* frag, size_t idx) {
+    uint8_t hdr[LWPKT_FRAG_HDR_LEN];
+    lwpkt_seg_t seg[2];
+    size_t off = idx * frag->frag_len;
+
+    hdr[0] = frag->tx.id;
+    hdr[1] = (uint8_t)idx;
+    hdr[2] = (uint8_t)(idx >> 8);
+    hdr[3] = (uint8_t)frag->tx.cnt;
+    hdr[4] = (uint8_t)(frag->tx.cnt >> 8);
+    hdr[5] = (uint8_t)frag->frag_len;
+    hdr[6] = (uint8_t)(frag->frag_len >> 8);
+    seg[0].data = hdr;
+    seg[0].len = sizeof(hdr);
+    seg[1].data = &frag->tx.data[off];
+    seg[1].len = FRAG_MIN(frag->frag_len, frag->tx.len - off);
+    return lwpkt_writev(frag->pkt,
+#if LWPKT_CFG_USE_ADDR
+                        frag->tx.to,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                        frag->tx.flags,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                        frag->tx.cmd,
+#endif /* LWPKT_CFG_USE_CMD */
+                        seg, 2);
+}
+
+/**
+ * \brief           Write remaining fragments of current message, until TX buffer is full
+ * \param[in]       frag: Fragmentation instance
+ * \return          \ref lwpktOK when all fragments are written,
+ *                      \ref lwpktINPROG when some fragments are waiting for memory, member of \ref lwpktr_t otherwise
+ */
+static lwpktr_t
+prv_frag_write_pending(lwpkt_frag_t* frag) {
+    lwpktr_t res;
+
+    while (frag->tx.idx < frag->tx.cnt) {
+        res = prv_frag_write(frag, frag->tx.idx);
+        if (res == lwpktERRMEM) {
+            return lwpktINPROG;
+        } else if (res != lwpktOK) {
+            return res;
+        }
+        ++frag->tx.idx;
+    }
+    return lwpktOK;
+}
+
+/**
+ * \brief           Copy bytes of received packet data part
+ * \param[in]       seg: Data part of the packet, in `2` segments
+ * \param[in]       off: Offset in data part
+ * \param[out]      dst: Destination memory
+ * \param[in]       len: Number of bytes to copy
+ */
+static void
+prv_frag_copy(const lwpkt_seg_t* seg, size_t off, uint8_t* dst, size_t len) {
+    for (size_t i = 0, cnt; i < 2 && len > 0; ++i) {
+        if (off >= seg[i].len) {
+            off -= seg[i].len;
+            continue;
+        }
+        cnt = FRAG_MIN(len, seg[i].len - off);
+        memcpy(dst, &((const uint8_t*)seg[i].data)[off], cnt);
+        dst += cnt;
+        len -= cnt;
+        off = 0;
+    }
+}
+
+/**
+ * \brief           Initialize fragmentation instance
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       pkt: Initialized packet instance, used to write and read fragments
+ * \param[in]       frag_len: Maximum number of message bytes in one fragment.
+ *                      Fragment header of \ref LWPKT_FRAG_HDR_LEN bytes is added to it in each packet
+ * \param[in]       rx_buff: Memory for received messages. Set to `NULL` to only transmit
+ * \param[in]       rx_size: Size of `rx_buff` memory, maximum length of received message
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_frag_init(lwpkt_frag_t* frag, lwpkt_t* pkt, size_t frag_len, void* rx_buff, size_t rx_size) {
+    if (frag == NULL || pkt == NULL || frag_len == 0 || frag_len > 0xFFFFU || (rx_buff == NULL && rx_size > 0)) {
+        return lwpktERR;
+    }
+    memset(frag, 0x00, sizeof(*frag));
+    frag->pkt = pkt;
+    frag->frag_len = frag_len;
+    frag->timeout = LWPKT_CFG_FRAG_TIMEOUT;
+    frag->rx.buff = rx_buff;
+    frag->rx.size = rx_size;
+    return lwpktOK;
+}
+
+/**
+ * \brief           Set timeout of received message in progress, checked by \ref lwpkt_frag_process
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       timeout: Maximum time between received fragments, in units of process time argument
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_frag_set_timeout(lwpkt_frag_t* frag, uint32_t timeout) {
+    if (frag == NULL) {
+        return lwpktERR;
+    }
+    frag->timeout = timeout;
+    return lwpktOK;
+}
+
+/**
+ * \brief           Write message, split to fragments of maximum length, set at initialization
+ *
+ * Fragments, that do not fit to the TX buffer, are written by \ref lwpkt_frag_process.
+ *
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       to: End device address
+ * \param[in]       flags: Custom user flags
+ * \param[in]       cmd: Packet command
+ * \param[in]       data: Message data. Memory must stay valid until all fragments are written,
+ *                      or until last resend with \ref lwpkt_frag_resend
+ * \param[in]       len: Message length
+ * \return          \ref lwpktOK when all fragments are written,
+ *                      \ref lwpktINPROG when some fragments are waiting for memory in TX buffer,
+ *                      \ref lwpktERRMEM if message has more than \ref LWPKT_CFG_FRAG_MAX_CNT fragments,
+ *                      member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_frag_write(lwpkt_frag_t* frag,
+#if LWPKT_CFG_USE_ADDR || __DOXYGEN__
+                 lwpkt_addr_t to,
+#endif /* LWPKT_CFG_USE_ADDR || __DOXYGEN__ */
+#if LWPKT_CFG_USE_FLAGS || __DOXYGEN__
+                 uint32_t flags,
+#endif /* LWPKT_CFG_USE_FLAGS || __DOXYGEN__ */
+#if LWPKT_CFG_USE_CMD || __DOXYGEN__
+                 uint32_t cmd,
+#endif /* LWPKT_CFG_USE_CMD || __DOXYGEN__ */
+                 const void* data, size_t len) {
+    size_t cnt;
+
+    if (frag == NULL || (data == NULL && len > 0) || frag->tx.idx < frag->tx.cnt) {
+        return lwpktERR; /* Previous message must be written first */
+    }
+    cnt = len > 0 ? (len + frag->frag_len - 1U) / frag->frag_len : 1U;
+    if (cnt > LWPKT_CFG_FRAG_MAX_CNT) {
+        return lwpktERRMEM;
+    }
+    frag->tx.data = data;
+    frag->tx.len = len;
+    frag->tx.idx = 0;
+    frag->tx.cnt = cnt;
+#if LWPKT_CFG_USE_ADDR
+    frag->tx.to = to;
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+    frag->tx.flags = flags;
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+    frag->tx.cmd = cmd;
+#endif /* LWPKT_CFG_USE_CMD */
+    ++frag->tx.id;
+    return prv_frag_write_pending(frag);
+}
+
+/**
+ * \brief           Write single fragment of last message again, for example when receiver reports it missing
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       idx: Fragment index
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_frag_resend(lwpkt_frag_t* frag, size_t idx) {
+    if (frag == NULL || idx >= frag->tx.cnt || idx >= frag->tx.idx) {
+        return lwpktERR;
+    }
+    return prv_frag_write(frag, idx);
+}
+
+/**
+ * \brief           Process data part of valid packet, received by the packet instance, as message fragment
+ *
+ * Call the function after \ref lwpkt_read returned \ref lwpktVALID, or on \ref LWPKT_EVT_PKT event.
+ * Fragments may be received in any order. Fragment of new message aborts the message in progress.
+ *
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       time: Current time
+ * \return          \ref lwpktVALID when message is complete,
+ *                      \ref lwpktINPROG when fragment has been stored and message is not complete yet,
+ *                      \ref lwpktOK when fragment of already complete message has been ignored,
+ *                      \ref lwpktERRMEM when message does not fit to the memory,
+ *                      member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_frag_input(lwpkt_frag_t* frag, uint32_t time) {
+    uint8_t hdr[LWPKT_FRAG_HDR_LEN];
+    lwpkt_seg_t seg[2];
+    size_t len, idx, cnt, frag_len, off;
+
+    if (frag == NULL || frag->rx.buff == NULL) {
+        return lwpktERR;
+    }
+    len = lwpkt_get_data_len(frag->pkt);
+#if LWPKT_CFG_RX_ZERO_COPY
+    lwpkt_get_view(frag->pkt, seg);
+#else  /* LWPKT_CFG_RX_ZERO_COPY */
+    seg[0].data = lwpkt_get_data(frag->pkt);
+    seg[0].len = len;
+    seg[1].data = NULL;
+    seg[1].len = 0;
+#endif /* !LWPKT_CFG_RX_ZERO_COPY */
+    if (len < LWPKT_FRAG_HDR_LEN) {
+        return lwpktERR;
+    }
+    prv_frag_copy(seg, 0, hdr, sizeof(hdr));
+    idx = (size_t)hdr[1] | ((size_t)hdr[2] << 8);
+    cnt = (size_t)hdr[3] | ((size_t)hdr[4] << 8);
+    frag_len = (size_t)hdr[5] | ((size_t)hdr[6] << 8);
+    len -= LWPKT_FRAG_HDR_LEN;
+
+    /* All fragments, except the last one, have maximum length */
+    if (idx >= cnt || (idx + 1U < cnt && len != frag_len) || len > frag_len) {
+        return lwpktERR;
+    }
+    off = idx * frag_len;
+    if (cnt > LWPKT_CFG_FRAG_MAX_CNT || off + len > frag->rx.size) {
+        return lwpktERRMEM;
+    }
+
+    /* Fragment of other message aborts current one */
+    if (frag->rx.active && (hdr[0] != frag->rx.id || cnt != frag->rx.cnt || frag_len != frag->rx.frag_len)) {
+        frag->rx.active = 0;
+        ++frag->rx.lost;
+    }
+    if (!frag->rx.active) {
+        if (frag->rx.done && hdr[0] == frag->rx.id) {
+            return lwpktOK; /* Resent fragment of complete message */
+        }
+        memset(frag->rx.map, 0x00, sizeof(frag->rx.map));
+        frag->rx.id = hdr[0];
+        frag->rx.cnt = cnt;
+        frag->rx.frag_len = frag_len;
+        frag->rx.rcvd = 0;
+        frag->rx.len = 0;
+        frag->rx.active = 1;
+        frag->rx.done = 0;
+    }
+    frag->rx.time = time;
+    if (FRAG_MAP_IS_SET(frag->rx.map, idx)) {
+        return lwpktINPROG;
+    }
+    prv_frag_copy(seg, LWPKT_FRAG_HDR_LEN, &frag->rx.buff[off], len);
+    FRAG_MAP_SET(frag->rx.map, idx);
+    if (idx + 1U == cnt) {
+        frag->rx.len = off + len;
+    }
+    if (++frag->rx.rcvd == cnt) {
+        frag->rx.active = 0;
+        frag->rx.done = 1;
+        return lwpktVALID;
+    }
+    return lwpktINPROG;
+}
+
+/**
+ * \brief           Write pending fragments of transmit message and check timeout of receive message
+ *
+ * Receive message is aborted, when next fragment is not received within timeout.
+ * Missing fragments are the ones not set in the bitmap of receive state.
+ *
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       time: Current time, in units of the timeout
+ * \return          \ref lwpktINPROG when transmit or receive message is in progress,
+ *                      \ref lwpktOK otherwise, member of \ref lwpktr_t on write error
+ */
+lwpktr_t
+lwpkt_frag_process(lwpkt_frag_t* frag, uint32_t time) {
+    lwpktr_t res;
+
+    if (frag == NULL) {
+        return lwpktERR;
+    }
+    res = prv_frag_write_pending(frag);
+    if (frag->rx.active && (time - frag->rx.time) >= frag->timeout) {
+        frag->rx.active = 0;
+        ++frag->rx.lost;
+    }
+    if (res == lwpktOK && frag->rx.active) {
+        res = lwpktINPROG;
+    }
+    return res;
+}
+
+#endif /* LWPKT_CFG_USE_FRAG || __DOXYGEN__ */
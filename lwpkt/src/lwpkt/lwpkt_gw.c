@@ -0,0 +1,409 @@
+/**
+ * \file            lwpkt_gw.c
+ * \brief           Linux gateway for many packet streams
+ */
+
+/*
+ * Copyright (c) 2024 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of LwPKT - Lightweight packet protocol library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         v1.3.0
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* CPU affinity of worker threads */
+#endif              /* _GNU_SOURCE */
+#include <stdint.h>
+#include <string.h>
+#include "lwpkt/lwpkt_gw.h"
+#include "lwrb/lwrb.h"
+
+#if LWPKT_CFG_USE_GW || __DOXYGEN__
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Validate user configuration */
+#if !defined(__linux__)
+#error "LWPKT_CFG_USE_GW must be disabled if target is not Linux"
+#endif
+#ifdef LWRB_DISABLE_ATOMIC
+#error "LWPKT_CFG_USE_GW must be disabled if LWRB_DISABLE_ATOMIC is defined"
+#endif
+#if LWPKT_CFG_GW_WORKERS < 1 || LWPKT_CFG_GW_WORKERS > 255
+#error "LWPKT_CFG_GW_WORKERS must be set between 1 and 255"
+#endif
+#if LWPKT_CFG_GW_STREAMS < 1
+#error "LWPKT_CFG_GW_STREAMS must be greater than 0"
+#endif
+#if LWPKT_CFG_GW_TICK < 1
+#error "LWPKT_CFG_GW_TICK must be greater than 0"
+#endif
+
+/* Maximum number of events, taken from event poll at once */
+#define GW_EVENTS 16
+
+/**
+ * \brief           Get monotonic time
+ * \return          Time in units of milliseconds
+ */
+static uint32_t
+prv_get_time(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U);
+}
+
+/**
+ * \brief           Close the stream on end of file or read error.
+ *                  File descriptor is removed from event poll, but is not closed
+ * \param[in]       gw: Gateway instance
+ * \param[in]       st: Stream to close
+ */
+static void
+prv_stream_close(lwpkt_gw_t* gw, lwpkt_gw_stream_t* st) {
+    epoll_ctl(gw->worker[st->worker].epfd, EPOLL_CTL_DEL, st->fd, NULL);
+    st->pending = 0;
+    st->open = 0;
+    atomic_fetch_sub_explicit(&gw->open, 1, memory_order_release);
+}
+
+/**
+ * \brief           Read available data from file descriptor directly to free memory of RX buffer
+ *
+ * Free memory may wrap around the end of the buffer, both parts are read with single call.
+ *
+ * \param[in]       gw: Gateway instance
+ * \param[in]       st: Stream to read
+ * \return          `1` if bytes have been read, `0` otherwise
+ */
+static uint8_t
+prv_stream_read(lwpkt_gw_t* gw, lwpkt_gw_stream_t* st) {
+    lwrb_t* rb = st->pkt->rx_rb;
+    struct iovec iov[2];
+    size_t avail;
+    ssize_t len;
+
+    if ((avail = lwrb_get_free(rb)) == 0) {
+        return 0; /* Data stay in kernel buffer, until packets are processed */
+    }
+    iov[0].iov_base = lwrb_get_linear_block_write_address(rb);
+    iov[0].iov_len = lwrb_get_linear_block_write_length(rb);
+    iov[1].iov_base = rb->buff;
+    iov[1].iov_len = avail - iov[0].iov_len;
+    do {
+        len = readv(st->fd, iov, iov[1].iov_len > 0 ? 2 : 1);
+    } while (len < 0 && errno == EINTR);
+
+    if (len > 0) {
+        lwrb_advance(rb, (size_t)len);
+        return 1;
+    } else if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        prv_stream_close(gw, st);
+    }
+    st->pending = 0;
+    return 0;
+}
+
+/**
+ * \brief           Read stream and process its packet instance, until no more data can be read
+ *
+ * Packets are not processed, while receive packet queue is full.
+ * Data are kept in RX buffer, and once it is full, in kernel buffer of the file descriptor.
+ *
+ * \param[in]       gw: Gateway instance
+ * \param[in]       st: Stream to service
+ * \param[in]       time: Current time in units of milliseconds
+ */
+static void
+prv_stream_service(lwpkt_gw_t* gw, lwpkt_gw_stream_t* st, uint32_t time) {
+    lwpktr_t res;
+    uint8_t rd;
+
+    do {
+        rd = st->pending ? prv_stream_read(gw, st) : 0;
+        for (;;) {
+#if LWPKT_CFG_RX_QUEUE
+            if (lwpkt_rxq_get_count(st->pkt) == LWPKT_CFG_RX_QUEUE) {
+                break;
+            }
+#endif /* LWPKT_CFG_RX_QUEUE */
+            res = lwpkt_process(st->pkt, time);
+            if (res == lwpktWAITDATA || res == lwpktINPROG || res == lwpktERR) {
+                break;
+            }
+        }
+    } while (rd);
+}
+
+/**
+ * \brief           Worker thread, reads and processes its streams
+ * \param[in]       arg: Worker instance
+ * \return          `NULL`
+ */
+static void*
+prv_worker_thread(void* arg) {
+    lwpkt_gw_worker_t* wk = arg;
+    lwpkt_gw_t* gw = wk->gw;
+    struct epoll_event evt[GW_EVENTS];
+    uint32_t time, tick_time;
+    uint8_t stop = 0;
+    int cnt;
+
+    tick_time = prv_get_time();
+    while (!stop) {
+        cnt = epoll_wait(wk->epfd, evt, GW_EVENTS, LWPKT_CFG_GW_TICK);
+        time = prv_get_time();
+        for (int i = 0; i < cnt; ++i) {
+            lwpkt_gw_stream_t* st = evt[i].data.ptr;
+
+            if (st == NULL) {
+                stop = 1;
+            } else if (st->open) {
+                st->pending = 1;
+                prv_stream_service(gw, st, time);
+            }
+        }
+
+        /* All streams of the worker, for timeouts and for streams waiting for packet queue */
+        if ((time - tick_time) >= LWPKT_CFG_GW_TICK) {
+            tick_time = time;
+            for (size_t idx = (size_t)(wk - gw->worker); idx < gw->stream_cnt; idx += gw->worker_cnt) {
+                prv_stream_service(gw, &gw->stream[idx], time);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Stop and join worker threads and close their event poll file descriptors
+ * \param[in]       gw: Gateway instance
+ * \param[in]       cnt: Number of workers with running thread
+ */
+static void
+prv_gw_cleanup(lwpkt_gw_t* gw, size_t cnt) {
+    uint64_t val = 1;
+
+    if (gw->stop_fd >= 0) {
+        while (write(gw->stop_fd, &val, sizeof(val)) < 0 && errno == EINTR) {}
+    }
+    for (size_t idx = 0; idx < gw->worker_cnt; ++idx) {
+        if (idx < cnt) {
+            pthread_join(gw->worker[idx].thread, NULL);
+        }
+        if (gw->worker[idx].epfd >= 0) {
+            close(gw->worker[idx].epfd);
+            gw->worker[idx].epfd = -1;
+        }
+    }
+    if (gw->stop_fd >= 0) {
+        close(gw->stop_fd);
+        gw->stop_fd = -1;
+    }
+}
+
+/**
+ * \brief           Initialize gateway instance
+ * \param[in]       gw: Gateway instance
+ * \param[in]       workers: Number of worker threads, between `1` and \ref LWPKT_CFG_GW_WORKERS
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_gw_init(lwpkt_gw_t* gw, size_t workers) {
+    if (gw == NULL || workers < 1 || workers > LWPKT_CFG_GW_WORKERS) {
+        return lwpktERR;
+    }
+    memset(gw, 0x00, sizeof(*gw));
+    gw->worker_cnt = workers;
+    gw->stop_fd = -1;
+    for (size_t idx = 0; idx < workers; ++idx) {
+        gw->worker[idx].gw = gw;
+        gw->worker[idx].epfd = -1;
+        gw->worker[idx].cpu = -1;
+    }
+    atomic_init(&gw->open, 0);
+    return lwpktOK;
+}
+
+/**
+ * \brief           Bind worker thread to the CPU
+ * \note            Function must be called before \ref lwpkt_gw_start
+ * \param[in]       gw: Gateway instance
+ * \param[in]       worker: Worker index
+ * \param[in]       cpu: CPU index. Use `-1` for no affinity
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_gw_set_affinity(lwpkt_gw_t* gw, size_t worker, int cpu) {
+    if (gw == NULL || gw->running || worker >= gw->worker_cnt || cpu < -1 || cpu >= CPU_SETSIZE) {
+        return lwpktERR;
+    }
+    gw->worker[worker].cpu = cpu;
+    return lwpktOK;
+}
+
+/**
+ * \brief           Add stream to the gateway
+ *
+ * Streams are assigned to the workers in order of addition. Stream is always read and processed
+ * by the same worker thread, hence packet and timeout events of the instance are sent from that thread.
+ * File descriptor is set to non-blocking mode.
+ *
+ * \note            Function must be called before \ref lwpkt_gw_start.
+ *                  RX buffer of the instance must not be written by the application anymore
+ * \param[in]       gw: Gateway instance
+ * \param[in]       pkt: Initialized packet instance
+ * \param[in]       fd: File descriptor of serial port, socket or pipe, to read data from
+ * \return          \ref lwpktOK on success, \ref lwpktERRMEM if all streams are used,
+ *                      member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_gw_add(lwpkt_gw_t* gw, lwpkt_t* pkt, int fd) {
+    lwpkt_gw_stream_t* st;
+    int fl;
+
+    if (gw == NULL || gw->running || pkt == NULL || pkt->rx_rb == NULL || fd < 0) {
+        return lwpktERR;
+    }
+    for (size_t idx = 0; idx < gw->stream_cnt; ++idx) {
+        if (gw->stream[idx].pkt == pkt) {
+            return lwpktERR;
+        }
+    }
+    if (gw->stream_cnt == LWPKT_CFG_GW_STREAMS) {
+        return lwpktERRMEM;
+    }
+    if ((fl = fcntl(fd, F_GETFL)) < 0 || fcntl(fd, F_SETFL, fl | O_NONBLOCK) < 0) {
+        return lwpktERR;
+    }
+    st = &gw->stream[gw->stream_cnt];
+    st->pkt = pkt;
+    st->fd = fd;
+    st->worker = (uint8_t)(gw->stream_cnt % gw->worker_cnt);
+    st->pending = 1;
+    st->open = 1;
+    ++gw->stream_cnt;
+    atomic_fetch_add_explicit(&gw->open, 1, memory_order_relaxed);
+    return lwpktOK;
+}
+
+/**
+ * \brief           Start worker threads
+ * \param[in]       gw: Gateway instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_gw_start(lwpkt_gw_t* gw) {
+    struct epoll_event evt;
+    lwpkt_gw_worker_t* wk;
+    pthread_attr_t attr;
+    cpu_set_t cpus;
+    size_t started = 0;
+    int ok;
+
+    if (gw == NULL || gw->worker_cnt == 0 || gw->running) {
+        return lwpktERR;
+    }
+    if ((gw->stop_fd = eventfd(0, EFD_CLOEXEC)) < 0) {
+        return lwpktERR;
+    }
+
+    /* Stop event is level triggered and wakes up all workers, streams are edge triggered */
+    for (size_t idx = 0; idx < gw->worker_cnt; ++idx) {
+        wk = &gw->worker[idx];
+        ok = (wk->epfd = epoll_create1(EPOLL_CLOEXEC)) >= 0;
+        evt.events = EPOLLIN;
+        evt.data.ptr = NULL;
+        ok = ok && epoll_ctl(wk->epfd, EPOLL_CTL_ADD, gw->stop_fd, &evt) == 0;
+        for (size_t i = idx; ok && i < gw->stream_cnt; i += gw->worker_cnt) {
+            evt.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+            evt.data.ptr = &gw->stream[i];
+            ok = !gw->stream[i].open || epoll_ctl(wk->epfd, EPOLL_CTL_ADD, gw->stream[i].fd, &evt) == 0;
+        }
+        if (!ok) {
+            prv_gw_cleanup(gw, 0);
+            return lwpktERR;
+        }
+    }
+
+    /* Threads start on their CPU, when affinity is set */
+    for (; started < gw->worker_cnt; ++started) {
+        wk = &gw->worker[started];
+        ok = pthread_attr_init(&attr) == 0;
+        if (ok && wk->cpu >= 0) {
+            CPU_ZERO(&cpus);
+            CPU_SET((size_t)wk->cpu, &cpus);
+            ok = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) == 0;
+        }
+        ok = ok && pthread_create(&wk->thread, &attr, prv_worker_thread, wk) == 0;
+        pthread_attr_destroy(&attr);
+        if (!ok) {
+            prv_gw_cleanup(gw, started);
+            return lwpktERR;
+        }
+    }
+    gw->running = 1;
+    return lwpktOK;
+}
+
+/**
+ * \brief           Stop worker threads and wait for them to finish.
+ *                  File descriptors of the streams are not closed
+ * \param[in]       gw: Gateway instance
+ * \return          \ref lwpktOK on success, member of \ref lwpktr_t otherwise
+ */
+lwpktr_t
+lwpkt_gw_stop(lwpkt_gw_t* gw) {
+    if (gw == NULL || !gw->running) {
+        return lwpktERR;
+    }
+    prv_gw_cleanup(gw, gw->worker_cnt);
+    gw->running = 0;
+    return lwpktOK;
+}
+
+/**
+ * \brief           Get number of streams, which have not reached end of file or read error
+ *
+ * Function can be called from any thread, while workers are running.
+ *
+ * \param[in]       gw: Gateway instance
+ * \return          Number of open streams
+ */
+size_t
+lwpkt_gw_get_open(lwpkt_gw_t* gw) {
+    if (gw == NULL) {
+        return 0;
+    }
+    return (size_t)atomic_load_explicit(&gw->open, memory_order_acquire);
+}
+
+#endif /* LWPKT_CFG_USE_GW || __DOXYGEN__ */
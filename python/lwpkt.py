@@ -1,10 +1,23 @@
-import enum, struct, queue
+import enum, struct, queue, zlib
 
 '''
 This file is currently in the development 
 and shall not be used by the final application
 '''
 
+# Build lookup table for reflected CRC with given polynomial
+def _crc_table(poly:int) -> tuple:
+    table = []
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ poly if crc & 0x01 else crc >> 1
+        table.append(crc)
+    return tuple(table)
+
+_CRC8_TABLE = _crc_table(0x8C)
+_CRC32_TABLE = _crc_table(0xEDB88320)
+
 class LwPKT(object):
     class LwPKT_Packet(object):
 
@@ -47,8 +60,14 @@ class LwPKT(object):
         self.opt_crc = True
         self.opt_crc32 = True
         self.opt_flags = True
+        self.opt_cobs = False
+        self.opt_resync = False
+        self.opt_max_data_len = 256
         self.our_addr = 0
 
+        # Contains raw COBS frame, until delimiter is received
+        self.rx_cobs = bytearray()
+
         # Contains raw RX bytes
         self.rx_data = queue.Queue()
 
@@ -102,9 +121,45 @@ class LwPKT(object):
             else:
                 data_out.append(crc)
 
+        # COBS framing replaces start and stop bytes with delimiter
+        if self.opt_cobs:
+            return self.cobs_encode(data_out[1:]) + b'\x00'
+
         # Packet ends here
         data_out.append(0x55)
         return data_out
+
+    # Encode data with COBS, without delimiter
+    def cobs_encode(self, data:bytes) -> bytearray:
+        out = bytearray([0])
+        code_idx = 0
+        code = 1
+        for val in data:
+            if val != 0:
+                out.append(val)
+                code += 1
+            if val == 0 or code == 0xFF:
+                out[code_idx] = code
+                code_idx = len(out)
+                out.append(0)
+                code = 1
+        out[code_idx] = code
+        return out
+
+    # Decode COBS frame, without delimiter. Returns None if frame is not valid
+    def cobs_decode(self, data:bytes) -> bytearray|None:
+        out = bytearray()
+        idx = 0
+        while idx < len(data):
+            code = data[idx]
+            idx += 1
+            if code == 0 or idx + code - 1 > len(data):
+                return None
+            out += data[idx:idx + code - 1]
+            idx += code - 1
+            if code < 0xFF and idx < len(data):
+                out.append(0)
+        return out
     
     # Encode variable integer to bytes, little endian first
     def varint_encode(self, num:int) -> bytes:
@@ -122,14 +177,19 @@ class LwPKT(object):
     # Add crc entry and calculate output
     # Aim is to get single byte entry
     def crc_in(self, crc_old_val:int, new_byt:int) -> int:
-        for i in range(8):
-            m = (crc_old_val ^ new_byt) & 0x01
-            crc_old_val = crc_old_val >> 1
-            if m:
-                crc_old_val = crc_old_val ^ (0xEDB88320 if self.opt_crc32 else 0x8C)
-            new_byt = new_byt >> 1
-        return crc_old_val
-    
+        if self.opt_crc32:
+            return (crc_old_val >> 8) ^ _CRC32_TABLE[(crc_old_val ^ new_byt) & 0xFF]
+        return _CRC8_TABLE[(crc_old_val ^ new_byt) & 0xFF]
+
+    # Calculate CRC of data block, including final XOR value
+    def crc_block(self, data) -> int:
+        if self.opt_crc32:
+            return zlib.crc32(data)
+        crc = 0
+        for val in data:
+            crc = _CRC8_TABLE[crc ^ val]
+        return crc
+
     # Write RX data to packet 
     def write_rx_data(self, data:bytearray):
         for d in data: self.rx_data.put_nowait(d)
@@ -149,92 +209,235 @@ class LwPKT(object):
         while not self.rx_data.empty():
             ch = self.rx_data.get_nowait()
 
-            match self.rx.state:
-                case LwPKT.LwPKT_Packet.State.START:
-                    if ch == 0xAA:
-                        self.rx = LwPKT.LwPKT_Packet()
-                        self.rx.crc = 0xFFFFFFFF if self.opt_crc32 else 0
-                        self.rx_go_to_next_state()
+            # Collect full COBS frame and process it with start and stop bytes
+            if self.opt_cobs:
+                if ch != 0:
+                    self.rx_cobs.append(ch)
+                    continue
+                frame = self.cobs_decode(self.rx_cobs)
+                self.rx_cobs = bytearray()
+                if frame is not None and len(frame) > 0:
+                    self.rx.go_to_state(LwPKT.LwPKT_Packet.State.START)
+                    for val in bytes([0xAA]) + frame + bytes([0x55]):
+                        if self.rx_process_byte(val):
+                            ret = True
+                continue
+            if self.rx_process_byte(ch):
+                ret = True
+        return ret
 
-                case LwPKT.LwPKT_Packet.State.FROM:
-                    self.rx.crc = self.crc_in(self.rx.crc, ch)
-                    if self.opt_addr_ext:
-                        self.rx.pkt_from |= (ch & 0x7F) << (7 * self.rx.index)
-                        self.rx.index += 1
-                    else:
-                        self.rx.pkt_from = ch
+    # Process single byte with the state machine
+    # Returns True when packet has been added to the queue
+    def rx_process_byte(self, ch:int) -> bool:
+        ret = False
+        match self.rx.state:
+            case LwPKT.LwPKT_Packet.State.START:
+                if ch == 0xAA:
+                    self.rx = LwPKT.LwPKT_Packet()
+                    self.rx.crc = 0xFFFFFFFF if self.opt_crc32 else 0
+                    self.rx_go_to_next_state()
 
-                    if not self.opt_addr_ext or (ch & 0x80) == 0:
-                        self.rx_go_to_next_state()
+            case LwPKT.LwPKT_Packet.State.FROM:
+                self.rx.crc = self.crc_in(self.rx.crc, ch)
+                if self.opt_addr_ext:
+                    self.rx.pkt_from |= (ch & 0x7F) << (7 * self.rx.index)
+                    self.rx.index += 1
+                else:
+                    self.rx.pkt_from = ch
 
-                case LwPKT.LwPKT_Packet.State.TO:
-                    self.rx.crc = self.crc_in(self.rx.crc, ch)
-                    if self.opt_addr_ext:
-                        self.rx.pkt_to |= (ch & 0x7F) << (7 * self.rx.index)
-                        self.rx.index += 1
-                    else:
-                        self.rx.pkt_to = ch
+                if not self.opt_addr_ext or (ch & 0x80) == 0:
+                    self.rx_go_to_next_state()
 
-                    if not self.opt_addr_ext or (ch & 0x80) == 0:
-                        self.rx_go_to_next_state()
+            case LwPKT.LwPKT_Packet.State.TO:
+                self.rx.crc = self.crc_in(self.rx.crc, ch)
+                if self.opt_addr_ext:
+                    self.rx.pkt_to |= (ch & 0x7F) << (7 * self.rx.index)
+                    self.rx.index += 1
+                else:
+                    self.rx.pkt_to = ch
+
+                if not self.opt_addr_ext or (ch & 0x80) == 0:
+                    self.rx_go_to_next_state()
 
-                case LwPKT.LwPKT_Packet.State.FLAGS:
-                    self.rx.crc = self.crc_in(self.rx.crc, ch)
-                    self.rx.flags |= (ch & 0x7F) << (7 * self.rx.index)
+            case LwPKT.LwPKT_Packet.State.FLAGS:
+                self.rx.crc = self.crc_in(self.rx.crc, ch)
+                self.rx.flags |= (ch & 0x7F) << (7 * self.rx.index)
+                self.rx.index += 1
+                if (ch & 0x80) == 0:
+                    self.rx_go_to_next_state()
+
+            case LwPKT.LwPKT_Packet.State.CMD:
+                self.rx.crc = self.crc_in(self.rx.crc, ch)
+                if self.opt_cmd_ext:
+                    self.rx.cmd |= (ch & 0x7F) << (7 * self.rx.index)
                     self.rx.index += 1
-                    if (ch & 0x80) == 0:
-                        self.rx_go_to_next_state()
+                else:
+                    self.rx.cmd = ch
 
-                case LwPKT.LwPKT_Packet.State.CMD:
-                    self.rx.crc = self.crc_in(self.rx.crc, ch)
-                    if self.opt_cmd_ext:
-                        self.rx.cmd |= (ch & 0x7F) << (7 * self.rx.index)
-                        self.rx.index += 1
-                    else:
-                        self.rx.cmd = ch
+                if not self.opt_cmd_ext or (ch & 0x80) == 0:
+                    self.rx_go_to_next_state()
 
-                    if not self.opt_cmd_ext or (ch & 0x80) == 0:
-                        self.rx_go_to_next_state()
+            case LwPKT.LwPKT_Packet.State.LEN:
+                self.rx.crc = self.crc_in(self.rx.crc, ch)
+                self.rx.len |= (ch & 0x7F) << (7 * self.rx.index)
+                self.rx.index += 1
+                if (ch & 0x80) == 0:
+                    self.rx_go_to_next_state()
+
+            case LwPKT.LwPKT_Packet.State.DATA:
+                self.rx.crc = self.crc_in(self.rx.crc, ch)
+                self.rx.data.append(ch)
+                if len(self.rx.data) == self.rx.len:
+                    self.rx_go_to_next_state()
 
-                case LwPKT.LwPKT_Packet.State.LEN:
-                    self.rx.crc = self.crc_in(self.rx.crc, ch)
-                    self.rx.len |= (ch & 0x7F) << (7 * self.rx.index)
+            case LwPKT.LwPKT_Packet.State.CRC:
+                crc_len = 4 if self.opt_crc32 else 1
+                if self.rx.index < crc_len:
+                    self.rx.crc_recv |= ch << (8 * self.rx.index)
                     self.rx.index += 1
-                    if (ch & 0x80) == 0:
-                        self.rx_go_to_next_state()
 
-                case LwPKT.LwPKT_Packet.State.DATA:
-                    self.rx.crc = self.crc_in(self.rx.crc, ch)
-                    self.rx.data.append(ch)
-                    if len(self.rx.data) == self.rx.len:
+                if self.rx.index == crc_len:
+                    if self.opt_crc32:
+                        self.rx.crc ^= 0xFFFFFFFF
+                    if self.rx.crc == self.rx.crc_recv:
+                        self.rx_go_to_next_state()
+                    else:
                         self.rx_go_to_next_state()
 
-                case LwPKT.LwPKT_Packet.State.CRC:
-                    crc_len = 4 if self.opt_crc32 else 1
-                    if self.rx.index < crc_len:
-                        self.rx.crc_recv |= ch << (8 * self.rx.index)
-                        self.rx.index += 1
-
-                    if self.rx.index == crc_len:
-                        if self.opt_crc32:
-                            self.rx.crc ^= 0xFFFFFFFF
-                        if self.rx.crc == self.rx.crc_recv:
-                            self.rx_go_to_next_state()
-                        else:
-                            self.rx_go_to_next_state()
-
-                case LwPKT.LwPKT_Packet.State.STOP:
-                    self.rx_packets.put_nowait(self.rx)
-                    self.rx_go_to_next_state()
-                    
-                    # At least one packet has been added to queue
-                    ret = True
+            case LwPKT.LwPKT_Packet.State.STOP:
+                self.rx_packets.put_nowait(self.rx)
+                self.rx_go_to_next_state()
+                
+                # At least one packet has been added to queue
+                ret = True
 
-                # Handle default situation
-                case _:
-                    self.rx.go_to_state(LwPKT.LwPKT_Packet.State.START)
+            # Handle default situation
+            case _:
+                self.rx.go_to_state(LwPKT.LwPKT_Packet.State.START)
         return ret
     
+    #
+    # Decode bulk data
+    #
+    def decode(self, data):
+        '''
+        Decode packets from bulk data, such as captured serial log.
+
+        Data can be bytes, bytearray, memoryview or mmap object of the file.
+        Function is a generator and yields valid packets in the order of reception.
+        Packets are checked the same way as in the embedded parser:
+        packets with invalid CRC, missing stop byte or data part longer than opt_max_data_len are dropped.
+        When opt_resync is enabled, bytes of invalid packet are scanned again for next start byte,
+        same as with LWPKT_CFG_RX_RESYNC option.
+        Incomplete packet at the end of data is ignored.
+        '''
+        if not hasattr(data, 'find'):
+            data = bytes(data)
+        if self.opt_cobs:
+            yield from self.decode_cobs(data)
+            return
+        view = memoryview(data)
+        fields = self.decode_fields()
+        end = len(data)
+        pos = data.find(b'\xAA')
+        while pos >= 0:
+            pkt, idx = self.decode_frame(data, view, pos + 1, end, fields)
+            if idx < 0:
+                break
+            if pkt is not None:
+                # Stop byte is checked here, as it is not part of COBS frame
+                if idx >= end:
+                    break
+                if data[idx] == 0x55:
+                    yield pkt
+                    pos = data.find(b'\xAA', idx + 1)
+                    continue
+                idx += 1
+            pos = data.find(b'\xAA', pos + 1 if self.opt_resync else idx)
+
+    # Decode COBS framed bulk data, frame by frame
+    def decode_cobs(self, data):
+        view = memoryview(data)
+        fields = self.decode_fields()
+        pos = 0
+        while True:
+            delim = data.find(b'\x00', pos)
+            if delim < 0:
+                break
+            if delim > pos:
+                frame = self.cobs_decode(view[pos:delim])
+                if frame is not None and len(frame) > 0:
+                    pkt, idx = self.decode_frame(frame, memoryview(frame), 0, len(frame), fields)
+                    if pkt is not None and idx == len(frame):
+                        yield pkt
+            pos = delim + 1
+
+    # Get list of header fields, with True for variable length field
+    def decode_fields(self) -> list:
+        fields = []
+        if self.opt_addr:
+            fields += [self.opt_addr_ext, self.opt_addr_ext]
+        if self.opt_flags:
+            fields.append(True)
+        if self.opt_cmd:
+            fields.append(self.opt_cmd_ext)
+        fields.append(True)
+        return fields
+
+    # Decode packet fields, starting after start byte
+    # Returns packet and index of first byte after CRC, or None and index where parser continues on error.
+    # Index is negative, if packet is not complete
+    def decode_frame(self, data, view, idx:int, end:int, fields:list):
+        pkt = LwPKT.LwPKT_Packet()
+        start = idx
+        values = []
+        for var in fields:
+            if idx >= end:
+                return None, -1
+            val = data[idx]
+            idx += 1
+            if var and val & 0x80:
+                # Bytes after 5th one do not fit to 32-bit value and are ignored
+                num = val & 0x7F
+                cnt = 1
+                while True:
+                    if idx >= end:
+                        return None, -1
+                    val = data[idx]
+                    idx += 1
+                    if cnt < 5:
+                        num |= (val & 0x7F) << (7 * cnt)
+                    cnt += 1
+                    if val & 0x80 == 0:
+                        break
+                val = num & 0xFFFFFFFF
+            values.append(val)
+
+        if self.opt_addr:
+            pkt.pkt_from, pkt.pkt_to = values[0], values[1]
+        if self.opt_flags:
+            pkt.flags = values[2 if self.opt_addr else 0]
+        if self.opt_cmd:
+            pkt.cmd = values[-2]
+        pkt.len = values[-1]
+        if pkt.len > 0 and self.opt_max_data_len is not None and pkt.len > self.opt_max_data_len:
+            return None, idx
+
+        crc_len = (4 if self.opt_crc32 else 1) if self.opt_crc else 0
+        data_end = idx + pkt.len
+        if data_end + crc_len > end:
+            return None, -1
+        pkt.data = bytearray(view[idx:data_end])
+        idx = data_end
+        if crc_len > 0:
+            pkt.crc = self.crc_block(view[start:data_end])
+            pkt.crc_recv = int.from_bytes(view[data_end:data_end + crc_len], 'little')
+            idx += crc_len
+            if pkt.crc != pkt.crc_recv:
+                return None, idx
+        pkt.state = LwPKT.LwPKT_Packet.State.END
+        return pkt, idx
+
     # Get the packet
     def rx_get_packet(self) -> LwPKT_Packet|bool:
         if not self.rx_packets.empty():
@@ -282,7 +485,7 @@ if __name__ == '__main__':
     print('main')
     pkt = LwPKT()
 
-    for i in range(1 << 7):
+    for i in range(1 << 8):
         data = bytearray("Hello World\r\n".encode('utf-8'))
 
         # Variables
@@ -299,6 +502,7 @@ if __name__ == '__main__':
         pkt.opt_cmd_ext = i & 0x10
         pkt.opt_crc = i & 0x20
         pkt.opt_crc32 = i & 0x40
+        pkt.opt_cobs = i & 0x80
 
         # Trim unused options
         if not pkt.opt_addr_ext:
@@ -317,6 +521,12 @@ if __name__ == '__main__':
         print('packet', len(packet))
         print('packet_data', ', '.join(['0x{:02X}'.format(i) for i in packet]))
 
+        # Bulk decoder must give the same packet
+        decoded = list(pkt.decode(packet))
+        if len(decoded) != 1 or decoded[0].data != data or decoded[0].cmd != (cmd if pkt.opt_cmd else 0):
+            print('bulk decode fail')
+            exit()
+
         # Write data back and act as a processing function
         pkt.write_rx_data(packet)
 
@@ -0,0 +1,303 @@
+/*
+ * lwpkt_bench.c : Throughput benchmark for packet write and read operations.
+ *
+ * Every test case writes or reads the same packet many times,
+ * for all payload lengths, combinations of dynamically enabled features and buffer positions.
+ *
+ * Results are printed in CSV format, one line per test case.
+ * Optional first argument sets number of packets per test case.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lwpkt/lwpkt.h"
+
+/* Dynamically enabled features are measured in both states, static ones only as configured */
+#define FEATURE_DYN(opt, bit)  ((opt) == 2 ? (bit) : 0U)
+#define FEATURE_VALUE(opt, en) ((uint8_t)((opt) == 2 ? ((en) != 0) : (opt)))
+
+/**
+ * \brief           Feature combination of single test case
+ */
+typedef struct {
+    uint8_t addr;
+    uint8_t addr_ext;
+    uint8_t flags;
+    uint8_t cmd;
+    uint8_t cmd_ext;
+    uint8_t crc;
+    uint8_t crc32;
+    uint8_t cobs;
+} bench_conf_t;
+
+static lwpkt_t pkt;
+static lwrb_t tx_rb, rx_rb;
+static uint8_t tx_rb_data[1024], rx_rb_data[1024];
+static uint8_t payload[LWPKT_CFG_MAX_DATA_LEN];
+static uint8_t frame[sizeof(tx_rb_data)];
+static size_t frame_len, iterations = 1000;
+
+static const size_t payload_lens[] = {
+    0, 1, 16, 64, LWPKT_CFG_MAX_DATA_LEN / 2, LWPKT_CFG_MAX_DATA_LEN,
+};
+
+#if LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES
+/**
+ * \brief           Cycle counter for statistics
+ * \note            Cycle measurement is not part of the benchmark, hence function does nothing
+ * \return          Always `0`
+ */
+uint32_t
+lwpkt_stats_get_cycles(void) {
+    return 0;
+}
+#endif /* LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES */
+
+#if LWPKT_CFG_TRACE
+/**
+ * \brief           Clock for packet latency trace
+ * \note            Trace is not part of the benchmark, hence function does nothing
+ * \return          Always `0`
+ */
+uint32_t
+lwpkt_trace_get_time(void) {
+    return 0;
+}
+#endif /* LWPKT_CFG_TRACE */
+
+/**
+ * \brief           Get current time
+ * \return          Time in units of nanoseconds
+ */
+static uint64_t
+prv_time_ns(void) {
+    struct timespec ts;
+
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else  /* CLOCK_MONOTONIC */
+    timespec_get(&ts, TIME_UTC);
+#endif /* !CLOCK_MONOTONIC */
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief           Apply feature combination to the packet instance
+ * \param[in]       conf: Feature combination
+ */
+static void
+prv_apply_conf(const bench_conf_t* conf) {
+#if LWPKT_CFG_USE_ADDR == 2
+    lwpkt_set_addr_enabled(&pkt, conf->addr);
+#endif /* LWPKT_CFG_USE_ADDR == 2 */
+#if LWPKT_CFG_ADDR_EXTENDED == 2
+    lwpkt_set_addr_extended_enabled(&pkt, conf->addr_ext);
+#endif /* LWPKT_CFG_ADDR_EXTENDED == 2 */
+#if LWPKT_CFG_USE_FLAGS == 2
+    lwpkt_set_flags_enabled(&pkt, conf->flags);
+#endif /* LWPKT_CFG_USE_FLAGS == 2 */
+#if LWPKT_CFG_USE_CMD == 2
+    lwpkt_set_cmd_enabled(&pkt, conf->cmd);
+#endif /* LWPKT_CFG_USE_CMD == 2 */
+#if LWPKT_CFG_CMD_EXTENDED == 2
+    lwpkt_set_cmd_extended_enabled(&pkt, conf->cmd_ext);
+#endif /* LWPKT_CFG_CMD_EXTENDED == 2 */
+#if LWPKT_CFG_USE_CRC == 2
+    lwpkt_set_crc_enabled(&pkt, conf->crc);
+#endif /* LWPKT_CFG_USE_CRC == 2 */
+#if LWPKT_CFG_CRC32 == 2
+    lwpkt_set_crc32_enabled(&pkt, conf->crc32);
+#endif /* LWPKT_CFG_CRC32 == 2 */
+#if LWPKT_CFG_USE_COBS == 2
+    lwpkt_set_cobs_enabled(&pkt, conf->cobs);
+#endif /* LWPKT_CFG_USE_COBS == 2 */
+    (void)conf;
+}
+
+/**
+ * \brief           Empty the buffer and move its pointers
+ * \param[in]       rb: Buffer to position
+ * \param[in]       len: Length of the packet to be written to the buffer
+ * \param[in]       wrap: Set to `1` to place the packet across the end of the buffer memory,
+ *                      `0` to place it at the beginning
+ */
+static void
+prv_rb_position(lwrb_t* rb, size_t len, uint8_t wrap) {
+    lwrb_reset(rb);
+    if (wrap) {
+        size_t pos = rb->size - len / 2U - 1U;
+        lwrb_advance(rb, pos);
+        lwrb_skip(rb, pos);
+    }
+}
+
+/**
+ * \brief           Write single packet with test payload
+ * \param[in]       len: Payload length
+ * \return          Result of write operation
+ */
+static lwpktr_t
+prv_write(size_t len) {
+    return lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                       0x87654321UL,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                       0xACCE550FUL,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                       0x85542343UL,
+#endif /* LWPKT_CFG_USE_CMD */
+                       payload, len);
+}
+
+/**
+ * \brief           Measure write operation
+ * \param[in]       len: Payload length
+ * \param[in]       wrap: Buffer position, see \ref prv_rb_position
+ * \return          Elapsed time in units of nanoseconds, `0` on failure
+ */
+static uint64_t
+prv_bench_write(size_t len, uint8_t wrap) {
+    uint64_t start = prv_time_ns();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        prv_rb_position(&tx_rb, frame_len, wrap);
+        if (prv_write(len) != lwpktOK) {
+            return 0;
+        }
+    }
+    return prv_time_ns() - start;
+}
+
+/**
+ * \brief           Measure read operation
+ * \param[in]       len: Payload length
+ * \param[in]       wrap: Buffer position, see \ref prv_rb_position
+ * \return          Elapsed time in units of nanoseconds, `0` on failure
+ */
+static uint64_t
+prv_bench_read(size_t len, uint8_t wrap) {
+    uint64_t start = prv_time_ns();
+
+    for (size_t i = 0; i < iterations; ++i) {
+#if LWPKT_CFG_RX_ZERO_COPY
+        lwpkt_release_view(&pkt);
+#endif /* LWPKT_CFG_RX_ZERO_COPY */
+        prv_rb_position(&rx_rb, frame_len, wrap);
+        lwrb_write(&rx_rb, frame, frame_len);
+        if (lwpkt_read(&pkt) != lwpktVALID || lwpkt_get_data_len(&pkt) != len) {
+            return 0;
+        }
+#if LWPKT_CFG_RX_QUEUE
+        lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+    }
+    return prv_time_ns() - start;
+}
+
+/**
+ * \brief           Print result of single test case
+ * \param[in]       op: Operation name
+ * \param[in]       conf: Feature combination
+ * \param[in]       len: Payload length
+ * \param[in]       wrap: Buffer position
+ * \param[in]       ns: Elapsed time in units of nanoseconds
+ */
+static void
+prv_print(const char* op, const bench_conf_t* conf, size_t len, uint8_t wrap, uint64_t ns) {
+    double sec = (double)ns / 1e9;
+
+    printf("%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%s,%u,%u,%llu,%.0f,%.0f\n", op, (unsigned)len, (unsigned)conf->addr,
+           (unsigned)conf->addr_ext, (unsigned)conf->flags, (unsigned)conf->cmd, (unsigned)conf->cmd_ext,
+           (unsigned)conf->crc, (unsigned)conf->crc32, (unsigned)conf->cobs, wrap ? "wrap" : "linear",
+           (unsigned)frame_len, (unsigned)iterations, (unsigned long long)ns, (double)iterations / sec,
+           (double)(iterations * frame_len) / sec);
+}
+
+/**
+ * \brief           Run all test cases for one feature combination
+ * \param[in]       conf: Feature combination
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+prv_bench_conf(const bench_conf_t* conf) {
+    uint64_t ns;
+
+    lwpkt_reset(&pkt);
+    prv_apply_conf(conf);
+    for (size_t l = 0; l < sizeof(payload_lens) / sizeof(payload_lens[0]); ++l) {
+        size_t len = payload_lens[l];
+
+        /* Reference packet for read operation */
+        prv_rb_position(&tx_rb, 0, 0);
+        if (prv_write(len) != lwpktOK) {
+            return 0;
+        }
+        frame_len = lwrb_read(&tx_rb, frame, sizeof(frame));
+
+        for (uint8_t wrap = 0; wrap < 2; ++wrap) {
+            if ((ns = prv_bench_write(len, wrap)) == 0) {
+                return 0;
+            }
+            prv_print("write", conf, len, wrap, ns);
+            if ((ns = prv_bench_read(len, wrap)) == 0) {
+                return 0;
+            }
+            prv_print("read", conf, len, wrap, ns);
+        }
+    }
+    return 1;
+}
+
+int
+main(int argc, char** argv) {
+    const unsigned dyn_mask = FEATURE_DYN(LWPKT_CFG_USE_ADDR, 0x01U) | FEATURE_DYN(LWPKT_CFG_ADDR_EXTENDED, 0x02U)
+                              | FEATURE_DYN(LWPKT_CFG_USE_FLAGS, 0x04U) | FEATURE_DYN(LWPKT_CFG_USE_CMD, 0x08U)
+                              | FEATURE_DYN(LWPKT_CFG_CMD_EXTENDED, 0x10U) | FEATURE_DYN(LWPKT_CFG_USE_CRC, 0x20U)
+                              | FEATURE_DYN(LWPKT_CFG_CRC32, 0x40U) | FEATURE_DYN(LWPKT_CFG_USE_COBS, 0x80U);
+    bench_conf_t conf;
+
+    if (argc > 1 && (iterations = (size_t)strtoul(argv[1], NULL, 0)) == 0) {
+        fprintf(stderr, "usage: %s [packets_per_test]\n", argv[0]);
+        return 1;
+    }
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = (uint8_t)i;
+    }
+    lwrb_init(&tx_rb, tx_rb_data, sizeof(tx_rb_data));
+    lwrb_init(&rx_rb, rx_rb_data, sizeof(rx_rb_data));
+    lwpkt_init(&pkt, &tx_rb, &rx_rb);
+#if LWPKT_CFG_USE_ADDR
+    lwpkt_set_addr(&pkt, 0x12);
+#endif /* LWPKT_CFG_USE_ADDR */
+
+    printf("op,len,addr,addr_ext,flags,cmd,cmd_ext,crc,crc32,cobs,pos,frame_len,packets,ns,packets_per_s,bytes_per_s\n");
+    for (unsigned mask = 0; mask < 0x100U; ++mask) {
+        /* Static features are measured only as configured */
+        if ((mask & ~dyn_mask) != 0) {
+            continue;
+        }
+        conf.addr = FEATURE_VALUE(LWPKT_CFG_USE_ADDR, mask & 0x01U);
+        conf.addr_ext = FEATURE_VALUE(LWPKT_CFG_ADDR_EXTENDED, mask & 0x02U);
+        conf.flags = FEATURE_VALUE(LWPKT_CFG_USE_FLAGS, mask & 0x04U);
+        conf.cmd = FEATURE_VALUE(LWPKT_CFG_USE_CMD, mask & 0x08U);
+        conf.cmd_ext = FEATURE_VALUE(LWPKT_CFG_CMD_EXTENDED, mask & 0x10U);
+        conf.crc = FEATURE_VALUE(LWPKT_CFG_USE_CRC, mask & 0x20U);
+        conf.crc32 = FEATURE_VALUE(LWPKT_CFG_CRC32, mask & 0x40U);
+        conf.cobs = FEATURE_VALUE(LWPKT_CFG_USE_COBS, mask & 0x80U);
+
+        /* Extended modes have no effect if feature itself is disabled */
+        if ((conf.addr_ext && !conf.addr) || (conf.cmd_ext && !conf.cmd) || (conf.crc32 && !conf.crc)) {
+            continue;
+        }
+        if (!prv_bench_conf(&conf)) {
+            fprintf(stderr, "Benchmark failed\n");
+            return 1;
+        }
+    }
+    return 0;
+}
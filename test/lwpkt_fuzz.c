@@ -0,0 +1,522 @@
+/*
+ * lwpkt_fuzz.c : Fuzz target and differential test for the packet receive parser.
+ *
+ * Every input is received by two instances with the same feature combination:
+ * first one gets data in chunks, to go through bulk start byte search, header decoding and data copy,
+ * second one gets data byte by byte, to go only through the byte-wise state machine.
+ * Both instances must report the same sequence of results and packets, otherwise the target aborts.
+ *
+ * First FUZZ_HDR_LEN bytes of the input select feature combination, chunk length and buffer position,
+ * remaining bytes are received data.
+ *
+ * When built with LWPKT_FUZZ_LIBFUZZER defined, file is libFuzzer target.
+ * Otherwise it is standalone executable, which runs input files or generated inputs,
+ * and prints valid packets for comparison with python implementation, see lwpkt_fuzz.py.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lwpkt/lwpkt.h"
+
+/* Dynamically enabled features are selected by the input, static ones are used as configured */
+#define FEATURE_VALUE(opt, en) ((uint8_t)((opt) == 2 ? ((en) != 0) : (opt)))
+
+#define FUZZ_HDR_LEN           3U    /* Feature mask, chunk length and buffer position */
+#define FUZZ_MAX_LEN           2048U /* Maximum length of received data, longer inputs are truncated */
+#define FUZZ_RB_SIZE           4096U /* RX buffer never gets full, even with packet held for resync */
+
+/**
+ * \brief           Result of single read operation
+ */
+typedef struct {
+    uint32_t res;
+    uint32_t from;
+    uint32_t to;
+    uint32_t flags;
+    uint32_t cmd;
+    uint32_t len;
+    uint32_t hash; /*!< Hash of data part */
+} fuzz_rec_t;
+
+/**
+ * \brief           Receiving instance with its results
+ */
+typedef struct {
+    lwpkt_t pkt;
+    lwrb_t rx_rb;
+    uint8_t rx_rb_data[FUZZ_RB_SIZE];
+#if LWPKT_CFG_RX_DATA_EXT
+    uint8_t rx_data[LWPKT_CFG_MAX_DATA_LEN];
+#endif /* LWPKT_CFG_RX_DATA_EXT */
+    fuzz_rec_t rec[FUZZ_MAX_LEN + 1U];
+    size_t rec_cnt;
+#if LWPKT_CFG_USE_RX_STREAM
+    uint8_t stream[FUZZ_MAX_LEN]; /*!< Data part of stream packet, collected from events */
+    size_t stream_len;
+    uint8_t stream_end; /*!< Set to `1` when stream packet has ended and is not recorded yet */
+#endif                  /* LWPKT_CFG_USE_RX_STREAM */
+} fuzz_rx_t;
+
+static fuzz_rx_t rx_bulk, rx_byte;
+static uint8_t dump, dump_stream;
+
+#if LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES
+/**
+ * \brief           Cycle counter for statistics
+ * \note            Statistics are not part of the test, hence function does nothing
+ * \return          Always `0`
+ */
+uint32_t
+lwpkt_stats_get_cycles(void) {
+    return 0;
+}
+#endif /* LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES */
+
+#if LWPKT_CFG_TRACE
+/**
+ * \brief           Clock for packet latency trace
+ * \note            Trace is not part of the test, hence function does nothing
+ * \return          Always `0`
+ */
+uint32_t
+lwpkt_trace_get_time(void) {
+    return 0;
+}
+#endif /* LWPKT_CFG_TRACE */
+
+/**
+ * \brief           Apply feature combination to the packet instance
+ * \param[in]       pkt: Packet instance
+ * \param[in]       mask: Feature mask, one bit per dynamically enabled feature
+ */
+static void
+prv_apply_conf(lwpkt_t* pkt, uint8_t mask) {
+#if LWPKT_CFG_USE_ADDR == 2
+    lwpkt_set_addr_enabled(pkt, mask & 0x01U);
+#endif /* LWPKT_CFG_USE_ADDR == 2 */
+#if LWPKT_CFG_ADDR_EXTENDED == 2
+    lwpkt_set_addr_extended_enabled(pkt, mask & 0x02U);
+#endif /* LWPKT_CFG_ADDR_EXTENDED == 2 */
+#if LWPKT_CFG_USE_FLAGS == 2
+    lwpkt_set_flags_enabled(pkt, mask & 0x04U);
+#endif /* LWPKT_CFG_USE_FLAGS == 2 */
+#if LWPKT_CFG_USE_CMD == 2
+    lwpkt_set_cmd_enabled(pkt, mask & 0x08U);
+#endif /* LWPKT_CFG_USE_CMD == 2 */
+#if LWPKT_CFG_CMD_EXTENDED == 2
+    lwpkt_set_cmd_extended_enabled(pkt, mask & 0x10U);
+#endif /* LWPKT_CFG_CMD_EXTENDED == 2 */
+#if LWPKT_CFG_USE_CRC == 2
+    lwpkt_set_crc_enabled(pkt, mask & 0x20U);
+#endif /* LWPKT_CFG_USE_CRC == 2 */
+#if LWPKT_CFG_CRC32 == 2
+    lwpkt_set_crc32_enabled(pkt, mask & 0x40U);
+#endif /* LWPKT_CFG_CRC32 == 2 */
+#if LWPKT_CFG_USE_COBS == 2
+    lwpkt_set_cobs_enabled(pkt, mask & 0x80U);
+#endif /* LWPKT_CFG_USE_COBS == 2 */
+    (void)pkt;
+    (void)mask;
+}
+
+#if LWPKT_CFG_USE_RX_STREAM
+
+/**
+ * \brief           Event function, to collect data part of stream packets
+ * \param[in]       pkt: Packet instance
+ * \param[in]       type: Event type
+ */
+static void
+prv_evt_fn(lwpkt_t* pkt, lwpkt_evt_type_t type) {
+    fuzz_rx_t* rx = pkt == &rx_bulk.pkt ? &rx_bulk : &rx_byte;
+
+    switch (type) {
+        case LWPKT_EVT_STREAM_START: {
+            rx->stream_len = 0;
+            if (rx == &rx_byte) {
+                dump_stream = 1;
+            }
+            break;
+        }
+        case LWPKT_EVT_STREAM_DATA: {
+            const void* data = lwpkt_get_stream_data(pkt);
+            size_t off = lwpkt_get_stream_data_offset(pkt), len = lwpkt_get_stream_data_len(pkt);
+
+            /* Data part cannot be longer than received data */
+            if (data == NULL || off + len > sizeof(rx->stream) || off != rx->stream_len) {
+                fprintf(stderr, "Stream data at offset %u, expected %u\n", (unsigned)off, (unsigned)rx->stream_len);
+                abort();
+            }
+            memcpy(&rx->stream[off], data, len);
+            rx->stream_len += len;
+            break;
+        }
+        case LWPKT_EVT_STREAM_END: rx->stream_end = 1; break;
+        default: break;
+    }
+}
+
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+
+/**
+ * \brief           Add part of packet data to the record
+ * \param[in]       rx: Receiving instance
+ * \param[in,out]   rec: Record to update
+ * \param[in]       data: Data part
+ * \param[in]       len: Length of data part
+ */
+static void
+prv_rec_data(const fuzz_rx_t* rx, fuzz_rec_t* rec, const void* data, size_t len) {
+    const uint8_t* d = data;
+
+    for (size_t i = 0; i < len; ++i) {
+        rec->hash = (rec->hash ^ d[i]) * 16777619UL; /* FNV-1a */
+        if (dump && rx == &rx_byte) {
+            printf("%02X", (unsigned)d[i]);
+        }
+    }
+    rec->len += (uint32_t)len;
+}
+
+/**
+ * \brief           Record result of read operation, with fields and data of valid packet
+ * \param[in]       rx: Receiving instance
+ * \param[in]       res: Result of read operation
+ */
+static void
+prv_record(fuzz_rx_t* rx, lwpktr_t res) {
+    fuzz_rec_t* rec;
+
+    if (rx->rec_cnt == sizeof(rx->rec) / sizeof(rx->rec[0])) {
+        fprintf(stderr, "More results than received bytes\n");
+        abort();
+    }
+    rec = &rx->rec[rx->rec_cnt++];
+    memset(rec, 0x00, sizeof(*rec));
+    rec->res = (uint32_t)res;
+    rec->hash = 2166136261UL;
+    if (res == lwpktVALID) {
+#if LWPKT_CFG_USE_ADDR
+        rec->from = (uint32_t)lwpkt_get_from_addr(&rx->pkt);
+        rec->to = (uint32_t)lwpkt_get_to_addr(&rx->pkt);
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+        rec->flags = lwpkt_get_flags(&rx->pkt);
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+        rec->cmd = lwpkt_get_cmd(&rx->pkt);
+#endif /* LWPKT_CFG_USE_CMD */
+        if (dump && rx == &rx_byte) {
+            printf("pkt %lu %lu %lu %lu ", (unsigned long)rec->from, (unsigned long)rec->to,
+                   (unsigned long)rec->flags, (unsigned long)rec->cmd);
+        }
+#if LWPKT_CFG_USE_RX_STREAM
+        if (rx->stream_end) {
+            prv_rec_data(rx, rec, rx->stream, rx->stream_len);
+        } else
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+        {
+#if LWPKT_CFG_RX_ZERO_COPY
+            lwpkt_seg_t seg[2];
+
+            lwpkt_get_view(&rx->pkt, seg);
+            prv_rec_data(rx, rec, seg[0].data, seg[0].len);
+            prv_rec_data(rx, rec, seg[1].data, seg[1].len);
+#elif LWPKT_CFG_RX_QUEUE
+            const lwpkt_rx_slot_t* slot = lwpkt_rxq_get(&rx->pkt);
+
+            if (slot != NULL) {
+                prv_rec_data(rx, rec, slot->data, slot->len);
+            }
+#else  /* LWPKT_CFG_RX_ZERO_COPY */
+            prv_rec_data(rx, rec, lwpkt_get_data(&rx->pkt), lwpkt_get_data_len(&rx->pkt));
+#endif /* !LWPKT_CFG_RX_ZERO_COPY */
+        }
+        if (dump && rx == &rx_byte) {
+            printf("\n");
+        }
+    }
+#if LWPKT_CFG_RX_QUEUE
+    while (lwpkt_rxq_release(&rx->pkt) == lwpktOK) {}
+#endif /* LWPKT_CFG_RX_QUEUE */
+#if LWPKT_CFG_USE_RX_STREAM
+    rx->stream_end = 0;
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+}
+
+/**
+ * \brief           Receive data with one instance and record all results
+ * \param[in]       rx: Receiving instance
+ * \param[in]       mask: Feature mask
+ * \param[in]       data: Received data
+ * \param[in]       len: Length of received data
+ * \param[in]       chunk: Number of bytes written to RX buffer before each read
+ * \param[in]       pos: Initial position of RX buffer pointers
+ */
+static void
+prv_receive(fuzz_rx_t* rx, uint8_t mask, const uint8_t* data, size_t len, size_t chunk, size_t pos) {
+    lwpktr_t res;
+
+    lwrb_init(&rx->rx_rb, rx->rx_rb_data, sizeof(rx->rx_rb_data));
+    lwrb_advance(&rx->rx_rb, pos);
+    lwrb_skip(&rx->rx_rb, pos);
+#if LWPKT_CFG_RX_DATA_EXT
+    lwpkt_init_ex(&rx->pkt, NULL, &rx->rx_rb, rx->rx_data, sizeof(rx->rx_data));
+#else  /* LWPKT_CFG_RX_DATA_EXT */
+    lwpkt_init(&rx->pkt, NULL, &rx->rx_rb);
+#endif /* !LWPKT_CFG_RX_DATA_EXT */
+    prv_apply_conf(&rx->pkt, mask);
+#if LWPKT_CFG_USE_RX_STREAM
+    lwpkt_set_evt_fn(&rx->pkt, prv_evt_fn);
+    rx->stream_end = 0;
+#endif /* LWPKT_CFG_USE_RX_STREAM */
+    rx->rec_cnt = 0;
+
+    for (size_t off = 0, n; off < len; off += n) {
+        n = len - off < chunk ? len - off : chunk;
+        lwrb_write(&rx->rx_rb, &data[off], n);
+        while ((res = lwpkt_read(&rx->pkt)) != lwpktWAITDATA && res != lwpktINPROG) {
+            prv_record(rx, res);
+        }
+    }
+
+    /* State at the end of data must be the same too */
+    prv_record(rx, lwpkt_read(&rx->pkt));
+}
+
+/**
+ * \brief           Receive one input with both instances and compare results
+ * \param[in]       in: Input, with header of \ref FUZZ_HDR_LEN bytes
+ * \param[in]       in_len: Input length
+ */
+static void
+prv_fuzz_one(const uint8_t* in, size_t in_len) {
+    uint8_t mask;
+    size_t chunk, pos, len;
+
+    if (in_len < FUZZ_HDR_LEN) {
+        return;
+    }
+    mask = in[0];
+    chunk = (size_t)in[1] + 1U;
+    pos = (size_t)in[2] * (FUZZ_RB_SIZE / 256U);
+    len = in_len - FUZZ_HDR_LEN < FUZZ_MAX_LEN ? in_len - FUZZ_HDR_LEN : FUZZ_MAX_LEN;
+
+    if (dump) {
+        uint8_t crc = FEATURE_VALUE(LWPKT_CFG_USE_CRC, mask & 0x20U);
+        long max = LWPKT_CFG_MAX_DATA_LEN;
+
+#if LWPKT_CFG_RX_ZERO_COPY
+        max = -1; /* Data part is limited only by RX buffer size */
+#endif            /* LWPKT_CFG_RX_ZERO_COPY */
+        printf("cfg addr=%u addr_ext=%u flags=%u cmd=%u cmd_ext=%u crc=%u crc32=%u cobs=%u resync=%u max=%ld\n",
+               (unsigned)FEATURE_VALUE(LWPKT_CFG_USE_ADDR, mask & 0x01U),
+               (unsigned)FEATURE_VALUE(LWPKT_CFG_ADDR_EXTENDED, mask & 0x02U),
+               (unsigned)FEATURE_VALUE(LWPKT_CFG_USE_FLAGS, mask & 0x04U),
+               (unsigned)FEATURE_VALUE(LWPKT_CFG_USE_CMD, mask & 0x08U),
+               (unsigned)FEATURE_VALUE(LWPKT_CFG_CMD_EXTENDED, mask & 0x10U), (unsigned)crc,
+               (unsigned)(crc && FEATURE_VALUE(LWPKT_CFG_CRC32, mask & 0x40U)),
+               (unsigned)FEATURE_VALUE(LWPKT_CFG_USE_COBS, mask & 0x80U), (unsigned)LWPKT_CFG_RX_RESYNC, max);
+        dump_stream = 0;
+    }
+    prv_receive(&rx_bulk, mask, &in[FUZZ_HDR_LEN], len, chunk, pos);
+    prv_receive(&rx_byte, mask, &in[FUZZ_HDR_LEN], len, 1, pos);
+    if (dump && dump_stream) {
+        printf("stream\n"); /* Stream packets are not dropped by length, as in python implementation */
+    }
+
+    for (size_t i = 0; i < rx_bulk.rec_cnt || i < rx_byte.rec_cnt; ++i) {
+        if (i >= rx_bulk.rec_cnt || i >= rx_byte.rec_cnt
+            || memcmp(&rx_bulk.rec[i], &rx_byte.rec[i], sizeof(rx_bulk.rec[i])) != 0) {
+            fprintf(stderr, "Result %u differs: mask=0x%02X, chunk=%u, pos=%u, bulk res=%d, byte res=%d\n",
+                    (unsigned)i, (unsigned)mask, (unsigned)chunk, (unsigned)pos,
+                    i < rx_bulk.rec_cnt ? (int)rx_bulk.rec[i].res : -1,
+                    i < rx_byte.rec_cnt ? (int)rx_byte.rec[i].res : -1);
+            abort();
+        }
+    }
+}
+
+#ifdef LWPKT_FUZZ_LIBFUZZER
+
+int
+LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    prv_fuzz_one(data, size);
+    return 0;
+}
+
+#else /* LWPKT_FUZZ_LIBFUZZER */
+
+/**
+ * \brief           Get next pseudo-random number
+ * \param[in,out]   seed: Generator state, must not be `0`
+ * \return          Random number
+ */
+static uint32_t
+prv_rand(uint32_t* seed) {
+    uint32_t x = *seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+/**
+ * \brief           Generate input with valid packets, written by the library, and mutate it
+ * \param[out]      in: Input memory of at least `FUZZ_HDR_LEN + FUZZ_MAX_LEN` bytes
+ * \param[in,out]   seed: Random generator state
+ * \return          Input length
+ */
+static size_t
+prv_generate(uint8_t* in, uint32_t* seed) {
+    static lwpkt_t tx_pkt;
+    static lwrb_t tx_rb;
+    static uint8_t tx_rb_data[1024], payload[LWPKT_CFG_MAX_DATA_LEN];
+    size_t len, max;
+
+    for (size_t i = 0; i < FUZZ_HDR_LEN; ++i) {
+        in[i] = (uint8_t)prv_rand(seed);
+    }
+
+    /* Some inputs are just random data */
+    if (prv_rand(seed) % 8U == 0) {
+        len = prv_rand(seed) % 256U;
+        for (size_t i = 0; i < len; ++i) {
+            in[FUZZ_HDR_LEN + i] = (uint8_t)prv_rand(seed);
+        }
+        return FUZZ_HDR_LEN + len;
+    }
+
+    lwrb_init(&tx_rb, tx_rb_data, sizeof(tx_rb_data));
+    lwpkt_init(&tx_pkt, &tx_rb, NULL);
+    prv_apply_conf(&tx_pkt, in[0]);
+#if LWPKT_CFG_USE_ADDR
+    lwpkt_set_addr(&tx_pkt, (lwpkt_addr_t)prv_rand(seed));
+#endif /* LWPKT_CFG_USE_ADDR */
+    for (size_t cnt = 1U + prv_rand(seed) % 8U; cnt > 0; --cnt) {
+        max = prv_rand(seed) % 4U == 0 ? LWPKT_CFG_MAX_DATA_LEN : 16U;
+        len = prv_rand(seed) % (max + 1U);
+        for (size_t i = 0; i < len; ++i) {
+            payload[i] = (uint8_t)(prv_rand(seed) % 4U == 0 ? 0xAAU : prv_rand(seed));
+        }
+        if (lwpkt_write(&tx_pkt,
+#if LWPKT_CFG_USE_ADDR
+                        (lwpkt_addr_t)(prv_rand(seed) >> (prv_rand(seed) % 32U)),
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                        prv_rand(seed) >> (prv_rand(seed) % 32U),
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                        prv_rand(seed) >> (prv_rand(seed) % 32U),
+#endif /* LWPKT_CFG_USE_CMD */
+                        payload, len)
+            != lwpktOK) {
+            break;
+        }
+    }
+    len = lwrb_read(&tx_rb, &in[FUZZ_HDR_LEN], FUZZ_MAX_LEN);
+
+    /* Mutate bytes, insert, remove and truncate */
+    for (size_t cnt = prv_rand(seed) % 4U; cnt > 0 && len > 0; --cnt) {
+        size_t idx = prv_rand(seed) % len;
+        uint8_t* d = &in[FUZZ_HDR_LEN];
+        static const uint8_t special[] = {0x00, 0x55, 0xAA, 0x80, 0xFF};
+
+        switch (prv_rand(seed) % 5U) {
+            case 0: d[idx] ^= (uint8_t)(1U << (prv_rand(seed) % 8U)); break;
+            case 1: d[idx] = special[prv_rand(seed) % sizeof(special)]; break;
+            case 2:
+                if (len < FUZZ_MAX_LEN) {
+                    memmove(&d[idx + 1U], &d[idx], len - idx);
+                    d[idx] = (uint8_t)prv_rand(seed);
+                    ++len;
+                }
+                break;
+            case 3:
+                memmove(&d[idx], &d[idx + 1U], len - idx - 1U);
+                --len;
+                break;
+            default: len = idx; break;
+        }
+    }
+    return FUZZ_HDR_LEN + len;
+}
+
+/**
+ * \brief           Read input file
+ * \param[in]       name: File name
+ * \param[out]      in: Input memory
+ * \param[in]       size: Size of input memory
+ * \return          Input length, `0` on failure
+ */
+static size_t
+prv_read_file(const char* name, uint8_t* in, size_t size) {
+    FILE* f = fopen(name, "rb");
+    size_t len;
+
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open %s\n", name);
+        return 0;
+    }
+    len = fread(in, 1, size, f);
+    fclose(f);
+    return len;
+}
+
+int
+main(int argc, char** argv) {
+    static uint8_t in[FUZZ_HDR_LEN + FUZZ_MAX_LEN];
+    const char* out_dir = NULL;
+    unsigned long count = 0, files = 0;
+    uint32_t seed = 1;
+    size_t len;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+            seed = seed == 0 ? 1 : seed;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (strcmp(argv[i], "-d") == 0) {
+            dump = 1;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-n count] [-s seed] [-o out_dir] [-d] [file ...]\n", argv[0]);
+            return 1;
+        } else {
+            if ((len = prv_read_file(argv[i], in, sizeof(in))) == 0) {
+                return 1;
+            }
+            prv_fuzz_one(in, len);
+            ++files;
+        }
+    }
+
+    /* Generated inputs, optionally saved as corpus for libFuzzer and python comparison */
+    for (unsigned long n = 0; n < count; ++n) {
+        len = prv_generate(in, &seed);
+        if (out_dir != NULL) {
+            char name[512];
+            FILE* f;
+
+            snprintf(name, sizeof(name), "%s/gen_%06lu.bin", out_dir, n);
+            if ((f = fopen(name, "wb")) == NULL) {
+                fprintf(stderr, "Cannot create %s\n", name);
+                return 1;
+            }
+            fwrite(in, 1, len, f);
+            fclose(f);
+        }
+        prv_fuzz_one(in, len);
+    }
+    if (!dump) {
+        printf("%lu files and %lu generated inputs OK\n", files, count);
+    }
+    return 0;
+}
+
+#endif /* !LWPKT_FUZZ_LIBFUZZER */
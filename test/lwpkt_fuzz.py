@@ -0,0 +1,73 @@
+'''
+Compare packets decoded by lwpkt_fuzz executable with python implementation.
+
+Usage: python3 lwpkt_fuzz.py <lwpkt_fuzz executable> <input file or directory> ...
+
+Every input is passed to the executable in dump mode, which prints configuration and valid packets.
+Same data are decoded with LwPKT.decode and both packet lists must be the same.
+Inputs with stream packets are skipped, as python implementation drops packets longer than maximum data length.
+
+Inputs are generated with: lwpkt_fuzz -n <count> -o <directory>
+'''
+import os, subprocess, sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'python'))
+from lwpkt import LwPKT
+
+# Length of input header with feature mask, chunk length and buffer position
+FUZZ_HDR_LEN = 3
+FUZZ_MAX_LEN = 2048
+
+# Decode input with python implementation, with the same configuration
+def decode_python(cfg:dict, data:bytes) -> list:
+    lwpkt = LwPKT()
+    lwpkt.opt_addr = cfg['addr'] != 0
+    lwpkt.opt_addr_ext = cfg['addr_ext'] != 0
+    lwpkt.opt_flags = cfg['flags'] != 0
+    lwpkt.opt_cmd = cfg['cmd'] != 0
+    lwpkt.opt_cmd_ext = cfg['cmd_ext'] != 0
+    lwpkt.opt_crc = cfg['crc'] != 0
+    lwpkt.opt_crc32 = cfg['crc32'] != 0
+    lwpkt.opt_cobs = cfg['cobs'] != 0
+    lwpkt.opt_resync = cfg['resync'] != 0
+    lwpkt.opt_max_data_len = cfg['max'] if cfg['max'] >= 0 else None
+    return ['pkt %d %d %d %d %s' % (p.pkt_from, p.pkt_to, p.flags, p.cmd, bytes(p.data).hex().upper())
+            for p in lwpkt.decode(data)]
+
+# Compare one input, returns True if equal or skipped
+def compare(exe:str, name:str) -> bool:
+    out = subprocess.run([exe, '-d', name], capture_output=True, text=True)
+    if out.returncode != 0:
+        print('%s: executable failed\n%s' % (name, out.stderr))
+        return False
+    lines = out.stdout.splitlines()
+    if len(lines) == 0 or 'stream' in lines:
+        return True
+    cfg = {k: int(v) for k, v in (f.split('=') for f in lines[0].split()[1:])}
+    with open(name, 'rb') as f:
+        data = f.read()[FUZZ_HDR_LEN:FUZZ_HDR_LEN + FUZZ_MAX_LEN]
+    py = decode_python(cfg, data)
+    if py != lines[1:]:
+        print('%s: packets differ, %s' % (name, lines[0]))
+        for i in range(max(len(py), len(lines) - 1)):
+            c = lines[1 + i] if i + 1 < len(lines) else '-'
+            p = py[i] if i < len(py) else '-'
+            if c != p:
+                print('  packet %d\n    c:      %s\n    python: %s' % (i, c, p))
+                break
+        return False
+    return True
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+    files = []
+    for arg in sys.argv[2:]:
+        if os.path.isdir(arg):
+            files += sorted(os.path.join(arg, f) for f in os.listdir(arg))
+        else:
+            files.append(arg)
+    failed = sum(0 if compare(sys.argv[1], f) else 1 for f in files)
+    print('%d inputs, %d failed' % (len(files), failed))
+    sys.exit(1 if failed else 0)
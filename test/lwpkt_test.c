@@ -1,5 +1,12 @@
 #include <stdio.h>
+#include <string.h>
 #include "lwpkt/lwpkt.h"
+#include "lwpkt/lwpkt_engine.h"
+#include "lwpkt/lwpkt_frag.h"
+#include "lwpkt/lwpkt_gw.h"
+#if LWPKT_CFG_USE_GW
+#include <unistd.h>
+#endif /* LWPKT_CFG_USE_GW */
 
 /* LwPKT data */
 static lwpkt_t pkt;
@@ -9,6 +16,51 @@ static uint8_t pkt_tx_rb_data[256], pkt_rx_rb_data[256];
 /* Data to read and write */
 static const char* data = "Hello World\r\n";
 
+/* Memory for received data is provided to the instance by the test */
+#if LWPKT_CFG_RX_DATA_EXT
+static uint8_t pkt_rx_data[LWPKT_CFG_MAX_DATA_LEN];
+#define PKT_INIT(p, tx, rx, mem) lwpkt_init_ex((p), (tx), (rx), (mem), LWPKT_CFG_MAX_DATA_LEN)
+#else /* LWPKT_CFG_RX_DATA_EXT */
+#define PKT_INIT(p, tx, rx, mem) lwpkt_init((p), (tx), (rx))
+#endif /* !LWPKT_CFG_RX_DATA_EXT */
+
+/**
+ * \brief           Compare received packet data with reference
+ * \param[in]       ref: Reference data
+ * \param[in]       len: Reference data length
+ * \return          `1` if equal, `0` otherwise
+ */
+static uint8_t
+prv_data_equal(const void* ref, size_t len) {
+    if (lwpkt_get_data_len(&pkt) != len) {
+        return 0;
+    }
+#if LWPKT_CFG_RX_ZERO_COPY
+    {
+        lwpkt_seg_t seg[2];
+        lwpkt_get_view(&pkt, seg);
+        return seg[0].len + seg[1].len == len && (seg[0].len == 0 || memcmp(seg[0].data, ref, seg[0].len) == 0)
+               && (seg[1].len == 0 || memcmp(seg[1].data, (const uint8_t*)ref + seg[0].len, seg[1].len) == 0);
+    }
+#elif LWPKT_CFG_RX_QUEUE
+    {
+        /* Packet is taken from the queue, to free the slot for next one */
+        const lwpkt_rx_slot_t* slot = lwpkt_rxq_get(&pkt);
+        uint8_t equal = slot != NULL && slot->len == len && slot->data == lwpkt_get_data(&pkt)
+                        && (len == 0 || memcmp(slot->data, ref, len) == 0);
+
+        lwpkt_rxq_release(&pkt);
+        return equal;
+    }
+#else  /* LWPKT_CFG_RX_ZERO_COPY */
+    return len == 0 || memcmp(lwpkt_get_data(&pkt), ref, len) == 0;
+#endif /* !LWPKT_CFG_RX_ZERO_COPY */
+}
+
+/**
+ * \brief           Write and read packet with selected features
+ * \return          `1` on success, `0` otherwise
+ */
 static uint8_t
 run_test(uint8_t conf_index, uint8_t use_addr, uint8_t use_addr_ext, uint8_t use_flags, uint8_t use_cmd,
          uint8_t use_cmd_ext, uint8_t use_crc, uint8_t use_crc32) {
@@ -19,11 +71,22 @@ run_test(uint8_t conf_index, uint8_t use_addr, uint8_t use_addr_ext, uint8_t use
     uint32_t flags = 0xACCE550FUL;
     uint32_t cmd = 0x85542343UL;
     size_t data_len = strlen(data);
+    uint8_t ok = 0;
 
-    /* Limit to low-nibble for non-extended addresses and command */
+    /* Extended fields are enabled by the test only in dynamic mode */
+#if LWPKT_CFG_ADDR_EXTENDED != 2
+    use_addr_ext = LWPKT_CFG_ADDR_EXTENDED;
+#endif /* LWPKT_CFG_ADDR_EXTENDED != 2 */
+#if LWPKT_CFG_CMD_EXTENDED != 2
+    use_cmd_ext = LWPKT_CFG_CMD_EXTENDED;
+#endif /* LWPKT_CFG_CMD_EXTENDED != 2 */
+
+    /* Limit to single byte for non-extended addresses and command */
     if (!use_addr_ext) {
         our_addr &= 0xFFUL;
         dest_addr &= 0xFFUL;
+    }
+    if (!use_cmd_ext) {
         cmd &= 0xFFUL;
     }
 
@@ -49,8 +112,10 @@ run_test(uint8_t conf_index, uint8_t use_addr, uint8_t use_addr_ext, uint8_t use
 #endif /* LWPKT_CFG_USE_FLAGS */
 #if LWPKT_CFG_USE_CMD == 2
     lwpkt_set_cmd_enabled(&pkt, use_cmd);
-    lwpkt_set_cmd_extended_enabled(&pkt, use_cmd_ext);
 #endif /* LWPKT_CFG_USE_CMD */
+#if LWPKT_CFG_CMD_EXTENDED == 2
+    lwpkt_set_cmd_extended_enabled(&pkt, use_cmd_ext);
+#endif /* LWPKT_CFG_CMD_EXTENDED */
 #if LWPKT_CFG_USE_CRC == 2
     lwpkt_set_crc_enabled(&pkt, use_crc);
 #endif /* LWPKT_CFG_USE_CRC */
@@ -86,6 +151,9 @@ run_test(uint8_t conf_index, uint8_t use_addr, uint8_t use_addr_ext, uint8_t use
     printf("\r\n");
 
     /* Now read and process packet */
+#if LWPKT_CFG_RX_QUEUE
+    while (lwpkt_rxq_release(&pkt) == lwpktOK) {} /* Previous packet is not released on mismatch */
+#endif                                            /* LWPKT_CFG_RX_QUEUE */
     res = lwpkt_read(&pkt);
 
     if (res == lwpktVALID) {
@@ -107,19 +175,11 @@ run_test(uint8_t conf_index, uint8_t use_addr, uint8_t use_addr_ext, uint8_t use
 #endif /* LWPKT_CFG_USE_CMD */
         } else if (data_len != lwpkt_get_data_len(&pkt)) {
             printf("data len mismatch\r\n");
+        } else if (!prv_data_equal(data, data_len)) {
+            printf("Data mismatch\r\n");
         } else {
-            uint8_t ok = 1;
-            const uint8_t* ptr = lwpkt_get_data(&pkt);
-            for (size_t i = 0; i < data_len; ++i) {
-                if (ptr[i] != data[i]) {
-                    printf("Data mismatch at index %u\r\n", (unsigned)i);
-                    ok = 0;
-                    break;
-                }
-            }
-            if (ok) {
-                printf("Test OK\r\n");
-            }
+            printf("Test OK\r\n");
+            ok = 1;
         }
     } else if (res == lwpktINPROG) {
         printf("Packet is still in progress, did not receive yet all bytes..\r\n");
@@ -127,24 +187,1915 @@ run_test(uint8_t conf_index, uint8_t use_addr, uint8_t use_addr_ext, uint8_t use
         printf("Packet is not valid!\r\n");
     }
     printf("--\r\n");
-    return 0;
+    return ok;
 }
 
 /**
- * \brief           LwPKT example code
+ * \brief           Write packets with different lengths and garbage in-between,
+ *                  and read them in small chunks, to cover ring buffer wrap and partial reads
+ * \return          `1` on success, `0` otherwise
  */
-void
-test_lwpkt(void) {
-    printf("---\r\nLwPKT test.\r\n\r\n");
+static uint8_t
+run_test_wrap(void) {
+    static uint8_t tx_data[200];
+    uint8_t b, ok = 1;
 
-    /* Setup the lib */
-    lwrb_init(&pkt_tx_rb, pkt_tx_rb_data, sizeof(pkt_tx_rb_data));
-    lwrb_init(&pkt_rx_rb, pkt_rx_rb_data, sizeof(pkt_rx_rb_data));
-    lwpkt_init(&pkt, &pkt_tx_rb, &pkt_rx_rb);
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    for (size_t i = 0; i < sizeof(tx_data); ++i) {
+        tx_data[i] = (uint8_t)(i * 7U); /* Contains start and stop byte values too */
+    }
 
-    /* Try */
-    for (size_t i = 0; i < 1 << 7; ++i) {
-        run_test(i + 1, !!(i & 0x01), !!(i & 0x02), !!(i & 0x04), !!(i & 0x08), !!(i & 0x10), !!(i & 0x20),
-                 !!(i & 0x40));
+    for (size_t len = 0; ok && len <= sizeof(tx_data); len += 13) {
+        lwpktr_t res = lwpktWAITDATA;
+
+        /* Garbage before packet, idle delimiter in COBS mode */
+        b = LWPKT_CFG_USE_COBS == 1 ? 0x00 : 0x11;
+        lwrb_write(pkt.rx_rb, &b, 1);
+        lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                    0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                    0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                    0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                    tx_data, len);
+
+        /* Transfer in chunks of 3 bytes and process each time */
+        while (lwrb_get_full(pkt.tx_rb) > 0) {
+            uint8_t chunk[3];
+            size_t cnt = lwrb_read(pkt.tx_rb, chunk, sizeof(chunk));
+            lwrb_write(pkt.rx_rb, chunk, cnt);
+            res = lwpkt_read(&pkt);
+            if (res == lwpktVALID) {
+                break;
+            }
+        }
+        if (res != lwpktVALID || !prv_data_equal(tx_data, len)) {
+            printf("Wrap test failed for len %u\r\n", (unsigned)len);
+            ok = 0;
+        }
+    }
+    if (ok) {
+        printf("Wrap test OK\r\n");
+    }
+    return ok;
+}
+
+/**
+ * \brief           Write packet from multiple segments and verify received data
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_writev(void) {
+    static const uint8_t hdr[] = {0x01, 0x02, 0xAA}, trailer[] = {0x55, 0x04};
+    lwpkt_seg_t seg[] = {
+        {hdr, sizeof(hdr)},
+        {NULL, 0},
+        {data, 13},
+        {trailer, sizeof(trailer)},
+    };
+    uint8_t ref[sizeof(hdr) + 13 + sizeof(trailer)], b;
+
+    memcpy(ref, hdr, sizeof(hdr));
+    memcpy(&ref[sizeof(hdr)], data, 13);
+    memcpy(&ref[sizeof(hdr) + 13], trailer, sizeof(trailer));
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    lwpkt_writev(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                 0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                 0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                 0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                 seg, sizeof(seg) / sizeof(seg[0]));
+    while (lwrb_read(pkt.tx_rb, &b, 1) == 1) {
+        lwrb_write(pkt.rx_rb, &b, 1);
+    }
+    if (lwpkt_read(&pkt) != lwpktVALID || !prv_data_equal(ref, sizeof(ref))) {
+        printf("Writev test failed\r\n");
+        return 0;
+    }
+    printf("Writev test OK\r\n");
+    return 1;
+}
+
+#if LWPKT_CFG_RX_QUEUE
+
+/**
+ * \brief           Test receive packet queue, filled while application holds the packets
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_rxq(void) {
+    const lwpkt_rx_slot_t* slot;
+    uint8_t ok = 1, b;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    while (lwpkt_rxq_release(&pkt) == lwpktOK) {}
+
+    /* More packets than queue slots, each with different command and length */
+    for (size_t i = 0; i < LWPKT_CFG_RX_QUEUE + 2; ++i) {
+        lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                    0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                    0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                    (uint32_t)(0x30 + i),
+#endif /* LWPKT_CFG_USE_CMD */
+                    data, i + 1);
+    }
+    while (lwrb_read(pkt.tx_rb, &b, 1) == 1) {
+        lwrb_write(pkt.rx_rb, &b, 1);
+    }
+    for (size_t i = 0; i < LWPKT_CFG_RX_QUEUE + 2; ++i) {
+        ok = ok && lwpkt_read(&pkt) == (i < LWPKT_CFG_RX_QUEUE ? lwpktVALID : lwpktERRMEM);
+    }
+    ok = ok && lwpkt_rxq_get_count(&pkt) == LWPKT_CFG_RX_QUEUE && lwpkt_rxq_get_overflow(&pkt) == 2;
+
+    /* Packets are taken in order of reception */
+    for (size_t i = 0; ok && i < LWPKT_CFG_RX_QUEUE; ++i) {
+        slot = lwpkt_rxq_get(&pkt);
+        ok = slot != NULL && slot->len == i + 1 && memcmp(slot->data, data, i + 1) == 0;
+#if LWPKT_CFG_USE_CMD
+        ok = ok && slot->cmd == 0x30 + i;
+#endif /* LWPKT_CFG_USE_CMD */
+        ok = ok && lwpkt_rxq_release(&pkt) == lwpktOK;
+    }
+    ok = ok && lwpkt_rxq_get(&pkt) == NULL && lwpkt_rxq_release(&pkt) == lwpktERR;
+
+    printf("RX queue test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_RX_QUEUE */
+
+#if LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_COBS != 1
+
+/**
+ * \brief           Receive valid packet, that starts inside truncated packet
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_resync(void) {
+    static const char* payload[] = {"Truncated packet", "Resync\r\n"};
+    uint8_t frame[2][64];
+    size_t frame_len[2];
+    lwpktr_t res, first_res = lwpktWAITDATA;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    for (size_t i = 0; i < 2; ++i) {
+        lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                    0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                    0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                    0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                    payload[i], strlen(payload[i]));
+        frame_len[i] = lwrb_read(pkt.tx_rb, frame[i], sizeof(frame[i]));
+    }
+
+    /* Second half of first packet is lost on the line */
+    lwrb_write(pkt.rx_rb, frame[0], frame_len[0] / 2);
+    lwrb_write(pkt.rx_rb, frame[1], frame_len[1]);
+    while ((res = lwpkt_read(&pkt)) != lwpktVALID && res != lwpktWAITDATA && res != lwpktINPROG) {
+        first_res = res;
+    }
+    if (res != lwpktVALID || first_res == lwpktWAITDATA || !prv_data_equal(payload[1], strlen(payload[1]))) {
+        printf("Resync test failed\r\n");
+        return 0;
+    }
+    printf("Resync test OK\r\n");
+    return 1;
+}
+
+#endif /* LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_COBS != 1 */
+
+#if LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1
+
+/**
+ * \brief           Move all data from TX to RX buffer
+ */
+static void
+prv_tx_to_rx(void) {
+    uint8_t b;
+    while (lwrb_read(pkt.tx_rb, &b, 1) == 1) {
+        lwrb_write(pkt.rx_rb, &b, 1);
+    }
+}
+
+/**
+ * \brief           Write stream packet through almost full TX buffer
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_tx_stream(void) {
+    static uint8_t tx_data[200], fill[180];
+    size_t idx = 0, bw;
+    lwpktr_t res = lwpktERR;
+
+    for (size_t i = 0; i < sizeof(tx_data); ++i) {
+        tx_data[i] = (uint8_t)(i * 3U);
+    }
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+
+    /* Garbage in TX buffer, only small part of buffer is free */
+    memset(fill, 0x00, sizeof(fill));
+    lwrb_write(pkt.tx_rb, fill, sizeof(fill));
+    lwpkt_write_begin(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                      0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                      0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                      0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                      sizeof(tx_data));
+    while (idx < sizeof(tx_data)) {
+        lwpkt_write_chunk(&pkt, &tx_data[idx], sizeof(tx_data) - idx, &bw);
+        idx += bw;
+        prv_tx_to_rx();
+        lwpkt_read(&pkt);
+    }
+    if (lwpkt_write_end(&pkt) == lwpktOK) {
+        prv_tx_to_rx();
+        res = lwpkt_read(&pkt);
+    }
+    if (res != lwpktVALID || !prv_data_equal(tx_data, sizeof(tx_data))) {
+        printf("TX stream test failed\r\n");
+        return 0;
+    }
+    printf("TX stream test OK\r\n");
+    return 1;
+}
+
+#endif /* LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1 */
+
+#if LWPKT_CFG_TX_MPSC && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1
+
+/**
+ * \brief           Write test packet with default header fields
+ * \param[in]       d: Packet data
+ * \param[in]       len: Data length
+ * \return          Write result
+ */
+static lwpktr_t
+prv_mpsc_write(const void* d, size_t len) {
+    return lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                       0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                       0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                       0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                       d, len);
+}
+
+/**
+ * \brief           Test multi-producer transmit mode
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_mpsc(void) {
+    static const char* stream_data = "Stream packet";
+    uint8_t ok = 1;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+
+    /* Other writers are rejected while stream packet is in progress */
+    ok = ok
+         && lwpkt_write_begin(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                              0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                              0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                              0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                              strlen(stream_data))
+                == lwpktOK;
+    ok = ok && prv_mpsc_write(data, strlen(data)) == lwpktERR;
+    ok = ok && lwpkt_write_chunk(&pkt, stream_data, strlen(stream_data), NULL) == lwpktOK;
+    ok = ok && lwpkt_write_end(&pkt) == lwpktOK;
+    ok = ok && prv_mpsc_write(data, strlen(data)) == lwpktOK;
+
+    /* Packets are published in order */
+    prv_tx_to_rx();
+    ok = ok && lwpkt_read(&pkt) == lwpktVALID && prv_data_equal(stream_data, strlen(stream_data));
+    ok = ok && lwpkt_read(&pkt) == lwpktVALID && prv_data_equal(data, strlen(data));
+
+    /* Writing continues at buffer write pointer after buffer reset */
+    ok = ok && prv_mpsc_write(data, strlen(data)) == lwpktOK;
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    ok = ok && prv_mpsc_write(stream_data, strlen(stream_data)) == lwpktOK;
+    prv_tx_to_rx();
+    ok = ok && lwpkt_read(&pkt) == lwpktVALID && prv_data_equal(stream_data, strlen(stream_data));
+
+    /* Packet larger than free memory is rejected, without claiming memory */
+    while (prv_mpsc_write(data, strlen(data)) == lwpktOK) {}
+    ok = ok && prv_mpsc_write(data, strlen(data)) == lwpktERRMEM && lwrb_get_free(pkt.tx_rb) < 2U * strlen(data);
+    lwrb_reset(pkt.tx_rb);
+
+    printf("MPSC test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_TX_MPSC && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1 */
+
+#if LWPKT_CFG_USE_RX_STREAM && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1
+
+static uint8_t rx_stream_data[LWPKT_CFG_MAX_DATA_LEN + 100];
+static size_t rx_stream_len;
+static uint8_t rx_stream_starts, rx_stream_ends;
+static lwpktr_t rx_stream_res;
+
+/**
+ * \brief           Event function to collect stream packet fragments
+ * \param[in]       p: LwPKT instance
+ * \param[in]       type: Event type
+ */
+static void
+prv_rx_stream_evt_fn(lwpkt_t* p, lwpkt_evt_type_t type) {
+    switch (type) {
+        case LWPKT_EVT_STREAM_START: {
+            ++rx_stream_starts;
+            rx_stream_len = 0;
+            break;
+        }
+        case LWPKT_EVT_STREAM_DATA: {
+            const void* frag = lwpkt_get_stream_data(p);
+            if (frag != NULL && lwpkt_get_stream_data_offset(p) == rx_stream_len
+                && rx_stream_len + lwpkt_get_stream_data_len(p) <= sizeof(rx_stream_data)) {
+                memcpy(&rx_stream_data[rx_stream_len], frag, lwpkt_get_stream_data_len(p));
+                rx_stream_len += lwpkt_get_stream_data_len(p);
+            }
+            break;
+        }
+        case LWPKT_EVT_STREAM_END: {
+            ++rx_stream_ends;
+            rx_stream_res = lwpkt_get_stream_result(p);
+            break;
+        }
+        default: break;
+    }
+}
+
+/**
+ * \brief           Receive packet with data part larger than packet instance memory
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_rx_stream(void) {
+    static uint8_t tx_data[sizeof(rx_stream_data)];
+    size_t idx = 0, bw;
+    lwpktr_t res = lwpktERR;
+
+    for (size_t i = 0; i < sizeof(tx_data); ++i) {
+        tx_data[i] = (uint8_t)(i * 7U);
+    }
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    memset(rx_stream_data, 0x00, sizeof(rx_stream_data));
+    rx_stream_len = 0;
+    rx_stream_starts = rx_stream_ends = 0;
+    lwpkt_set_evt_fn(&pkt, prv_rx_stream_evt_fn);
+
+    lwpkt_write_begin(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                      0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                      0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                      0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                      sizeof(tx_data));
+    while (idx < sizeof(tx_data)) {
+        lwpkt_write_chunk(&pkt, &tx_data[idx], sizeof(tx_data) - idx, &bw);
+        idx += bw;
+        prv_tx_to_rx();
+        lwpkt_read(&pkt);
+    }
+    if (lwpkt_write_end(&pkt) == lwpktOK) {
+        prv_tx_to_rx();
+        res = lwpkt_read(&pkt);
+    }
+    lwpkt_set_evt_fn(&pkt, NULL);
+    if (res != lwpktVALID || rx_stream_starts != 1 || rx_stream_ends != 1 || rx_stream_res != lwpktVALID
+        || rx_stream_len != sizeof(tx_data) || memcmp(rx_stream_data, tx_data, sizeof(tx_data)) != 0) {
+        printf("RX stream test failed\r\n");
+        return 0;
+    }
+    printf("RX stream test OK\r\n");
+    return 1;
+}
+
+#if LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_CRC && !LWPKT_CFG_RX_ZERO_COPY
+
+/**
+ * \brief           Receive stream packet with invalid CRC in one block.
+ *                  Its data, already passed to application, must not be scanned again for packets
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_rx_stream_resync(void) {
+    static uint8_t big_tx_rb_data[1024], big_rx_rb_data[1024], frame[1024];
+    static uint8_t tx_data[sizeof(rx_stream_data)];
+    lwrb_t big_tx_rb, big_rx_rb;
+    lwpkt_t big;
+    size_t len, bw;
+    lwpktr_t res;
+    uint8_t ok = 1;
+
+    lwrb_init(&big_tx_rb, big_tx_rb_data, sizeof(big_tx_rb_data));
+    lwrb_init(&big_rx_rb, big_rx_rb_data, sizeof(big_rx_rb_data));
+    PKT_INIT(&big, &big_tx_rb, &big_rx_rb, pkt_rx_data);
+#if LWPKT_CFG_USE_COBS == 2
+    lwpkt_set_cobs_enabled(&big, 0);
+#endif /* LWPKT_CFG_USE_COBS == 2 */
+
+    /* Data part is made of valid packets */
+    lwpkt_write(&big,
+#if LWPKT_CFG_USE_ADDR
+                0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                data, strlen(data));
+    len = lwrb_read(&big_tx_rb, frame, sizeof(frame));
+    for (size_t i = 0; i < sizeof(tx_data); ++i) {
+        tx_data[i] = frame[i % len];
+    }
+    ok = ok
+         && lwpkt_write_begin(&big,
+#if LWPKT_CFG_USE_ADDR
+                              0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                              0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                              0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                              sizeof(tx_data))
+                == lwpktOK;
+    ok = ok && lwpkt_write_chunk(&big, tx_data, sizeof(tx_data), &bw) == lwpktOK && bw == sizeof(tx_data);
+    ok = ok && lwpkt_write_end(&big) == lwpktOK;
+    len = lwrb_read(&big_tx_rb, frame, sizeof(frame));
+    frame[len - 2U] ^= 0x01; /* Corrupt CRC */
+    lwrb_write(&big_rx_rb, frame, len);
+
+    rx_stream_starts = rx_stream_ends = 0;
+    lwpkt_set_evt_fn(&big, prv_rx_stream_evt_fn);
+    res = lwpkt_read(&big);
+    ok = ok && res == lwpktERRCRC && rx_stream_res == lwpktERRCRC && lwpkt_read(&big) == lwpktWAITDATA;
+    ok = ok && rx_stream_starts == 1 && rx_stream_ends == 1;
+
+    printf("RX stream resync test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_CRC && !LWPKT_CFG_RX_ZERO_COPY */
+
+#endif /* LWPKT_CFG_USE_RX_STREAM && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1 */
+
+#if LWPKT_CFG_USE_COBS
+
+/**
+ * \brief           Write COBS packet to TX buffer and check there is no delimiter inside
+ * \param[in]       d: Packet data
+ * \param[in]       len: Packet data length
+ * \return          Number of bytes written to TX buffer, `0` on failure
+ */
+static size_t
+prv_cobs_write(const void* d, size_t len) {
+    size_t full = lwrb_get_full(pkt.tx_rb), delims = 0;
+    uint8_t b;
+
+    if (lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                    0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                    0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                    0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                    d, len)
+        != lwpktOK) {
+        return 0;
+    }
+
+    /* Packet ends with delimiter, repeated as padding in multi-producer mode */
+    for (size_t i = full; i < lwrb_get_full(pkt.tx_rb); ++i) {
+        lwrb_peek(pkt.tx_rb, i, &b, 1);
+        if (b == 0x00) {
+            ++delims;
+        } else if (delims > 0) {
+            return 0;
+        }
+    }
+    if (delims == 0 || (!LWPKT_CFG_TX_MPSC && delims > 1)) {
+        return 0;
+    }
+    return lwrb_get_full(pkt.tx_rb) - full;
+}
+
+/**
+ * \brief           Send packets with COBS framing, with and without zero bytes in data,
+ *                  and receive valid packet after corrupted one or after packet with extra bytes
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_cobs(void) {
+    static const size_t lens[] = {0, 1, 13, 200, 253, 254, 255, LWPKT_CFG_MAX_DATA_LEN};
+    static uint8_t cobs_tx_rb_data[1024], cobs_rx_rb_data[1024];
+    static uint8_t tx_data[LWPKT_CFG_MAX_DATA_LEN], frame[1024];
+    lwrb_t cobs_tx_rb, cobs_rx_rb;
+    lwpktr_t res = lwpktWAITDATA;
+    size_t frame_len;
+    uint8_t ok = 1;
+
+    lwrb_init(&cobs_tx_rb, cobs_tx_rb_data, sizeof(cobs_tx_rb_data));
+    lwrb_init(&cobs_rx_rb, cobs_rx_rb_data, sizeof(cobs_rx_rb_data));
+    PKT_INIT(&pkt, &cobs_tx_rb, &cobs_rx_rb, pkt_rx_data);
+#if LWPKT_CFG_USE_COBS == 2
+    lwpkt_set_cobs_enabled(&pkt, 1);
+#endif /* LWPKT_CFG_USE_COBS == 2 */
+
+    for (size_t pattern = 0; ok && pattern < 2; ++pattern) {
+        for (size_t i = 0; i < sizeof(tx_data); ++i) {
+            tx_data[i] = pattern == 0 && (i % 31) == 0 ? 0x00 : (uint8_t)((i * 7U) | 0x01U);
+        }
+        for (size_t l = 0; ok && l < sizeof(lens) / sizeof(lens[0]); ++l) {
+            if (prv_cobs_write(tx_data, lens[l]) == 0) {
+                ok = 0;
+                break;
+            }
+
+            /* Transfer in chunks of 3 bytes and process each time */
+            res = lwpktWAITDATA;
+            while (lwrb_get_full(pkt.tx_rb) > 0) {
+                uint8_t chunk[3];
+                size_t cnt = lwrb_read(pkt.tx_rb, chunk, sizeof(chunk));
+                lwrb_write(pkt.rx_rb, chunk, cnt);
+                if ((res = lwpkt_read(&pkt)) == lwpktVALID) {
+                    break;
+                }
+            }
+            if (res != lwpktVALID || !prv_data_equal(tx_data, lens[l])) {
+                printf("COBS test failed for len %u\r\n", (unsigned)lens[l]);
+                ok = 0;
+            }
+        }
+    }
+
+    /* Corrupted packet is followed by valid one */
+    if (ok) {
+        frame_len = prv_cobs_write(tx_data, 13);
+        lwrb_read(pkt.tx_rb, frame, frame_len);
+        frame[frame_len / 2] ^= 0x10;
+        lwrb_write(pkt.rx_rb, frame, frame_len);
+        frame_len = prv_cobs_write(data, 13);
+        lwrb_read(pkt.tx_rb, frame, frame_len);
+        lwrb_write(pkt.rx_rb, frame, frame_len);
+        while ((res = lwpkt_read(&pkt)) != lwpktVALID && res != lwpktWAITDATA && res != lwpktINPROG) {}
+        if (res != lwpktVALID || !prv_data_equal(data, 13)) {
+            printf("COBS test failed for corrupted packet\r\n");
+            ok = 0;
+        }
+    }
+
+    /* Stop byte value after the packet, in the same frame, is not a valid end of the packet */
+    if (ok) {
+        size_t idx = 0;
+
+        frame_len = prv_cobs_write(tx_data, 13);
+        lwrb_read(pkt.tx_rb, frame, frame_len);
+        while (idx + frame[idx] < frame_len - 1U) {
+            idx += frame[idx];
+        }
+        ++frame[idx];
+        frame[frame_len - 1U] = 0x55;
+        frame[frame_len++] = 0x00;
+        lwrb_write(pkt.rx_rb, frame, frame_len);
+        frame_len = prv_cobs_write(data, 13);
+        lwrb_read(pkt.tx_rb, frame, frame_len);
+        lwrb_write(pkt.rx_rb, frame, frame_len);
+        while ((res = lwpkt_read(&pkt)) != lwpktVALID && res != lwpktWAITDATA && res != lwpktINPROG) {}
+        if (res != lwpktVALID || !prv_data_equal(data, 13)) {
+            printf("COBS test failed for stop byte inside frame\r\n");
+            ok = 0;
+        }
+    }
+
+    /* Restore default setup */
+    PKT_INIT(&pkt, &pkt_tx_rb, &pkt_rx_rb, pkt_rx_data);
+    if (ok) {
+        printf("COBS test OK\r\n");
+    }
+    return ok;
+}
+
+#endif /* LWPKT_CFG_USE_COBS */
+
+#if LWPKT_CFG_USE_ENGINE
+
+/* Engine channels data */
+static lwpkt_engine_t eng;
+static lwpkt_t eng_pkt[3];
+static lwrb_t eng_tx_rb[3], eng_rx_rb[3];
+static uint8_t eng_tx_rb_data[3][128], eng_rx_rb_data[3][128];
+static uint8_t eng_reads[3], eng_pkts[3], eng_timeouts[3];
+#if LWPKT_CFG_RX_DATA_EXT
+static uint8_t eng_rx_data[3][LWPKT_CFG_MAX_DATA_LEN];
+#endif /* LWPKT_CFG_RX_DATA_EXT */
+
+/**
+ * \brief           Event function for engine channels
+ * \param[in]       p: Packet instance
+ * \param[in]       type: Event type
+ */
+static void
+prv_engine_evt_fn(lwpkt_t* p, lwpkt_evt_type_t type) {
+    size_t idx = (size_t)(p - eng_pkt);
+
+    if (type == LWPKT_EVT_PRE_READ) {
+        ++eng_reads[idx];
+    } else if (type == LWPKT_EVT_PKT) {
+        ++eng_pkts[idx];
+    } else if (type == LWPKT_EVT_TIMEOUT) {
+        ++eng_timeouts[idx];
+    }
+}
+
+/**
+ * \brief           Write packet to the channel RX buffer, as it would come from the line
+ * \param[in]       idx: Channel index
+ * \param[in]       div: Divider of frame length, to write only part of the frame
+ */
+static void
+prv_engine_rx(size_t idx, size_t div) {
+    uint8_t frame[64];
+    size_t frame_len;
+
+    lwpkt_write(&eng_pkt[idx],
+#if LWPKT_CFG_USE_ADDR
+                0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                data, strlen(data));
+    frame_len = lwrb_read(eng_pkt[idx].tx_rb, frame, sizeof(frame));
+    lwrb_write(eng_pkt[idx].rx_rb, frame, frame_len / div);
+}
+
+/**
+ * \brief           Test multi-channel engine, servicing only channels with new data or timeout
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_engine(void) {
+    uint8_t ok = 1;
+
+    memset(eng_reads, 0x00, sizeof(eng_reads));
+    memset(eng_pkts, 0x00, sizeof(eng_pkts));
+    memset(eng_timeouts, 0x00, sizeof(eng_timeouts));
+    lwpkt_engine_init(&eng);
+    for (size_t i = 0; i < 3; ++i) {
+        lwrb_init(&eng_tx_rb[i], eng_tx_rb_data[i], sizeof(eng_tx_rb_data[i]));
+        lwrb_init(&eng_rx_rb[i], eng_rx_rb_data[i], sizeof(eng_rx_rb_data[i]));
+        PKT_INIT(&eng_pkt[i], &eng_tx_rb[i], &eng_rx_rb[i], eng_rx_data[i]);
+        lwpkt_set_evt_fn(&eng_pkt[i], prv_engine_evt_fn);
+        ok = ok && lwpkt_engine_add(&eng, &eng_pkt[i]) == lwpktOK;
+    }
+    ok = ok && lwpkt_engine_add(&eng, &eng_pkt[0]) == lwpktERR;
+
+    /* All channels are serviced once after add */
+    ok = ok && lwpkt_engine_process(&eng, 1000) == lwpktOK;
+    ok = ok && eng_reads[0] == 1 && eng_reads[1] == 1 && eng_reads[2] == 1;
+    ok = ok && lwpkt_engine_process(&eng, 1000) == lwpktOK;
+    ok = ok && eng_reads[0] == 1 && eng_reads[1] == 1 && eng_reads[2] == 1;
+
+    /* Full packet on first channel, half of the packet on second, nothing on third */
+    prv_engine_rx(0, 1);
+    prv_engine_rx(1, 2);
+    ok = ok && lwpkt_engine_process(&eng, 1000) == lwpktINPROG;
+    ok = ok && lwpkt_engine_process(&eng, 1005) == lwpktOK;
+    ok = ok && eng_pkts[0] == 1 && eng_pkts[1] == 0 && eng_reads[1] == 2 && eng_reads[2] == 1;
+
+    /* Second channel times out from the timer wheel only */
+    ok = ok && lwpkt_engine_process(&eng, 1000 + LWPKT_CFG_PROCESS_INPROG_TIMEOUT - 1) == lwpktOK;
+    ok = ok && eng_timeouts[1] == 0;
+    ok = ok && lwpkt_engine_process(&eng, 1000 + LWPKT_CFG_PROCESS_INPROG_TIMEOUT + LWPKT_CFG_ENGINE_WHEEL_TICK)
+                   == lwpktOK;
+    ok = ok && eng_timeouts[0] == 0 && eng_timeouts[1] == 1 && eng_timeouts[2] == 0 && eng_reads[2] == 1;
+
+    /* Idle line aborts packet in progress before timeout */
+    prv_engine_rx(1, 2);
+    ok = ok && lwpkt_engine_process(&eng, 1500) == lwpktOK && eng_timeouts[1] == 1;
+    lwpkt_rx_idle(&eng_pkt[1]);
+    ok = ok && lwpkt_engine_process(&eng, 1501) == lwpktOK && eng_timeouts[1] == 2;
+
+    /* Removed channel is not serviced anymore */
+    ok = ok && lwpkt_engine_remove(&eng, &eng_pkt[2]) == lwpktOK;
+    prv_engine_rx(2, 1);
+    ok = ok && lwpkt_engine_process(&eng, 2000) == lwpktOK && eng_reads[2] == 1;
+
+    printf("Engine test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_USE_ENGINE */
+
+#if LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES
+static uint32_t stats_cycles;
+
+/**
+ * \brief           Cycle counter for statistics, advanced by fixed step on every call
+ * \return          Current counter value
+ */
+uint32_t
+lwpkt_stats_get_cycles(void) {
+    stats_cycles += 10;
+    return stats_cycles;
+}
+#endif /* LWPKT_CFG_USE_STATS && LWPKT_CFG_STATS_CYCLES */
+
+#if LWPKT_CFG_USE_STATS && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1
+
+/**
+ * \brief           Receive garbage, invalid and valid packet and check statistics counters
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_stats(void) {
+    static const uint8_t garbage[] = {0x01, 0x02, 0x03};
+    uint8_t frame[2][64], ok = 1;
+    size_t frame_len[2], reads = 0;
+    lwpkt_stats_t stats;
+    lwpktr_t res;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+#if LWPKT_CFG_USE_CRC == 2
+    lwpkt_set_crc_enabled(&pkt, 1);
+#endif /* LWPKT_CFG_USE_CRC == 2 */
+    lwpkt_reset_stats(&pkt);
+    for (size_t i = 0; i < 2; ++i) {
+        lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                    0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                    0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                    0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                    data, strlen(data));
+        frame_len[i] = lwrb_read(pkt.tx_rb, frame[i], sizeof(frame[i]));
+    }
+
+    /* Garbage, packet with invalid CRC and valid packet */
+    frame[0][frame_len[0] - 2] ^= 0x01;
+    lwrb_write(pkt.rx_rb, garbage, sizeof(garbage));
+    lwrb_write(pkt.rx_rb, frame[0], frame_len[0]);
+    lwrb_write(pkt.rx_rb, frame[1], frame_len[1]);
+    do {
+        res = lwpkt_read(&pkt);
+        ++reads;
+        if (res == lwpktVALID) {
+            ok = ok && prv_data_equal(data, strlen(data));
+        }
+    } while (res != lwpktWAITDATA);
+
+    ok = ok && lwpkt_get_stats(&pkt, &stats) == lwpktOK;
+    ok = ok && stats.tx_pkts == 2 && stats.tx_bytes == frame_len[0] + frame_len[1] && stats.tx_err_mem == 0
+         && stats.tx_rb_max == frame_len[0];
+    ok = ok && stats.rx_pkts == 1 && stats.rx_err_crc == 1 && stats.rx_err_stop == 0 && stats.rx_err_mem == 0
+         && stats.rx_bytes == sizeof(garbage) + frame_len[0] + frame_len[1]
+         && stats.rx_rb_max == sizeof(garbage) + frame_len[0] + frame_len[1];
+#if LWPKT_CFG_RX_RESYNC
+    /* Bytes of invalid packet are scanned again and discarded */
+    ok = ok && stats.rx_resync == 1 && stats.rx_skipped == sizeof(garbage) + frame_len[0] - 1;
+#else  /* LWPKT_CFG_RX_RESYNC */
+    /* CRC is checked before stop byte, which is then discarded */
+    ok = ok && stats.rx_resync == 0 && stats.rx_skipped == sizeof(garbage) + 1;
+#endif /* !LWPKT_CFG_RX_RESYNC */
+#if LWPKT_CFG_STATS_CYCLES
+    ok = ok && stats.read_calls == reads && stats.read_cycles == 10 * reads && stats.read_cycles_max == 10
+         && stats.write_calls == 2 && stats.write_cycles_max == 10;
+#else  /* LWPKT_CFG_STATS_CYCLES */
+    (void)reads;
+#endif /* !LWPKT_CFG_STATS_CYCLES */
+
+    /* Counters start again from zero */
+    ok = ok && lwpkt_reset_stats(&pkt) == lwpktOK && lwpkt_get_stats(&pkt, &stats) == lwpktOK && stats.rx_bytes == 0;
+
+    printf("Stats test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_USE_STATS && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1 */
+
+/**
+ * \brief           Write packet to the TX buffer and read it to the frame
+ * \param[out]      frame: Frame memory of `64` bytes
+ * \return          Frame length
+ */
+static size_t
+prv_rx_timeout_frame(uint8_t* frame) {
+    lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                data, strlen(data));
+    return lwrb_read(pkt.tx_rb, frame, 64);
+}
+
+/**
+ * \brief           Test timeout, restarted with every byte, and abort of packet with idle line notification
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_rx_timeout(void) {
+    uint8_t frame[64], ok = 1;
+    size_t frame_len, len;
+    uint32_t time = 0;
+    lwpktr_t res = lwpktINPROG;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+#if LWPKT_CFG_RX_QUEUE
+    while (lwpkt_rxq_release(&pkt) == lwpktOK) {}
+#endif /* LWPKT_CFG_RX_QUEUE */
+    frame_len = prv_rx_timeout_frame(frame);
+    ok = ok && lwpkt_set_timeout(&pkt, 50) == lwpktOK;
+    ok = ok && lwpkt_process(&pkt, time) == lwpktWAITDATA;
+
+    /* Slow packet, longer than timeout, but with short gaps between bytes */
+    for (size_t i = 0; i < frame_len; ++i) {
+        lwrb_write(pkt.rx_rb, &frame[i], 1);
+        time += 40;
+        res = lwpkt_process(&pkt, time);
+        ok = ok && (i + 1 == frame_len ? res == lwpktVALID : res == lwpktINPROG);
+    }
+    ok = ok && time > 100;
+#if LWPKT_CFG_RX_QUEUE
+    lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+
+    /* Truncated packet is aborted with idle line notification, next packet is received */
+    lwrb_write(pkt.rx_rb, frame, frame_len / 2);
+    ok = ok && lwpkt_process(&pkt, ++time) == lwpktINPROG;
+    ok = ok && lwpkt_rx_idle(&pkt) == lwpktOK;
+    ok = ok && lwpkt_process(&pkt, ++time) == lwpktINPROG;
+    lwrb_write(pkt.rx_rb, frame, frame_len);
+    ok = ok && lwpkt_process(&pkt, ++time) == lwpktVALID;
+#if LWPKT_CFG_RX_QUEUE
+    lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+
+    /* Notification is not valid anymore, when new bytes come after it */
+    lwrb_write(pkt.rx_rb, frame, frame_len / 2);
+    ok = ok && lwpkt_process(&pkt, ++time) == lwpktINPROG;
+    lwpkt_rx_idle(&pkt);
+    lwrb_write(pkt.rx_rb, &frame[frame_len / 2], frame_len - frame_len / 2);
+    ok = ok && lwpkt_process(&pkt, ++time) == lwpktVALID;
+#if LWPKT_CFG_RX_QUEUE
+    lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+    ok = ok && lwpkt_process(&pkt, ++time) == lwpktWAITDATA && pkt.rx_idle_seq == pkt.rx_idle_seen;
+
+    /* Notification does not abort next packet, after write address wraps by exactly the buffer size */
+    if ((pkt.rx_rb->size % frame_len) != 0) {
+        lwpkt_rx_idle(&pkt);
+        ok = ok && lwpkt_process(&pkt, ++time) == lwpktWAITDATA;
+        for (len = pkt.rx_rb->size; len > frame_len; len -= frame_len) {
+            lwrb_write(pkt.rx_rb, frame, frame_len);
+            ok = ok && lwpkt_read(&pkt) == lwpktVALID;
+#if LWPKT_CFG_RX_QUEUE
+            lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+        }
+        lwrb_write(pkt.rx_rb, frame, len);
+        ok = ok && lwpkt_process(&pkt, ++time) == lwpktINPROG;
+        lwrb_write(pkt.rx_rb, &frame[len], frame_len - len);
+        ok = ok && lwpkt_process(&pkt, ++time) == lwpktVALID;
+#if LWPKT_CFG_RX_QUEUE
+        lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+    }
+
+    lwpkt_set_timeout(&pkt, LWPKT_CFG_PROCESS_INPROG_TIMEOUT);
+    printf("RX timeout test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#if LWPKT_CFG_TRACE
+static uint32_t trace_time;
+
+/**
+ * \brief           Clock for packet latency trace, advanced by one on every call
+ * \return          Current time
+ */
+uint32_t
+lwpkt_trace_get_time(void) {
+    return ++trace_time;
+}
+#endif /* LWPKT_CFG_TRACE */
+
+#if LWPKT_CFG_TRACE && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1
+
+/**
+ * \brief           Receive valid, invalid and unfinished packet and check trace records
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_trace(void) {
+    uint8_t frame[64], ok = 1;
+    size_t frame_len;
+    lwpkt_trace_t rec;
+    uint32_t lost;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+#if LWPKT_CFG_USE_CRC == 2
+    lwpkt_set_crc_enabled(&pkt, 1);
+#endif /* LWPKT_CFG_USE_CRC == 2 */
+    while (lwpkt_trace_read(&pkt, &rec) == lwpktOK) {}
+#if LWPKT_CFG_RX_QUEUE
+    while (lwpkt_rxq_release(&pkt) == lwpktOK) {}
+#endif /* LWPKT_CFG_RX_QUEUE */
+    lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                data, strlen(data));
+    frame_len = lwrb_read(pkt.tx_rb, frame, sizeof(frame));
+
+    /* Valid packet, processed in two parts, gets all stages in order */
+    lwrb_write(pkt.rx_rb, frame, frame_len / 2);
+    ok = ok && lwpkt_process(&pkt, 0) == lwpktINPROG && lwpkt_trace_get_count(&pkt) == 0;
+    lwrb_write(pkt.rx_rb, &frame[frame_len / 2], frame_len - frame_len / 2);
+    ok = ok && lwpkt_process(&pkt, 1) == lwpktVALID && lwpkt_trace_read(&pkt, &rec) == lwpktOK;
+#if LWPKT_CFG_RX_QUEUE
+    lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+    ok = ok && rec.res == lwpktVALID && rec.len == strlen(data)
+         && rec.stages
+                == (LWPKT_TRACE_STAGE_START | LWPKT_TRACE_STAGE_HDR | LWPKT_TRACE_STAGE_DATA
+                    | LWPKT_TRACE_STAGE_VERDICT | LWPKT_TRACE_STAGE_EVT)
+         && rec.start < rec.hdr && rec.hdr < rec.data && rec.data < rec.verdict && rec.verdict < rec.evt;
+
+    /* Packet with invalid CRC, read without process, has no event */
+    frame[frame_len - 2] ^= 0x01;
+    lwrb_write(pkt.rx_rb, frame, frame_len);
+    ok = ok && lwpkt_read(&pkt) == lwpktERRCRC && lwpkt_trace_read(&pkt, &rec) == lwpktOK;
+    ok = ok && rec.res == lwpktERRCRC && !(rec.stages & LWPKT_TRACE_STAGE_EVT)
+         && (rec.stages & LWPKT_TRACE_STAGE_VERDICT);
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.rx_rb);
+    frame[frame_len - 2] ^= 0x01;
+
+    /* Unfinished packet ends with timeout */
+    lwrb_write(pkt.rx_rb, frame, frame_len / 2);
+    ok = ok && lwpkt_process(&pkt, 10) == lwpktINPROG && lwpkt_trace_get_count(&pkt) == 0;
+    ok = ok && lwpkt_process(&pkt, 10 + LWPKT_CFG_PROCESS_INPROG_TIMEOUT) == lwpktINPROG
+         && lwpkt_trace_read(&pkt, &rec) == lwpktOK;
+    ok = ok && rec.res == lwpktINPROG && !(rec.stages & LWPKT_TRACE_STAGE_DATA)
+         && (rec.stages & LWPKT_TRACE_STAGE_EVT) && rec.verdict < rec.evt;
+    lwrb_reset(pkt.rx_rb);
+
+    /* Records are dropped, when trace is full */
+    lost = lwpkt_trace_get_lost(&pkt);
+    for (size_t i = 0; i < LWPKT_CFG_TRACE + 1; ++i) {
+        lwrb_write(pkt.rx_rb, frame, frame_len);
+        ok = ok && lwpkt_read(&pkt) == lwpktVALID;
+#if LWPKT_CFG_RX_QUEUE
+        lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+    }
+    ok = ok && lwpkt_trace_get_count(&pkt) == LWPKT_CFG_TRACE && lwpkt_trace_get_lost(&pkt) == lost + 1;
+    while (lwpkt_trace_read(&pkt, &rec) == lwpktOK) {}
+    ok = ok && lwpkt_trace_get_count(&pkt) == 0;
+
+    printf("Trace test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_TRACE && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1 */
+
+#if LWPKT_CFG_RX_FILTER && LWPKT_CFG_USE_ADDR && LWPKT_CFG_USE_CMD
+
+/**
+ * \brief           Test receive filter with address and command
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_filter(void) {
+    static const uint32_t cmds[] = {0x34, 0x35};
+    static const struct {
+        lwpkt_addr_t to;
+        uint32_t cmd;
+        uint8_t accept;
+    } pkts[] = {
+        {0x21, 0x34, 0},
+        {0x12, 0x34, 1},
+        {LWPKT_CFG_ADDR_BROADCAST, 0x35, 1},
+        {0x12, 0x36, 0},
+        {0x02, 0x35, 1},
+    };
+    lwpkt_filter_t filter = {.addr_mask = 0x0F, .broadcast = 1, .cmd = cmds, .cmd_cnt = 2};
+    lwpkt_addr_t addr = pkt.addr;
+    size_t valid = 0, expected = 0;
+    uint8_t ok = 1;
+    lwpktr_t res;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+#if LWPKT_CFG_USE_ADDR == 2
+    lwpkt_set_addr_enabled(&pkt, 1);
+#endif /* LWPKT_CFG_USE_ADDR == 2 */
+#if LWPKT_CFG_USE_CMD == 2
+    lwpkt_set_cmd_enabled(&pkt, 1);
+#endif /* LWPKT_CFG_USE_CMD == 2 */
+#if LWPKT_CFG_USE_STATS
+    lwpkt_reset_stats(&pkt);
+#endif /* LWPKT_CFG_USE_STATS */
+    lwpkt_set_addr(&pkt, 0x12);
+    lwpkt_set_filter(&pkt, &filter);
+
+    /* Last packet matches only in address bits, selected by the mask */
+    for (size_t i = 0; ok && i < sizeof(pkts) / sizeof(pkts[0]); ++i) {
+        ok = lwpkt_write(&pkt, pkts[i].to,
+#if LWPKT_CFG_USE_FLAGS
+                         0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+                         pkts[i].cmd, data, strlen(data))
+             == lwpktOK;
+        expected += pkts[i].accept;
+#if LWPKT_CFG_TX_FRAMES
+        /* Frame queue may have less entries than packets, frames are transmitted after every write */
+        {
+            const lwpkt_tx_frame_t* frame;
+
+            while ((frame = lwpkt_txq_get(&pkt)) != NULL) {
+                lwrb_write(pkt.rx_rb, frame->seg[0].data, frame->seg[0].len);
+                lwrb_write(pkt.rx_rb, frame->seg[1].data, frame->seg[1].len);
+                lwpkt_txq_release(&pkt);
+            }
+        }
+#endif /* LWPKT_CFG_TX_FRAMES */
+    }
+#if !LWPKT_CFG_TX_FRAMES
+    lwrb_write(pkt.rx_rb, lwrb_get_linear_block_read_address(pkt.tx_rb), lwrb_get_linear_block_read_length(pkt.tx_rb));
+    lwrb_skip(pkt.tx_rb, lwrb_get_linear_block_read_length(pkt.tx_rb));
+#endif /* !LWPKT_CFG_TX_FRAMES */
+    do {
+        res = lwpkt_read(&pkt);
+        if (res == lwpktVALID) {
+            ok = ok && lwpkt_get_cmd(&pkt) != 0x36 && prv_data_equal(data, strlen(data));
+            ++valid;
+        }
+    } while (res != lwpktWAITDATA);
+    ok = ok && valid == expected;
+#if LWPKT_CFG_USE_STATS
+    {
+        lwpkt_stats_t stats;
+        ok = ok && lwpkt_get_stats(&pkt, &stats) == lwpktOK && stats.rx_filtered == 2 && stats.rx_pkts == expected;
+    }
+#endif /* LWPKT_CFG_USE_STATS */
+
+    lwpkt_set_filter(&pkt, NULL);
+    lwpkt_set_addr(&pkt, addr);
+
+    printf("Filter test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_RX_FILTER && LWPKT_CFG_USE_ADDR && LWPKT_CFG_USE_CMD */
+
+#if LWPKT_CFG_TX_FRAMES
+
+/**
+ * \brief           Write packet with data of `len` bytes
+ * \param[in]       len: Data length
+ * \return          Result of write operation
+ */
+static lwpktr_t
+prv_txq_write(size_t len) {
+    return lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                       0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                       0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                       0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                       data, len);
+}
+
+/**
+ * \brief           Transmit frames from the queue to RX buffer, frame by frame, and check received packets
+ * \param[in]       cnt: Expected number of frames
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+prv_txq_transmit(size_t cnt) {
+    const lwpkt_tx_frame_t* frame;
+    uint8_t ok = lwpkt_txq_get_count(&pkt) == cnt;
+
+    while (ok && (frame = lwpkt_txq_get(&pkt)) != NULL) {
+        lwrb_write(pkt.rx_rb, frame->seg[0].data, frame->seg[0].len);
+        lwrb_write(pkt.rx_rb, frame->seg[1].data, frame->seg[1].len);
+        ok = lwpkt_txq_release(&pkt) == lwpktOK;
+        ok = ok && lwpkt_read(&pkt) == lwpktVALID && prv_data_equal(data, strlen(data));
+    }
+    return ok && lwpkt_txq_get_count(&pkt) == 0 && lwrb_get_full(pkt.tx_rb) == 0;
+}
+
+/**
+ * \brief           Test transmit frame queue, with frames at the end of TX buffer memory
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_txq(void) {
+    const lwpkt_tx_frame_t* frame = NULL;
+    size_t cnt = 0, len = 0;
+    uint8_t ok = 1;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+
+    /* Queue is full, before buffer memory */
+    while (prv_txq_write(strlen(data)) == lwpktOK) {
+        ++cnt;
+    }
+    ok = ok && cnt == LWPKT_CFG_TX_FRAMES && lwrb_get_free(pkt.tx_rb) > 0;
+    ok = ok && prv_txq_transmit(cnt);
+
+    /* Second frame does not fit to the end of memory */
+    ok = ok && prv_txq_write(strlen(data)) == lwpktOK && (frame = lwpkt_txq_get(&pkt)) != NULL;
+    if (ok) {
+        len = frame->seg[0].len + frame->seg[1].len;
+    }
+    ok = ok && prv_txq_transmit(1);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_advance(pkt.tx_rb, pkt.tx_rb->size - 10U - len);
+    lwrb_skip(pkt.tx_rb, pkt.tx_rb->size - 10U - len);
+    ok = ok && prv_txq_write(strlen(data)) == lwpktOK && prv_txq_write(strlen(data)) == lwpktOK;
+    ok = ok && (frame = lwpkt_txq_get(&pkt)) != NULL && frame->seg[0].len == len && frame->seg[1].len == 0;
+    if (ok) {
+        lwrb_write(pkt.rx_rb, frame->seg[0].data, frame->seg[0].len);
+    }
+    ok = ok && lwpkt_txq_release(&pkt) == lwpktOK && lwpkt_read(&pkt) == lwpktVALID
+         && prv_data_equal(data, strlen(data));
+    ok = ok && (frame = lwpkt_txq_get(&pkt)) != NULL;
+#if LWPKT_CFG_TX_FRAMES_NOWRAP
+    ok = ok && frame->pad == 10U && frame->seg[0].data == pkt.tx_rb->buff && frame->seg[1].len == 0;
+#else  /* LWPKT_CFG_TX_FRAMES_NOWRAP */
+    ok = ok && frame->pad == 0 && frame->seg[0].len == 10U && frame->seg[1].data == pkt.tx_rb->buff;
+#endif /* !LWPKT_CFG_TX_FRAMES_NOWRAP */
+    ok = ok && prv_txq_transmit(1);
+
+    /* Frames are dropped, when buffer is read directly */
+    ok = ok && prv_txq_write(strlen(data)) == lwpktOK;
+    lwrb_reset(pkt.tx_rb);
+    ok = ok && prv_txq_write(strlen(data)) == lwpktOK && prv_txq_transmit(1);
+
+    printf("TX frame queue test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_TX_FRAMES */
+
+#if LWPKT_CFG_TX_LANES > 1
+
+/**
+ * \brief           Test transmit scheduler, with high priority frame written during transmission of bulk frame
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_tx_sched(void) {
+    static uint8_t hi_tx_rb_data[64];
+    const lwpkt_tx_frame_t* frame;
+    lwpkt_tx_sched_t sched;
+    lwrb_t hi_tx_rb;
+    lwpkt_t hi;
+    size_t bulk_len;
+    uint8_t ok = 1;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    lwrb_init(&hi_tx_rb, hi_tx_rb_data, sizeof(hi_tx_rb_data));
+    lwpkt_init(&hi, &hi_tx_rb, NULL);
+    ok = ok && lwpkt_tx_sched_init(&sched) == lwpktOK && lwpkt_tx_sched_get(&sched) == NULL;
+    ok = ok && lwpkt_tx_sched_set_lane(&sched, 0, &hi) == lwpktOK && lwpkt_tx_sched_set_lane(&sched, 1, &pkt) == lwpktOK;
+    ok = ok && lwpkt_tx_sched_set_lane(&sched, LWPKT_CFG_TX_LANES, &pkt) == lwpktERR;
+
+    /* Two bulk frames, first one is in transmission when high priority frame is written */
+    ok = ok && prv_txq_write(strlen(data)) == lwpktOK && prv_txq_write(strlen(data)) == lwpktOK;
+    ok = ok && (frame = lwpkt_tx_sched_get(&sched)) != NULL && sched.cur == &pkt;
+    bulk_len = frame->seg[0].len + frame->seg[1].len;
+    ok = ok && lwpkt_write(&hi,
+#if LWPKT_CFG_USE_ADDR
+                           0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                           0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                           0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                           data, 1)
+                   == lwpktOK;
+    ok = ok && lwpkt_tx_sched_get(&sched) == frame && lwpkt_tx_sched_set_lane(&sched, 1, NULL) == lwpktERR;
+    ok = ok && lwpkt_tx_sched_release(&sched) == lwpktOK;
+
+    /* High priority frame goes before second bulk frame */
+    ok = ok && (frame = lwpkt_tx_sched_get(&sched)) != NULL && sched.cur == &hi;
+    ok = ok && frame->seg[0].data == hi_tx_rb_data && lwpkt_tx_sched_release(&sched) == lwpktOK;
+    ok = ok && (frame = lwpkt_tx_sched_get(&sched)) != NULL && sched.cur == &pkt
+         && frame->seg[0].len + frame->seg[1].len == bulk_len;
+    ok = ok && lwpkt_tx_sched_release(&sched) == lwpktOK;
+    ok = ok && lwpkt_tx_sched_get(&sched) == NULL && lwpkt_tx_sched_release(&sched) == lwpktERR;
+
+    printf("TX scheduler test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_TX_LANES > 1 */
+
+#if LWPKT_CFG_USE_FRAG && LWPKT_CFG_FRAG_MAX_CNT >= 10
+
+/**
+ * \brief           Write message to the fragmentation instance
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       msg: Message data
+ * \param[in]       len: Message length
+ * \return          Result of write operation
+ */
+static lwpktr_t
+prv_frag_write(lwpkt_frag_t* frag, const void* msg, size_t len) {
+    return lwpkt_frag_write(frag,
+#if LWPKT_CFG_USE_ADDR
+                            0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                            0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                            0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                            msg, len);
+}
+
+/**
+ * \brief           Move written fragments from TX to RX buffer and input them to the fragmentation instance
+ * \param[in]       frag: Fragmentation instance
+ * \param[in]       drop: Index of packet to drop, counted from `0` in this call. Use `-1` to keep all packets
+ * \param[in]       time: Current time
+ * \return          Result of last fragment input, \ref lwpktERR if no packet has been received
+ */
+static lwpktr_t
+prv_frag_transfer(lwpkt_frag_t* frag, int drop, uint32_t time) {
+    uint8_t buff[256];
+    lwpktr_t res = lwpktERR;
+    size_t len;
+
+    len = lwrb_read(pkt.tx_rb, buff, sizeof(buff));
+    lwrb_write(pkt.rx_rb, buff, len);
+    for (int i = 0; lwpkt_read(&pkt) == lwpktVALID; ++i) {
+        if (i != drop) {
+            res = lwpkt_frag_input(frag, time);
+        }
+#if LWPKT_CFG_RX_QUEUE
+        lwpkt_rxq_release(&pkt);
+#endif /* LWPKT_CFG_RX_QUEUE */
+    }
+    return res;
+}
+
+/**
+ * \brief           Write message larger than TX buffer, with lost and resent fragment, and abort message on timeout
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_frag(void) {
+    static uint8_t msg[300], rx_msg[sizeof(msg)];
+    lwpkt_frag_t frag;
+    uint8_t ok = 1;
+
+    for (size_t i = 0; i < sizeof(msg); ++i) {
+        msg[i] = (uint8_t)(i * 7U);
+    }
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+#if LWPKT_CFG_RX_QUEUE
+    while (lwpkt_rxq_release(&pkt) == lwpktOK) {}
+#endif /* LWPKT_CFG_RX_QUEUE */
+    ok = ok && lwpkt_frag_init(&frag, &pkt, 32, rx_msg, sizeof(rx_msg)) == lwpktOK;
+    ok = ok && lwpkt_frag_set_timeout(&frag, 100) == lwpktOK;
+
+    /* Message does not fit to TX buffer at once, third fragment is lost */
+    ok = ok && prv_frag_write(&frag, msg, sizeof(msg)) == lwpktINPROG && frag.tx.cnt == 10U;
+    ok = ok && prv_frag_write(&frag, msg, sizeof(msg)) == lwpktERR;
+    ok = ok && prv_frag_transfer(&frag, 2, 0) == lwpktINPROG;
+    for (size_t i = 0; ok && lwpkt_frag_process(&frag, 0) == lwpktINPROG && frag.tx.idx < frag.tx.cnt; ++i) {
+        ok = ok && i < 10U && prv_frag_transfer(&frag, -1, 0) == lwpktINPROG;
+    }
+    ok = ok && prv_frag_transfer(&frag, -1, 0) == lwpktINPROG && frag.rx.rcvd == 9U;
+    ok = ok && lwpkt_frag_process(&frag, 10) == lwpktINPROG && lwpkt_frag_resend(&frag, 10) == lwpktERR;
+
+    /* Resent fragment completes the message, resending it again is ignored */
+    ok = ok && lwpkt_frag_resend(&frag, 2) == lwpktOK && prv_frag_transfer(&frag, -1, 20) == lwpktVALID;
+    ok = ok && lwpkt_frag_get_len(&frag) == sizeof(msg) && memcmp(lwpkt_frag_get_data(&frag), msg, sizeof(msg)) == 0;
+    ok = ok && lwpkt_frag_resend(&frag, 9) == lwpktOK && prv_frag_transfer(&frag, -1, 30) == lwpktOK;
+    ok = ok && lwpkt_frag_process(&frag, 40) == lwpktOK && lwpkt_frag_get_lost(&frag) == 0;
+
+    /* Message is aborted, when next fragment does not arrive within timeout */
+    ok = ok && prv_frag_write(&frag, msg, 40) == lwpktOK && prv_frag_transfer(&frag, 1, 50) == lwpktINPROG;
+    ok = ok && lwpkt_frag_process(&frag, 149) == lwpktINPROG && lwpkt_frag_process(&frag, 150) == lwpktOK;
+    ok = ok && lwpkt_frag_get_lost(&frag) == 1U;
+
+    /* Single empty fragment and message too large for receive memory */
+    ok = ok && prv_frag_write(&frag, msg, 0) == lwpktOK && prv_frag_transfer(&frag, -1, 200) == lwpktVALID;
+    ok = ok && lwpkt_frag_get_len(&frag) == 0;
+    ok = ok && lwpkt_frag_init(&frag, &pkt, 32, rx_msg, 40) == lwpktOK;
+    ok = ok && prv_frag_write(&frag, msg, 70) == lwpktOK && prv_frag_transfer(&frag, -1, 0) == lwpktERRMEM;
+
+    printf("Fragmentation test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_USE_FRAG && LWPKT_CFG_FRAG_MAX_CNT >= 10 */
+
+#if LWPKT_CFG_USE_GW && LWPKT_CFG_RX_QUEUE && LWPKT_CFG_GW_STREAMS >= 6
+
+#define GW_TEST_STREAMS 6
+#define GW_TEST_PKTS    24
+#define GW_TEST_WORKERS (LWPKT_CFG_GW_WORKERS < 3 ? LWPKT_CFG_GW_WORKERS : 3)
+
+/**
+ * \brief           Test gateway, with pipe streams read and processed by multiple workers
+ *
+ * Packets are written faster than taken from receive packet queues,
+ * hence they are kept in small RX buffers and pipes, until queue slots are released.
+ *
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_gw(void) {
+    static lwpkt_t gw_pkt[GW_TEST_STREAMS];
+    static lwrb_t gw_tx_rb[GW_TEST_STREAMS], gw_rx_rb[GW_TEST_STREAMS];
+    static uint8_t gw_tx_rb_data[GW_TEST_STREAMS][64], gw_rx_rb_data[GW_TEST_STREAMS][48];
+    static lwpkt_gw_t gw;
+    const lwpkt_rx_slot_t* slot;
+    size_t rcvd[GW_TEST_STREAMS] = {0}, total = 0, len;
+    int fds[GW_TEST_STREAMS][2];
+    uint8_t ok = 1, b[64];
+
+    ok = ok && lwpkt_gw_init(&gw, 0) == lwpktERR && lwpkt_gw_init(&gw, GW_TEST_WORKERS) == lwpktOK;
+    ok = ok && lwpkt_gw_set_affinity(&gw, 0, 0) == lwpktOK;
+    ok = ok && lwpkt_gw_set_affinity(&gw, GW_TEST_WORKERS, 0) == lwpktERR;
+    for (size_t i = 0; ok && i < GW_TEST_STREAMS; ++i) {
+        ok = pipe(fds[i]) == 0;
+        ok = ok && lwrb_init(&gw_tx_rb[i], gw_tx_rb_data[i], sizeof(gw_tx_rb_data[i]));
+        ok = ok && lwrb_init(&gw_rx_rb[i], gw_rx_rb_data[i], sizeof(gw_rx_rb_data[i]));
+        ok = ok && lwpkt_init(&gw_pkt[i], &gw_tx_rb[i], &gw_rx_rb[i]) == lwpktOK;
+        ok = ok && lwpkt_gw_add(&gw, &gw_pkt[i], fds[i][0]) == lwpktOK;
+    }
+    ok = ok && lwpkt_gw_add(&gw, &gw_pkt[0], fds[0][0]) == lwpktERR;
+    ok = ok && lwpkt_gw_get_open(&gw) == GW_TEST_STREAMS && lwpkt_gw_start(&gw) == lwpktOK;
+
+    /* Each packet is written to all streams, with different command and length */
+    for (size_t p = 0; ok && p < GW_TEST_PKTS; ++p) {
+        for (size_t i = 0; ok && i < GW_TEST_STREAMS; ++i) {
+            ok = lwpkt_write(&gw_pkt[i],
+#if LWPKT_CFG_USE_ADDR
+                             0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                             0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                             (uint32_t)(0x40 + p),
+#endif /* LWPKT_CFG_USE_CMD */
+                             data, p % 13U + 1U)
+                 == lwpktOK;
+            len = lwrb_read(&gw_tx_rb[i], b, sizeof(b));
+            ok = ok && write(fds[i][1], b, len) == (ssize_t)len;
+        }
+    }
+    for (size_t i = 0; i < GW_TEST_STREAMS; ++i) {
+        close(fds[i][1]);
+    }
+
+    /* All packets are received in order, streams are closed once pipes are empty */
+    for (size_t wait = 0; ok && (total < GW_TEST_STREAMS * GW_TEST_PKTS || lwpkt_gw_get_open(&gw) > 0); ++wait) {
+        for (size_t i = 0; ok && i < GW_TEST_STREAMS; ++i) {
+            while (ok && (slot = lwpkt_rxq_get(&gw_pkt[i])) != NULL) {
+                ok = rcvd[i] < GW_TEST_PKTS && slot->len == rcvd[i] % 13U + 1U
+                     && memcmp(slot->data, data, slot->len) == 0;
+#if LWPKT_CFG_USE_CMD
+                ok = ok && slot->cmd == 0x40 + rcvd[i];
+#endif /* LWPKT_CFG_USE_CMD */
+                ok = ok && lwpkt_rxq_release(&gw_pkt[i]) == lwpktOK;
+                ++rcvd[i];
+                ++total;
+            }
+        }
+        ok = ok && wait < 5000;
+        usleep(1000);
+    }
+    ok = lwpkt_gw_stop(&gw) == lwpktOK && ok;
+    for (size_t i = 0; i < GW_TEST_STREAMS; ++i) {
+        close(fds[i][0]);
+        ok = ok && lwpkt_rxq_get_overflow(&gw_pkt[i]) == 0;
+    }
+    ok = ok && lwpkt_gw_stop(&gw) == lwpktERR;
+
+    printf("Gateway test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_USE_GW && LWPKT_CFG_RX_QUEUE && LWPKT_CFG_GW_STREAMS >= 6 */
+
+#if LWPKT_CFG_USE_TX_BATCH && LWPKT_CFG_USE_EVT
+
+static size_t batch_evt_cnt[3];
+
+/**
+ * \brief           Event function to count write events of the batch
+ * \param[in]       p: Packet instance
+ * \param[in]       type: Event type
+ */
+static void
+prv_batch_evt_fn(lwpkt_t* p, lwpkt_evt_type_t type) {
+    (void)p;
+    switch (type) {
+        case LWPKT_EVT_PRE_WRITE: ++batch_evt_cnt[0]; break;
+        case LWPKT_EVT_POST_WRITE: ++batch_evt_cnt[1]; break;
+        case LWPKT_EVT_WRITE: ++batch_evt_cnt[2]; break;
+        default: break;
+    }
+}
+
+/**
+ * \brief           Add packet with data of `len` bytes to the batch
+ * \param[in]       len: Data length
+ * \return          Result of write operation
+ */
+static lwpktr_t
+prv_batch_write(size_t len) {
+    return lwpkt_batch_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                             0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                             0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                             0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                             data, len);
+}
+
+/**
+ * \brief           Write batch of packets, committed at once, and read them
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_batch(void) {
+    uint8_t ok = 1, b;
+    size_t cnt = 0, valid = 0;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+    memset(batch_evt_cnt, 0x00, sizeof(batch_evt_cnt));
+    lwpkt_set_evt_fn(&pkt, prv_batch_evt_fn);
+
+    /* Packets are not visible before commit, other writes are not allowed meanwhile */
+    ok = ok && lwpkt_batch_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                                 0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                                 0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                                 0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                                 data, strlen(data))
+                   == lwpktERR;
+    ok = ok && lwpkt_batch_begin(&pkt) == lwpktOK && lwpkt_batch_begin(&pkt) == lwpktERR;
+    while (prv_batch_write(strlen(data)) == lwpktOK) {
+        ++cnt;
+    }
+    ok = ok && cnt > 1 && lwrb_get_full(pkt.tx_rb) == 0;
+#if !LWPKT_CFG_TX_MPSC
+    ok = ok
+         && lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                        0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                        0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                        0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                        data, strlen(data))
+                == lwpktERR;
+#endif /* !LWPKT_CFG_TX_MPSC */
+    ok = ok && lwpkt_batch_commit(&pkt) == lwpktOK && lwpkt_batch_commit(&pkt) == lwpktERR;
+    ok = ok && batch_evt_cnt[0] == 1 && batch_evt_cnt[1] == 1 && batch_evt_cnt[2] == 1;
+    lwpkt_set_evt_fn(&pkt, NULL);
+
+    /* All packets are received */
+    while (lwrb_read(pkt.tx_rb, &b, 1) == 1) {
+        lwrb_write(pkt.rx_rb, &b, 1);
+        if (lwpkt_read(&pkt) == lwpktVALID) {
+            ok = ok && prv_data_equal(data, strlen(data));
+            ++valid;
+        }
+    }
+    ok = ok && valid == cnt;
+
+#if LWPKT_CFG_TX_MPSC
+    /* Batch holds single claim, more packets than writer count limit and other writer in parallel */
+    {
+        static uint8_t mp_tx_rb_data[8192], mp_rx_rb_data[64];
+#if LWPKT_CFG_RX_DATA_EXT
+        static uint8_t mp_rx_data[LWPKT_CFG_MAX_DATA_LEN];
+#endif /* LWPKT_CFG_RX_DATA_EXT */
+        lwrb_t mp_tx_rb, mp_rx_rb;
+        lwpkt_t mp;
+
+        lwrb_init(&mp_tx_rb, mp_tx_rb_data, sizeof(mp_tx_rb_data));
+        lwrb_init(&mp_rx_rb, mp_rx_rb_data, sizeof(mp_rx_rb_data));
+        ok = ok && PKT_INIT(&mp, &mp_tx_rb, &mp_rx_rb, mp_rx_data) == lwpktOK && lwpkt_batch_begin(&mp) == lwpktOK;
+        for (cnt = 0; ok && cnt < 100; ++cnt) {
+            ok = lwpkt_batch_write(&mp,
+#if LWPKT_CFG_USE_ADDR
+                                   0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                                   0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                                   0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                                   data, 1)
+                 == lwpktOK;
+            ok = ok
+                 && (cnt != 50
+                     || lwpkt_write(&mp,
+#if LWPKT_CFG_USE_ADDR
+                                    0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                                    0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                                    0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                                    data, 1)
+                            == lwpktOK);
+        }
+        ok = ok && lwrb_get_full(&mp_tx_rb) == 0 && lwpkt_batch_commit(&mp) == lwpktOK;
+        for (valid = 0; lwrb_read(&mp_tx_rb, &b, 1) == 1;) {
+            lwrb_write(&mp_rx_rb, &b, 1);
+            if (lwpkt_read(&mp) == lwpktVALID) {
+                ++valid;
+#if LWPKT_CFG_RX_QUEUE
+                lwpkt_rxq_release(&mp);
+#endif /* LWPKT_CFG_RX_QUEUE */
+            }
+        }
+        ok = ok && valid == cnt + 1U;
+    }
+#endif /* LWPKT_CFG_TX_MPSC */
+
+    printf("Batch test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_USE_TX_BATCH && LWPKT_CFG_USE_EVT */
+
+#if LWPKT_CFG_CRC_DESC && LWPKT_CFG_USE_COBS != 1
+
+/**
+ * \brief           Write packet with current CRC setup and read it from TX buffer
+ * \param[out]      frame: Memory for packet bytes
+ * \param[in]       frame_size: Size of `frame` memory
+ * \return          Packet length
+ */
+static size_t
+prv_crc_desc_write(uint8_t* frame, size_t frame_size) {
+    lwpkt_write(&pkt,
+#if LWPKT_CFG_USE_ADDR
+                0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                data, strlen(data));
+    return lwrb_read(pkt.tx_rb, frame, frame_size);
+}
+
+/**
+ * \brief           Test CRC descriptors. Built-in, bit-wise and table-driven calculation must give the same packet,
+ *                  valid packet must be received and packet with corrupted CRC rejected
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_crc_desc(void) {
+    static const lwpkt_crc_desc_t* const descs[] = {&lwpkt_crc_desc_crc16_ccitt, &lwpkt_crc_desc_crc32c};
+    static uint32_t table[256];
+    uint8_t ref[64], frame[64], ok = 1;
+    size_t ref_len[2] = {0}, len;
+    lwpkt_crc_desc_t desc;
+    lwpktr_t res;
+
+    lwpkt_reset(&pkt);
+    lwrb_reset(pkt.tx_rb);
+    lwrb_reset(pkt.rx_rb);
+#if LWPKT_CFG_USE_CRC == 2
+    lwpkt_set_crc_enabled(&pkt, 1);
+#endif /* LWPKT_CFG_USE_CRC == 2 */
+
+    for (size_t d = 0; ok && d < sizeof(descs) / sizeof(descs[0]); ++d) {
+        uint8_t err_crc = 0;
+
+        ok = lwpkt_set_crc_desc(&pkt, descs[d]) == lwpktOK;
+        ref_len[d] = prv_crc_desc_write(ref, sizeof(ref));
+
+        /* Same packet with bit-wise calculation and with application table */
+        desc = *descs[d];
+        desc.table = NULL;
+        desc.block_fn = NULL;
+        lwpkt_set_crc_desc(&pkt, &desc);
+        len = prv_crc_desc_write(frame, sizeof(frame));
+        ok = ok && len == ref_len[d] && memcmp(frame, ref, len) == 0;
+        ok = ok && lwpkt_crc_table_gen(&desc, table) == lwpktOK;
+        desc.table = table;
+        len = prv_crc_desc_write(frame, sizeof(frame));
+        ok = ok && len == ref_len[d] && memcmp(frame, ref, len) == 0;
+
+        /* Corrupted CRC byte before stop byte, followed by valid packet */
+        lwpkt_set_crc_desc(&pkt, descs[d]);
+        ref[ref_len[d] - 2U] ^= 0x01;
+        lwrb_write(pkt.rx_rb, ref, ref_len[d]);
+        ref[ref_len[d] - 2U] ^= 0x01;
+        lwrb_write(pkt.rx_rb, ref, ref_len[d]);
+        while ((res = lwpkt_read(&pkt)) != lwpktVALID && res != lwpktWAITDATA) {
+            err_crc = err_crc || res == lwpktERRCRC;
+        }
+        ok = ok && err_crc && res == lwpktVALID && prv_data_equal(data, strlen(data));
+    }
+
+    /* CRC field length follows descriptor width */
+    ok = ok && ref_len[1] == ref_len[0] + 2U;
+    desc.width = 24;
+    ok = ok && lwpkt_set_crc_desc(&pkt, &desc) == lwpktERR;
+    lwpkt_set_crc_desc(&pkt, NULL);
+
+    printf("CRC descriptor test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_CRC_DESC && LWPKT_CFG_USE_COBS != 1 */
+
+#if LWPKT_CFG_RX_DATA_EXT
+
+/**
+ * \brief           Write packet and transfer it in chunks to RX buffer of the same instance, until it is processed
+ * \param[in]       p: Packet instance
+ * \param[in]       d: Packet data
+ * \param[in]       len: Data length
+ * \return          Result of last read operation
+ */
+static lwpktr_t
+prv_rx_data_ext_transfer(lwpkt_t* p, const void* d, size_t len) {
+    lwpktr_t res = lwpktWAITDATA;
+
+    lwpkt_write(p,
+#if LWPKT_CFG_USE_ADDR
+                0x12,
+#endif /* LWPKT_CFG_USE_ADDR */
+#if LWPKT_CFG_USE_FLAGS
+                0x1234,
+#endif /* LWPKT_CFG_USE_FLAGS */
+#if LWPKT_CFG_USE_CMD
+                0x34,
+#endif /* LWPKT_CFG_USE_CMD */
+                d, len);
+    while (lwrb_get_full(p->tx_rb) > 0 && (res == lwpktWAITDATA || res == lwpktINPROG)) {
+        uint8_t chunk[16];
+        size_t cnt = lwrb_get_free(p->rx_rb) < sizeof(chunk) ? lwrb_get_free(p->rx_rb) : sizeof(chunk);
+
+        cnt = lwrb_read(p->tx_rb, chunk, cnt);
+        lwrb_write(p->rx_rb, chunk, cnt);
+        res = lwpkt_read(p);
+    }
+    lwrb_reset(p->tx_rb);
+    lwrb_reset(p->rx_rb);
+    return res;
+}
+
+/**
+ * \brief           Test instances with memory for received data, smaller and larger than \ref LWPKT_CFG_MAX_DATA_LEN
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+run_test_rx_data_ext(void) {
+    static uint8_t small[32], large[2 * LWPKT_CFG_MAX_DATA_LEN], tx_data[sizeof(large)];
+    static uint8_t ext_tx_rb_data[sizeof(large) + 64], ext_rx_rb_data[64];
+    lwrb_t ext_tx_rb, ext_rx_rb;
+    lwpkt_t ext;
+    uint8_t ok;
+
+    lwrb_init(&ext_tx_rb, ext_tx_rb_data, sizeof(ext_tx_rb_data));
+    lwrb_init(&ext_rx_rb, ext_rx_rb_data, sizeof(ext_rx_rb_data));
+    for (size_t i = 0; i < sizeof(tx_data); ++i) {
+        tx_data[i] = (uint8_t)(i * 3U);
+    }
+    ok = lwpkt_init_ex(&ext, &ext_tx_rb, &ext_rx_rb, NULL, sizeof(small)) == lwpktERR;
+
+    /* Data part must fit to the instance memory */
+    ok = ok && lwpkt_init_ex(&ext, &ext_tx_rb, &ext_rx_rb, small, sizeof(small)) == lwpktOK;
+    ok = ok && prv_rx_data_ext_transfer(&ext, tx_data, sizeof(small)) == lwpktVALID
+         && lwpkt_get_data(&ext) == small && memcmp(small, tx_data, sizeof(small)) == 0;
+#if !LWPKT_CFG_USE_RX_STREAM
+    ok = ok && prv_rx_data_ext_transfer(&ext, tx_data, sizeof(small) + 1U) == lwpktERRMEM;
+#endif /* !LWPKT_CFG_USE_RX_STREAM */
+
+    /* Instance limit is not bound to the build configuration */
+    ok = ok && lwpkt_init_ex(&ext, &ext_tx_rb, &ext_rx_rb, large, sizeof(large)) == lwpktOK;
+    ok = ok && prv_rx_data_ext_transfer(&ext, tx_data, sizeof(large)) == lwpktVALID
+         && lwpkt_get_data_len(&ext) == sizeof(large) && memcmp(large, tx_data, sizeof(large)) == 0;
+
+    printf("RX data memory test %s\r\n", ok ? "OK" : "failed");
+    return ok;
+}
+
+#endif /* LWPKT_CFG_RX_DATA_EXT */
+
+/**
+ * \brief           LwPKT example code
+ * \return          Number of failed tests, `0` on success
+ */
+size_t
+test_lwpkt(void) {
+    size_t failed = 0;
+
+    printf("---\r\nLwPKT test.\r\n\r\n");
+
+    /* Setup the lib */
+    lwrb_init(&pkt_tx_rb, pkt_tx_rb_data, sizeof(pkt_tx_rb_data));
+    lwrb_init(&pkt_rx_rb, pkt_rx_rb_data, sizeof(pkt_rx_rb_data));
+    PKT_INIT(&pkt, &pkt_tx_rb, &pkt_rx_rb, pkt_rx_data);
+
+    /* Try */
+    for (size_t i = 0; i < 1 << 7; ++i) {
+        failed += !run_test(i + 1, !!(i & 0x01), !!(i & 0x02), !!(i & 0x04), !!(i & 0x08), !!(i & 0x10), !!(i & 0x20),
+                           !!(i & 0x40));
+    }
+    failed += !run_test_wrap();
+    failed += !run_test_writev();
+#if LWPKT_CFG_USE_STATS && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1
+    failed += !run_test_stats();
+#endif /* LWPKT_CFG_USE_STATS && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1 */
+    failed += !run_test_rx_timeout();
+#if LWPKT_CFG_TRACE && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1
+    failed += !run_test_trace();
+#endif /* LWPKT_CFG_TRACE && LWPKT_CFG_USE_CRC && LWPKT_CFG_USE_COBS != 1 */
+#if LWPKT_CFG_RX_FILTER && LWPKT_CFG_USE_ADDR && LWPKT_CFG_USE_CMD
+    failed += !run_test_filter();
+#endif /* LWPKT_CFG_RX_FILTER && LWPKT_CFG_USE_ADDR && LWPKT_CFG_USE_CMD */
+#if LWPKT_CFG_TX_FRAMES
+    failed += !run_test_txq();
+#endif /* LWPKT_CFG_TX_FRAMES */
+#if LWPKT_CFG_TX_LANES > 1
+    failed += !run_test_tx_sched();
+#endif /* LWPKT_CFG_TX_LANES > 1 */
+#if LWPKT_CFG_USE_FRAG && LWPKT_CFG_FRAG_MAX_CNT >= 10
+    failed += !run_test_frag();
+#endif /* LWPKT_CFG_USE_FRAG && LWPKT_CFG_FRAG_MAX_CNT >= 10 */
+#if LWPKT_CFG_USE_GW && LWPKT_CFG_RX_QUEUE && LWPKT_CFG_GW_STREAMS >= 6
+    failed += !run_test_gw();
+#endif /* LWPKT_CFG_USE_GW && LWPKT_CFG_RX_QUEUE && LWPKT_CFG_GW_STREAMS >= 6 */
+#if LWPKT_CFG_USE_TX_BATCH && LWPKT_CFG_USE_EVT
+    failed += !run_test_batch();
+#endif /* LWPKT_CFG_USE_TX_BATCH && LWPKT_CFG_USE_EVT */
+#if LWPKT_CFG_CRC_DESC && LWPKT_CFG_USE_COBS != 1
+    failed += !run_test_crc_desc();
+#endif /* LWPKT_CFG_CRC_DESC && LWPKT_CFG_USE_COBS != 1 */
+#if LWPKT_CFG_RX_DATA_EXT
+    failed += !run_test_rx_data_ext();
+#endif /* LWPKT_CFG_RX_DATA_EXT */
+#if LWPKT_CFG_RX_QUEUE
+    failed += !run_test_rxq();
+#endif /* LWPKT_CFG_RX_QUEUE */
+#if LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_COBS != 1
+    failed += !run_test_resync();
+#endif /* LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_COBS != 1 */
+#if LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1
+    failed += !run_test_tx_stream();
+#endif /* LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1 */
+#if LWPKT_CFG_TX_MPSC && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1
+    failed += !run_test_mpsc();
+#endif /* LWPKT_CFG_TX_MPSC && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1 */
+#if LWPKT_CFG_USE_RX_STREAM && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1
+    failed += !run_test_rx_stream();
+#if LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_CRC && !LWPKT_CFG_RX_ZERO_COPY
+    failed += !run_test_rx_stream_resync();
+#endif /* LWPKT_CFG_RX_RESYNC && LWPKT_CFG_USE_CRC && !LWPKT_CFG_RX_ZERO_COPY */
+#endif /* LWPKT_CFG_USE_RX_STREAM && LWPKT_CFG_USE_TX_STREAM && LWPKT_CFG_USE_COBS != 1 */
+#if LWPKT_CFG_USE_COBS
+    failed += !run_test_cobs();
+#endif /* LWPKT_CFG_USE_COBS */
+#if LWPKT_CFG_USE_ENGINE
+    failed += !run_test_engine();
+#endif /* LWPKT_CFG_USE_ENGINE */
+
+    if (failed == 0) {
+        printf("---\r\nLwPKT test OK\r\n");
+    } else {
+        printf("---\r\nLwPKT test failed, number of failed tests: %u\r\n", (unsigned)failed);
     }
+    return failed;
 }
@@ -0,0 +1,154 @@
+/*
+ * lwpkt_test.cpp : Test of C++ codec, with packets written by C library with the same features.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include "lwpkt/lwpkt.hpp"
+
+/* Data to read and write */
+static const char* data = "Hello World\r\n";
+
+/* All features, written by C library with address 0x1234, to 0x87654321, flags 0xACCE55 and command 0x1F2F3F */
+static constexpr lwpkt::Config cfg_full{.addr = true,
+                                        .addr_ext = true,
+                                        .flags = true,
+                                        .cmd = true,
+                                        .cmd_ext = true,
+                                        .crc = lwpkt::Crc::crc32};
+static const uint8_t pkt_full[] = {
+    0xAA, 0xB4, 0x24, 0xA1, 0x86, 0x95, 0xBB, 0x08, 0xD5, 0x9C, 0xB3, 0x05, 0xBF, 0xDE, 0x7C, 0x0D, 0x48,
+    0x65, 0x6C, 0x6C, 0x6F, 0x20, 0x57, 0x6F, 0x72, 0x6C, 0x64, 0x0D, 0x0A, 0x2C, 0xC6, 0x37, 0xB3, 0x55,
+};
+
+/* One byte address and command with CRC-8, written with address 0x12, to 0x34 and command 0x56 */
+static constexpr lwpkt::Config cfg_short{};
+static const uint8_t pkt_short[] = {
+    0xAA, 0x12, 0x34, 0x56, 0x0D, 0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x20, 0x57, 0x6F, 0x72, 0x6C, 0x64, 0x0D, 0x0A, 0x77, 0x55,
+};
+
+/* No features */
+static constexpr lwpkt::Config cfg_none{.addr = false, .cmd = false, .crc = lwpkt::Crc::none, .max_data_len = 16};
+static const uint8_t pkt_none[] = {
+    0xAA, 0x0D, 0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x20, 0x57, 0x6F, 0x72, 0x6C, 0x64, 0x0D, 0x0A, 0x55,
+};
+
+/**
+ * \brief           Encode reference packet and decode it in one block and byte by byte
+ * \tparam          Cfg: Codec configuration
+ * \param[in]       ref: Packet written by C library
+ * \param[in]       hdr: Header of the packet
+ * \return          `true` on success, `false` otherwise
+ */
+template <lwpkt::Config Cfg>
+static bool
+run_test_codec(std::span<const uint8_t> ref, const lwpkt::Header& hdr) {
+    static lwpkt::Codec<Cfg> codec;
+    const std::span<const uint8_t> payload(reinterpret_cast<const uint8_t*>(data), std::strlen(data));
+    uint8_t out[lwpkt::Codec<Cfg>::frame_max_len(32)];
+    lwpkt::PacketView pkt;
+    lwpkt::Result res = lwpkt::Result::err;
+    std::span<const uint8_t> in;
+    bool ok = true;
+
+    /* Encoded packet is the same as written by C library */
+    ok = ok && lwpkt::Codec<Cfg>::frame_len(hdr, payload.size()) == ref.size();
+    ok = ok && lwpkt::Codec<Cfg>::encode(out, hdr, payload) == ref.size();
+    ok = ok && std::memcmp(out, ref.data(), ref.size()) == 0;
+    ok = ok && lwpkt::Codec<Cfg>::encode(std::span<uint8_t>(out, ref.size() - 1U), hdr, payload) == 0;
+
+    /* Packet in one block is decoded directly from the input */
+    in = ref;
+    ok = ok && codec.read(in, pkt) == lwpkt::Result::valid && in.empty();
+    ok = ok && pkt.hdr.from == hdr.from && pkt.hdr.to == hdr.to && pkt.hdr.flags == hdr.flags;
+    ok = ok && pkt.hdr.cmd == hdr.cmd && pkt.data.data() == &ref[ref.size() - payload.size() - lwpkt::Codec<Cfg>::crc_len - 1U];
+    ok = ok && pkt.data.size() == payload.size() && std::memcmp(pkt.data.data(), data, payload.size()) == 0;
+    ok = ok && codec.read(in, pkt) == lwpkt::Result::waitdata;
+
+    /* Byte by byte, data part is stored to the codec memory */
+    for (size_t i = 0; ok && i < ref.size(); ++i) {
+        in = ref.subspan(i, 1);
+        res = codec.read(in, pkt);
+        ok = in.empty() && (i + 1U < ref.size() ? res == lwpkt::Result::inprog : res == lwpkt::Result::valid);
+    }
+    ok = ok && pkt.hdr.from == hdr.from && pkt.hdr.to == hdr.to && pkt.hdr.flags == hdr.flags;
+    ok = ok && pkt.hdr.cmd == hdr.cmd && pkt.data.size() == payload.size();
+    ok = ok && std::memcmp(pkt.data.data(), data, payload.size()) == 0 && !codec.in_progress();
+    return ok;
+}
+
+/**
+ * \brief           Decode stream with noise and invalid packets
+ * \return          `true` on success, `false` otherwise
+ */
+static bool
+run_test_errors(void) {
+    static lwpkt::Codec<cfg_short> codec;
+    static lwpkt::Codec<cfg_none> codec_none;
+    uint8_t stream[3 * sizeof(pkt_short) + 4];
+    lwpkt::PacketView pkt;
+    std::span<const uint8_t> in;
+    size_t len = 0;
+    bool ok = true;
+
+    /* Noise, packet with invalid CRC, packet with invalid stop byte, valid packet */
+    stream[len++] = 0x00;
+    stream[len++] = 0x55;
+    std::memcpy(&stream[len], pkt_short, sizeof(pkt_short));
+    stream[len + sizeof(pkt_short) - 2U] ^= 0x01U;
+    len += sizeof(pkt_short);
+    std::memcpy(&stream[len], pkt_short, sizeof(pkt_short));
+    len += sizeof(pkt_short);
+    stream[len - 1U] = 0x00;
+    stream[len++] = 0x12;
+    std::memcpy(&stream[len], pkt_short, sizeof(pkt_short));
+    len += sizeof(pkt_short);
+
+    /* Same results in one block and split at every position */
+    for (size_t split = 0; ok && split <= len; ++split) {
+        const lwpkt::Result exp[] = {lwpkt::Result::errcrc, lwpkt::Result::errstop, lwpkt::Result::valid};
+        size_t cnt = 0;
+
+        codec.reset();
+        for (size_t part = 0; ok && part < 2; ++part) {
+            lwpkt::Result res;
+
+            in = part == 0 ? std::span<const uint8_t>(stream, split)
+                           : std::span<const uint8_t>(&stream[split], len - split);
+            while ((res = codec.read(in, pkt)) != lwpkt::Result::waitdata && res != lwpkt::Result::inprog) {
+                ok = ok && cnt < 3 && res == exp[cnt++];
+            }
+        }
+        ok = ok && cnt == 3 && pkt.hdr.cmd == 0x56 && pkt.data.size() == std::strlen(data);
+    }
+
+    /* Data part longer than maximum length */
+    uint8_t out[lwpkt::Codec<cfg_none>::frame_max_len(32)];
+    uint8_t big[cfg_none.max_data_len + 1U] = {0};
+    len = lwpkt::Codec<cfg_none>::encode(out, {}, big);
+    in = std::span<const uint8_t>(out, len);
+    ok = ok && len > 0 && codec_none.read(in, pkt) == lwpkt::Result::errmem;
+    ok = ok && codec_none.read(in, pkt) == lwpkt::Result::waitdata;
+    for (size_t i = 0; ok && i < len; ++i) {
+        lwpkt::Result res;
+
+        in = std::span<const uint8_t>(&out[i], 1);
+        res = codec_none.read(in, pkt);
+        ok = i == 1 ? res == lwpkt::Result::errmem : (res == lwpkt::Result::inprog || res == lwpkt::Result::waitdata);
+    }
+    return ok;
+}
+
+int
+main(void) {
+    bool ok = true;
+
+    ok = run_test_codec<cfg_full>(pkt_full, {.from = 0x1234, .to = 0x87654321UL, .flags = 0xACCE55UL, .cmd = 0x1F2F3FUL})
+         && ok;
+    ok = run_test_codec<cfg_short>(pkt_short, {.from = 0x12, .to = 0x34, .cmd = 0x56}) && ok;
+    ok = run_test_codec<cfg_none>(pkt_none, {}) && ok;
+    ok = run_test_errors() && ok;
+    std::printf("C++ codec test %s\r\n", ok ? "OK" : "failed");
+    return ok ? 0 : 1;
+}